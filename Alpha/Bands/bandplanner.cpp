@@ -0,0 +1,234 @@
+#include "bandplanner.h"
+#include "threadpool.h"
+#include "stlfacetreader.h"
+#include "uniformslicingalg.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Facets read from the STL file per block
+constexpr size_t READ_BLOCK_FACETS = 65536;
+
+// Each band keeps a temporary file open until it is planned
+constexpr size_t MAX_BANDS = 512;
+
+// Memory per band facet while a band is planned: the facets read back from
+// the band file and the planner's own copy
+constexpr size_t BYTES_PER_FACET = 2 * sizeof(Facet);
+
+using TempFile = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+// Facets of one band, spilled to a file that is deleted when closed
+struct BandFile {
+    TempFile file;
+    size_t facets;
+    size_t firstSlice;
+    size_t endSlice;
+};
+
+// Counts the bytes held by bands being planned. acquire waits until the
+// bytes fit beside those already held; with nothing held it always succeeds,
+// so a band larger than the whole budget still runs, alone.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t limit) : limit_(limit), used_(0), peak_(0) {}
+
+    void acquire(size_t bytes) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        available_.wait(lock, [&]() { return limit_ == 0 || used_ == 0 || used_ + bytes <= limit_; });
+        used_ += bytes;
+        peak_ = std::max(peak_, used_);
+    }
+
+    void release(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            used_ -= bytes;
+        }
+        available_.notify_all();
+    }
+
+    size_t getPeak() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peak_;
+    }
+
+private:
+    size_t limit_;
+    size_t used_;
+    size_t peak_;
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+};
+
+// First pass: Z bounds of the whole part
+static bool scanBounds(STLFacetReader& reader, float& minZ, float& maxZ) {
+    TRACE_SCOPE("BandPlanner::scanBounds");
+    minZ = std::numeric_limits<float>::max();
+    maxZ = std::numeric_limits<float>::lowest();
+    std::vector<Facet> block;
+    size_t total = 0;
+    while (size_t count = reader.readFacets(block, READ_BLOCK_FACETS)) {
+        for (const auto& facet : block) {
+            for (int i = 0; i < 3; ++i) {
+                minZ = std::min(minZ, facet.vertices[i][2]);
+                maxZ = std::max(maxZ, facet.vertices[i][2]);
+            }
+        }
+        total += count;
+    }
+    return total == reader.getFacetCount();
+}
+
+// Bands wanted when none are asked for: one per thread, and more if one band
+// per thread would not fit in the budget with the facets spread evenly over Z
+static size_t chooseBandCount(const BandPlanOptions& options, size_t facets, unsigned threads) {
+    size_t bands = options.bandCount;
+    if (bands == 0) {
+        bands = threads;
+        if (options.memoryBudget > 0) {
+            size_t bytes = facets * BYTES_PER_FACET * threads;
+            bands = std::max(bands, (bytes + options.memoryBudget - 1) / options.memoryBudget);
+        }
+    }
+    return std::max<size_t>(1, std::min(bands, MAX_BANDS));
+}
+
+// Second pass: write each facet to every band holding a slice it may cross.
+// The slice range is widened by one on each side against rounding; extra
+// facets in a band do not change its paths. Fails if a facet could not be
+// read or written.
+static bool spillBands(STLFacetReader& reader, const std::vector<float>& slices, float toolLength,
+                       std::vector<BandFile>& bands, size_t slicesPerBand, size_t& spilledFacets) {
+    TRACE_SCOPE("BandPlanner::spillBands");
+    float minZ = slices.front();
+    float thickness = toolLength * 0.75f;
+    long lastSlice = static_cast<long>(slices.size()) - 1;
+    spilledFacets = 0;
+
+    std::vector<Facet> block;
+    size_t total = 0;
+    while (size_t count = reader.readFacets(block, READ_BLOCK_FACETS)) {
+        total += count;
+        for (const auto& facet : block) {
+            float low = std::min({facet.vertices[0][2], facet.vertices[1][2], facet.vertices[2][2]});
+            float high = std::max({facet.vertices[0][2], facet.vertices[1][2], facet.vertices[2][2]});
+            long first = static_cast<long>(std::floor((low - minZ) / thickness));
+            long last = static_cast<long>(std::floor((high - minZ) / thickness)) + 1;
+            first = std::max(0L, first);
+            last = std::min(lastSlice, last);
+            if (first > last) {
+                continue;
+            }
+
+            for (size_t b = first / slicesPerBand; b <= static_cast<size_t>(last) / slicesPerBand; ++b) {
+                if (std::fwrite(&facet, sizeof(Facet), 1, bands[b].file.get()) != 1) {
+                    return false;
+                }
+                bands[b].facets++;
+                spilledFacets++;
+            }
+        }
+    }
+    return total == reader.getFacetCount();
+}
+
+bool planInBands(const std::string& filename, const BandPlanOptions& options, std::vector<float>& slices,
+                 const PathPlanner::SliceCallback& onSlice, BandPlanReport& report) {
+    TRACE_SCOPE("BandPlanner::planInBands");
+    report = BandPlanReport{0, 0, 0, 0};
+    slices.clear();
+
+    STLFacetReader reader;
+    if (!reader.open(filename)) {
+        std::cerr << "Not a binary STL file: " << filename << std::endl;
+        return false;
+    }
+    report.facets = reader.getFacetCount();
+
+    float minZ, maxZ;
+    if (!scanBounds(reader, minZ, maxZ)) {
+        std::cerr << "Failed to read " << filename << std::endl;
+        return false;
+    }
+    if (report.facets == 0 || options.toolLength <= 0.0f) {
+        return true;
+    }
+    slices = uniformSlicePlanes(minZ, maxZ, options.toolLength);
+
+    unsigned threads = options.numThreads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t bandCount = std::min(chooseBandCount(options, report.facets, threads), slices.size());
+    size_t slicesPerBand = (slices.size() + bandCount - 1) / bandCount;
+    bandCount = (slices.size() + slicesPerBand - 1) / slicesPerBand;
+
+    std::vector<BandFile> bands;
+    bands.reserve(bandCount);
+    for (size_t b = 0; b < bandCount; ++b) {
+        TempFile file(std::tmpfile(), &std::fclose);
+        if (!file) {
+            std::cerr << "Failed to create a temporary band file" << std::endl;
+            return false;
+        }
+        bands.push_back(BandFile{std::move(file), 0, b * slicesPerBand,
+                                 std::min(slices.size(), (b + 1) * slicesPerBand)});
+    }
+    report.bands = bandCount;
+
+    reader.rewind();
+    if (!spillBands(reader, slices, options.toolLength, bands, slicesPerBand, report.spilledFacets)) {
+        std::cerr << "Failed to read " << filename << " or write a temporary band file" << std::endl;
+        return false;
+    }
+    reader.close();
+
+    // Bands are taken in Z order; each holds its share of the budget from
+    // reading its file back until its last slice is planned
+    MemoryBudget budget(options.memoryBudget);
+    std::atomic<bool> failed(false);
+    std::mutex callbackMutex;
+    parallelFor(bands.size(), threads, [&](size_t b) {
+        TRACE_SCOPE("BandPlanner::band");
+        BandFile& band = bands[b];
+        size_t bytes = band.facets * BYTES_PER_FACET;
+        budget.acquire(bytes);
+
+        std::vector<Facet> facets(band.facets);
+        std::rewind(band.file.get());
+        bool read = std::fread(facets.data(), sizeof(Facet), facets.size(), band.file.get()) == facets.size();
+        band.file.reset();
+        if (!read) {
+            failed = true;
+            budget.release(bytes);
+            return;
+        }
+
+        PathPlanner planner(facets);
+        std::vector<Facet>().swap(facets);
+        for (size_t i = band.firstSlice; i < band.endSlice; ++i) {
+            std::vector<PathPoint> points = planner.calculateSlicePath(slices[i]);
+            if (!points.empty()) {
+                std::lock_guard<std::mutex> lock(callbackMutex);
+                onSlice(i, points);
+            }
+        }
+        budget.release(bytes);
+    });
+
+    report.peakResidentBytes = budget.getPeak();
+    if (failed) {
+        std::cerr << "Failed to read a temporary band file" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef BANDPLANNER_H
+#define BANDPLANNER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "pathplanner.h"
+
+struct BandPlanOptions {
+    float toolLength;
+    size_t memoryBudget;  // Bytes of band facets held at once (0 = no limit)
+    size_t bandCount;     // Z bands to split the part into (0 = from the budget and thread count)
+    unsigned numThreads;  // Bands planned at once (0 = hardware concurrency)
+};
+
+struct BandPlanReport {
+    size_t facets;             // Facets in the file
+    size_t spilledFacets;      // Facets written to band files; one spanning several bands counts in each
+    size_t bands;
+    size_t peakResidentBytes;  // Most band facet memory held at once
+};
+
+// Plans a binary STL file without loading all of it. A first streaming pass
+// finds the Z bounds and so the slice planes. A second sorts the facets into
+// Z bands of consecutive slices and spills each band to a temporary file.
+// The bands are then loaded and planned on worker threads, as many at once as
+// fit in the memory budget; a band larger than the budget is planned alone.
+//
+// The slices are those generateSlices gives for the loaded part and every
+// slice path is the one calculateSlicePath gives. onSlice is called for each
+// non-empty slice, one call at a time but in no particular order.
+bool planInBands(const std::string& filename, const BandPlanOptions& options, std::vector<float>& slices,
+                 const PathPlanner::SliceCallback& onSlice, BandPlanReport& report);
+
+#endif // BANDPLANNER_H
@@ -0,0 +1,124 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// Bounded lock-free queue for any number of producers and consumers. Every
+// slot carries a sequence number that tells producers and consumers whose
+// turn it is, so a push or pop is one compare-and-swap on the shared index.
+// push and pop wait by yielding and then sleeping briefly; close() lets
+// consumers drain what is left and then stop.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : closed_(false) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueue_.store(0, std::memory_order_relaxed);
+        dequeue_.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Move value in unless the queue is full
+    bool tryPush(T& value) {
+        size_t position = enqueue_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position & mask_];
+            std::ptrdiff_t lap = static_cast<std::ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - position);
+            if (lap == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lap < 0) {
+                return false;  // Full: the slot still holds an item from one lap ago
+            }
+            else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Move the oldest value out unless the queue is empty
+    bool tryPop(T& value) {
+        size_t position = dequeue_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position & mask_];
+            std::ptrdiff_t lap = static_cast<std::ptrdiff_t>(slot.sequence.load(std::memory_order_acquire) - (position + 1));
+            if (lap == 0) {
+                if (dequeue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(slot.value);
+                    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (lap < 0) {
+                return false;  // Empty: the slot has not been filled for this lap
+            }
+            else {
+                position = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Wait for room, then push
+    void push(T value) {
+        for (unsigned attempt = 0; !tryPush(value); ++attempt) {
+            backOff(attempt);
+        }
+    }
+
+    // Wait for a value; false once the queue is closed and empty
+    bool pop(T& value) {
+        for (unsigned attempt = 0; ; ++attempt) {
+            if (tryPop(value)) {
+                return true;
+            }
+            if (closed_.load(std::memory_order_acquire)) {
+                return tryPop(value);  // Pushes made before close are visible now
+            }
+            backOff(attempt);
+        }
+    }
+
+    // No more pushes will follow
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static void backOff(unsigned attempt) {
+        if (attempt < 64) {
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_;
+    alignas(64) std::atomic<size_t> dequeue_;
+    alignas(64) std::atomic<bool> closed_;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,242 @@
+#include "pipelineplanner.h"
+#include "boundedqueue.h"
+#include "stlfacetreader.h"
+#include "uniformslicingalg.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Facets per block handed from the reader to the bucketing stage
+constexpr size_t PIPELINE_BLOCK_FACETS = 4096;
+
+// Blocks read ahead of the bucketing stage, and bands waiting for a planner
+constexpr size_t BLOCK_QUEUE_CAPACITY = 16;
+constexpr size_t TASK_QUEUE_CAPACITY = 64;
+
+constexpr size_t DEFAULT_BAND_SLICES = 16;
+
+using Clock = std::chrono::steady_clock;
+
+// Consecutive slices planned together from the facets that may cross them
+struct BandTask {
+    size_t firstSlice;
+    std::vector<float> slices;
+    std::vector<Facet> facets;
+    std::vector<std::vector<PathPoint>> paths;
+    bool duringLoad;
+};
+
+// All facets read so far, in file order, with the Z cells each one spans.
+// Cell c covers [anchor + c * thickness, anchor + (c + 1) * thickness); the
+// anchor is the lowest Z of the first facet. A facet is filed one cell
+// beyond its Z range on each side against rounding.
+class ZBuckets {
+public:
+    explicit ZBuckets(float thickness)
+        : thickness_(thickness), anchor_(0.0f), minZ_(std::numeric_limits<float>::max()),
+          maxZ_(std::numeric_limits<float>::lowest()), lastLow_(std::numeric_limits<float>::lowest()),
+          sorted_(true) {}
+
+    void add(const Facet& facet) {
+        float low = std::min({facet.vertices[0][2], facet.vertices[1][2], facet.vertices[2][2]});
+        float high = std::max({facet.vertices[0][2], facet.vertices[1][2], facet.vertices[2][2]});
+        if (facets_.empty()) {
+            anchor_ = low;
+        }
+        sorted_ = sorted_ && low >= lastLow_;
+        lastLow_ = low;
+        minZ_ = std::min(minZ_, low);
+        maxZ_ = std::max(maxZ_, high);
+
+        uint32_t index = static_cast<uint32_t>(facets_.size());
+        facets_.push_back(facet);
+        for (long c = cellOf(low) - 1; c <= cellOf(high) + 1; ++c) {
+            cells_[c].push_back(index);
+        }
+    }
+
+    long cellOf(float z) const { return static_cast<long>(std::floor((z - anchor_) / thickness_)); }
+
+    // With facets arriving sorted by lowest Z, no later facet reaches below this cell
+    long firstOpenCell() const { return cellOf(lastLow_) - 1; }
+
+    // Facets filed under cells first to last, in file order
+    std::vector<Facet> gather(long first, long last) const {
+        std::vector<uint32_t> indices;
+        for (auto it = cells_.lower_bound(first); it != cells_.end() && it->first <= last; ++it) {
+            indices.insert(indices.end(), it->second.begin(), it->second.end());
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        std::vector<Facet> facets;
+        facets.reserve(indices.size());
+        for (uint32_t index : indices) {
+            facets.push_back(facets_[index]);
+        }
+        return facets;
+    }
+
+    bool isSorted() const { return sorted_; }
+    bool isEmpty() const { return facets_.empty(); }
+    size_t getFacetCount() const { return facets_.size(); }
+    float getMinZ() const { return minZ_; }
+    float getMaxZ() const { return maxZ_; }
+
+private:
+    float thickness_;
+    float anchor_;
+    float minZ_, maxZ_;
+    float lastLow_;
+    bool sorted_;
+    std::vector<Facet> facets_;
+    std::map<long, std::vector<uint32_t>> cells_;
+};
+
+bool planPipelined(const std::string& filename, const PipelineOptions& options, std::vector<float>& slices,
+                   const PathPlanner::SliceCallback& onSlice, PipelineReport& report) {
+    TRACE_SCOPE("PipelinePlanner::planPipelined");
+    Clock::time_point start = Clock::now();
+    report = PipelineReport{0, false, 0, 0, 0.0, 0.0};
+    slices.clear();
+
+    STLFacetReader reader;
+    if (!reader.open(filename)) {
+        std::cerr << "Not a binary STL file: " << filename << std::endl;
+        return false;
+    }
+    if (options.toolLength <= 0.0f) {
+        return false;
+    }
+
+    float thickness = options.toolLength * 0.75f;
+    size_t bandSlices = options.bandSlices > 0 ? options.bandSlices : DEFAULT_BAND_SLICES;
+    unsigned threads = options.numThreads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Stage 1: read blocks of facets ahead of the bucketing stage
+    BoundedQueue<std::vector<Facet>> blocks(BLOCK_QUEUE_CAPACITY);
+    bool readComplete = false;
+    std::thread loader([&]() {
+        TRACE_SCOPE("PipelinePlanner::load");
+        size_t total = 0;
+        std::vector<Facet> block;
+        while (reader.readFacets(block, PIPELINE_BLOCK_FACETS) > 0) {
+            total += block.size();
+            blocks.push(std::move(block));
+            block = std::vector<Facet>();
+        }
+        readComplete = total == reader.getFacetCount();
+        blocks.close();
+    });
+
+    // Stage 3: plan bands as they are handed over
+    BoundedQueue<std::unique_ptr<BandTask>> tasks(TASK_QUEUE_CAPACITY);
+    std::vector<std::unique_ptr<BandTask>> planned;
+    std::mutex plannedMutex;
+    std::vector<std::thread> planners;
+    for (unsigned t = 0; t < threads; ++t) {
+        planners.emplace_back([&]() {
+            std::unique_ptr<BandTask> task;
+            while (tasks.pop(task)) {
+                TRACE_SCOPE("PipelinePlanner::band");
+                PathPlanner planner(task->facets);
+                std::vector<Facet>().swap(task->facets);
+                task->paths.resize(task->slices.size());
+                for (size_t i = 0; i < task->slices.size(); ++i) {
+                    task->paths[i] = planner.calculateSlicePath(task->slices[i]);
+                }
+                std::lock_guard<std::mutex> lock(plannedMutex);
+                planned.push_back(std::move(task));
+            }
+        });
+    }
+
+    // Slice i sits where uniformSlicePlanes puts it
+    ZBuckets buckets(thickness);
+    auto sliceAt = [&](size_t i) { return buckets.getMinZ() + static_cast<int>(i) * thickness; };
+    auto handOver = [&](size_t first, size_t end, bool duringLoad) {
+        auto task = std::make_unique<BandTask>();
+        task->firstSlice = first;
+        for (size_t i = first; i < end; ++i) {
+            task->slices.push_back(sliceAt(i));
+        }
+        task->facets = buckets.gather(buckets.cellOf(task->slices.front()), buckets.cellOf(task->slices.back()));
+        task->duringLoad = duringLoad;
+        tasks.push(std::move(task));
+        report.bands++;
+    };
+
+    // Stage 2: bucket facets; while they arrive in Z order, hand over every
+    // band whose cells no later facet can reach
+    size_t nextSlice = 0;
+    std::vector<Facet> block;
+    while (blocks.pop(block)) {
+        TRACE_SCOPE("PipelinePlanner::bucket");
+        for (const auto& facet : block) {
+            buckets.add(facet);
+        }
+        while (buckets.isSorted()) {
+            size_t end = nextSlice + bandSlices;
+            if (buckets.cellOf(sliceAt(end - 1)) >= buckets.firstOpenCell()) {
+                break;
+            }
+            handOver(nextSlice, end, true);
+            report.bandsDuringLoad++;
+            nextSlice = end;
+        }
+    }
+    loader.join();
+    report.loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.facets = buckets.getFacetCount();
+
+    // The rest once every facet is in. Bands handed over early are only
+    // valid if the facets stayed sorted to the end; otherwise start over.
+    bool failed = !readComplete;
+    if (!failed && !buckets.isEmpty()) {
+        slices = uniformSlicePlanes(buckets.getMinZ(), buckets.getMaxZ(), options.toolLength);
+        report.sortedInput = buckets.isSorted() && nextSlice <= slices.size();
+        if (!report.sortedInput) {
+            nextSlice = 0;
+            report.bands -= report.bandsDuringLoad;
+            report.bandsDuringLoad = 0;
+        }
+        for (size_t first = nextSlice; first < slices.size(); first += bandSlices) {
+            handOver(first, std::min(slices.size(), first + bandSlices), false);
+        }
+    }
+    tasks.close();
+    for (auto& planner : planners) {
+        planner.join();
+    }
+    if (failed) {
+        std::cerr << "Failed to read " << filename << std::endl;
+        return false;
+    }
+
+    std::sort(planned.begin(), planned.end(),
+              [](const std::unique_ptr<BandTask>& a, const std::unique_ptr<BandTask>& b) {
+        return a->firstSlice < b->firstSlice;
+    });
+    for (const auto& task : planned) {
+        if (task->duringLoad && !report.sortedInput) {
+            continue;
+        }
+        for (size_t i = 0; i < task->paths.size(); ++i) {
+            if (!task->paths[i].empty()) {
+                onSlice(task->firstSlice + i, task->paths[i]);
+            }
+        }
+    }
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return true;
+}
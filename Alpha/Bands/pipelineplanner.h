@@ -0,0 +1,42 @@
+#ifndef PIPELINEPLANNER_H
+#define PIPELINEPLANNER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "pathplanner.h"
+
+struct PipelineOptions {
+    float toolLength;
+    unsigned numThreads;  // Planning threads (0 = hardware concurrency)
+    size_t bandSlices;    // Slices planned per task (0 = 16)
+};
+
+struct PipelineReport {
+    size_t facets;
+    bool sortedInput;        // Facets arrived in increasing Z, so planning overlapped loading
+    size_t bandsDuringLoad;  // Bands planned before the last facet was read
+    size_t bands;
+    double loadSeconds;      // Until the last facet was bucketed
+    double seconds;          // Until the last slice was planned
+};
+
+// Loads, buckets and plans a binary STL file at the same time. A reader
+// thread passes blocks of facets through a bounded lock-free queue to a
+// bucketing stage, which files each facet under the Z cells (one slice
+// thickness high) it spans. Bands of consecutive slices are planned by
+// worker threads from the facets of their cells only, so no stage rescans
+// the whole part.
+//
+// A band can be planned once no facet still to come can reach it. That is
+// known before the end of the file only when the facets arrive sorted by
+// their lowest Z, as parts written in Z order do; then planning overlaps
+// loading. Otherwise every band starts when the last facet is in.
+//
+// The slices and slice paths are those generateSlices and
+// calculateSlicePath give for the loaded part. onSlice is called for each
+// non-empty slice in slice order once all are planned.
+bool planPipelined(const std::string& filename, const PipelineOptions& options, std::vector<float>& slices,
+                   const PathPlanner::SliceCallback& onSlice, PipelineReport& report);
+
+#endif // PIPELINEPLANNER_H
@@ -0,0 +1,155 @@
+#include "backgroundplanner.h"
+#include "uniformslicingalg.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+
+BackgroundPlanner::BackgroundPlanner(const std::vector<Facet>& facets)
+    : slicer_(std::make_unique<UniformSlicingAlgorithm>(facets)),
+      planner_(std::make_unique<PathPlanner>(facets)),
+      hasRequest_(false), planning_(false), stop_(false), requestedLength_(0.0f),
+      progressiveStride_(0), latestRequest_(0) {
+    worker_ = std::thread(&BackgroundPlanner::workerLoop, this);
+}
+
+BackgroundPlanner::~BackgroundPlanner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        ++latestRequest_;  // Stops a running plan at the next slice
+    }
+    wake_.notify_all();
+    worker_.join();
+}
+
+uint64_t BackgroundPlanner::request(float toolLength) {
+    uint64_t number;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        number = ++latestRequest_;
+        requestedLength_ = toolLength;
+        hasRequest_ = true;
+        finished_.reset();  // Any older result is out of date
+    }
+    wake_.notify_one();
+    return number;
+}
+
+void BackgroundPlanner::setProgressiveStride(size_t stride) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    progressiveStride_ = stride;
+}
+
+std::unique_ptr<PlanResult> BackgroundPlanner::takeResult() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::move(finished_);
+}
+
+bool BackgroundPlanner::isBusy() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hasRequest_ || planning_;
+}
+
+void BackgroundPlanner::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return !hasRequest_ && !planning_; });
+}
+
+// Join the planned slices in order, leaving out those not planned yet
+static void joinSlices(const std::vector<float>& slices, const std::vector<std::vector<PathPoint>>& slicePaths,
+                       const std::vector<bool>& planned, PlanResult& result) {
+    size_t points = 0;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        points += planned[i] ? slicePaths[i].size() : 0;
+    }
+    result.slices.clear();
+    result.path.clear();
+    result.path.reserve(points);
+    for (size_t i = 0; i < slices.size(); ++i) {
+        if (planned[i]) {
+            result.slices.push_back(slices[i]);
+            result.path.insert(result.path.end(), slicePaths[i].begin(), slicePaths[i].end());
+        }
+    }
+}
+
+// Slice by slice so a newer request can stop it early; the slices planned
+// one at a time join into the same path as calculatePath
+bool BackgroundPlanner::plan(float toolLength, uint64_t requestNumber, size_t stride, PlanResult& result) {
+    TRACE_SCOPE("BackgroundPlanner::plan");
+    auto start = std::chrono::steady_clock::now();
+    result.toolLength = toolLength;
+    result.request = requestNumber;
+    result.complete = true;
+
+    slicer_->setToolLength(toolLength);
+    std::vector<float> slices = slicer_->generateSlices();
+    std::vector<std::vector<PathPoint>> slicePaths(slices.size());
+    std::vector<bool> planned(slices.size(), false);
+
+    // Coarse to fine: every step-th slice, halving the step down to one
+    for (size_t step = std::max<size_t>(1, stride); ; step /= 2) {
+        for (size_t i = 0; i < slices.size(); i += step) {
+            if (planned[i]) {
+                continue;
+            }
+            if (latestRequest_ != requestNumber) {
+                return false;
+            }
+            slicePaths[i] = planner_->calculateSlicePath(slices[i]);
+            planned[i] = true;
+        }
+        if (step == 1) {
+            break;
+        }
+
+        auto coarse = std::make_unique<PlanResult>();
+        coarse->toolLength = toolLength;
+        coarse->request = requestNumber;
+        coarse->complete = false;
+        joinSlices(slices, slicePaths, planned, *coarse);
+        coarse->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        publish(std::move(coarse));
+    }
+
+    joinSlices(slices, slicePaths, planned, result);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Hand out a plan unless a newer request has made it stale
+void BackgroundPlanner::publish(std::unique_ptr<PlanResult> result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (latestRequest_ == result->request) {
+        finished_ = std::move(result);
+    }
+}
+
+void BackgroundPlanner::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return stop_ || hasRequest_; });
+        if (stop_) {
+            return;
+        }
+
+        float toolLength = requestedLength_;
+        size_t stride = progressiveStride_;
+        uint64_t requestNumber = latestRequest_;
+        hasRequest_ = false;
+        planning_ = true;
+        lock.unlock();
+
+        auto result = std::make_unique<PlanResult>();
+        bool completed = plan(toolLength, requestNumber, stride, *result);
+
+        lock.lock();
+        planning_ = false;
+        if (completed && latestRequest_ == requestNumber) {
+            finished_ = std::move(result);
+        }
+        if (!hasRequest_) {
+            idle_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef BACKGROUNDPLANNER_H
+#define BACKGROUNDPLANNER_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "pathplanner.h"
+
+template <typename Scalar>
+class UniformSlicingAlgorithmT;
+using UniformSlicingAlgorithm = UniformSlicingAlgorithmT<float>;
+
+// Slices and path for one tool length
+struct PlanResult {
+    float toolLength;
+    std::vector<float> slices;
+    std::vector<PathPoint> path;
+    uint64_t request;   // Number of the request this answers
+    double seconds;     // Slicing and planning time
+    bool complete;      // False for a coarse plan that leaves out slices
+};
+
+// Re-slices and re-plans one mesh on a worker thread, for viewers that let
+// the user change the tool length without freezing. Only the newest request
+// matters: a request made while another is planned stops that one at the
+// next slice boundary and replaces it, and queued requests are merged.
+//
+// In progressive mode every Nth slice is planned first and handed out as a
+// coarse plan. The stride is then halved until every slice is planned, with
+// a finer plan handed out after each pass. Slices planned in an earlier pass
+// are kept, so the full plan costs no more than planning it directly.
+class BackgroundPlanner {
+public:
+    explicit BackgroundPlanner(const std::vector<Facet>& facets);
+    ~BackgroundPlanner();
+
+    BackgroundPlanner(const BackgroundPlanner&) = delete;
+    BackgroundPlanner& operator=(const BackgroundPlanner&) = delete;
+
+    // Plan for a new tool length; returns the request number
+    uint64_t request(float toolLength);
+
+    // Plan every stride-th slice first for later requests; 0 or 1 plans all
+    // slices in one pass
+    void setProgressiveStride(size_t stride);
+
+    // The newest plan of the newest request, once; null until one is ready.
+    // The caller swaps it in as a whole, so slices and path always match.
+    // Coarse plans come before the complete one and each replaces the last.
+    std::unique_ptr<PlanResult> takeResult();
+
+    // True while a request is queued or being planned
+    bool isBusy() const;
+
+    // Block until the newest request has finished
+    void wait();
+
+private:
+    void workerLoop();
+    bool plan(float toolLength, uint64_t requestNumber, size_t stride, PlanResult& result);
+    void publish(std::unique_ptr<PlanResult> result);
+
+    std::unique_ptr<UniformSlicingAlgorithm> slicer_;
+    std::unique_ptr<PathPlanner> planner_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool hasRequest_;
+    bool planning_;
+    bool stop_;
+    float requestedLength_;
+    size_t progressiveStride_;
+    std::atomic<uint64_t> latestRequest_;
+    std::unique_ptr<PlanResult> finished_;
+    std::thread worker_;
+};
+
+#endif // BACKGROUNDPLANNER_H
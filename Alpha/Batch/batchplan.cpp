@@ -0,0 +1,49 @@
+#include "batchplanner.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+// Plan every part of a job list on a shared thread pool
+// Usage: batchplan <job list> [threads]
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: batchplan <job list> [threads]" << std::endl;
+        std::cout << "Job list lines: <stl file> <tool length> [output .tpath/.nc/.src] [float|double]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BatchJob> jobs;
+    if (!readJobList(argv[1], jobs)) {
+        std::cerr << "Failed to read job list: " << argv[1] << std::endl;
+        return 1;
+    }
+
+    unsigned threads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : 0;
+    ThreadPool pool(threads);
+    std::cout << "Planning " << jobs.size() << " parts on " << pool.getThreadCount() << " threads" << std::endl;
+
+    BatchReport report = runBatch(jobs, pool);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::left << std::setw(40) << "Part" << std::right
+              << std::setw(10) << "Facets" << std::setw(8) << "Slices" << std::setw(10) << "Points"
+              << std::setw(9) << "Load s" << std::setw(9) << "Slice s" << std::setw(9) << "Plan s"
+              << std::setw(9) << "Write s" << std::setw(9) << "Total s" << std::endl;
+
+    int failures = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJobResult& r = report.jobs[i];
+        std::cout << std::left << std::setw(40) << jobs[i].stlFile << std::right;
+        if (!r.success) {
+            std::cout << "  FAILED: " << r.message << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << std::setw(10) << r.facets << std::setw(8) << r.slices << std::setw(10) << r.points
+                  << std::setw(9) << r.loadSeconds << std::setw(9) << r.sliceSeconds << std::setw(9) << r.planSeconds
+                  << std::setw(9) << r.writeSeconds << std::setw(9) << r.totalSeconds << std::endl;
+    }
+
+    std::cout << "Wall time: " << report.wallSeconds << " s" << std::endl;
+    return failures == 0 ? 0 : 2;
+}
@@ -0,0 +1,218 @@
+#include "batchplanner.h"
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include "toolpathfile.h"
+#include "programwriter.h"
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsBetween(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double>(end - start).count();
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Slices of one part and their planner, in the precision the job asked for.
+// Paths are handed back in float, the precision of the path writers.
+class PartPlanner {
+public:
+    virtual ~PartPlanner() = default;
+    virtual size_t getSliceCount() const = 0;
+    virtual std::vector<PathPoint> planSlice(size_t index) const = 0;
+};
+
+template <typename Scalar>
+class PartPlannerT : public PartPlanner {
+public:
+    PartPlannerT(const std::vector<FacetT<Scalar>>& facets, Scalar toolLength) : planner_(facets) {
+        UniformSlicingAlgorithmT<Scalar> slicer(facets);
+        slicer.setToolLength(toolLength);
+        slices_ = slicer.generateSlices();
+    }
+
+    size_t getSliceCount() const override { return slices_.size(); }
+
+    std::vector<PathPoint> planSlice(size_t index) const override {
+        std::vector<PathPointT<Scalar>> points = planner_.calculateSlicePath(slices_[index]);
+        if constexpr (std::is_same<Scalar, float>::value) {
+            return points;
+        }
+        else {
+            return convertPath<float>(points);
+        }
+    }
+
+private:
+    PathPlannerT<Scalar> planner_;
+    std::vector<Scalar> slices_;
+};
+
+// Shared state of one job while its slice tasks run
+struct JobState {
+    BatchJob job;
+    BatchJobResult* result;
+    Clock::time_point jobStart;
+    Clock::time_point planStart;
+    std::unique_ptr<PartPlanner> planner;
+    std::vector<std::vector<PathPoint>> slicePaths;
+    std::atomic<size_t> remainingSlices;
+};
+
+bool writePathFile(const std::string& filename, const std::vector<std::vector<PathPoint>>& slicePaths) {
+    if (endsWith(filename, ".tpath")) {
+        ToolpathWriter writer;
+        if (!writer.open(filename)) {
+            return false;
+        }
+        for (const auto& points : slicePaths) {
+            writer.writeSlice(points);
+        }
+        return writer.close();
+    }
+
+    ProgramWriter writer(endsWith(filename, ".src") ? robotDialect() : gcodeDialect());
+    if (!writer.open(filename)) {
+        return false;
+    }
+    for (size_t i = 0; i < slicePaths.size(); ++i) {
+        writer.writeSlice(i, slicePaths[i]);
+    }
+    return writer.close();
+}
+
+static void finishJob(JobState& state) {
+    TRACE_SCOPE("batch::finishJob");
+    BatchJobResult& result = *state.result;
+    Clock::time_point planEnd = Clock::now();
+    result.planSeconds = secondsBetween(state.planStart, planEnd);
+
+    result.points = 0;
+    for (const auto& points : state.slicePaths) {
+        result.points += points.size();
+    }
+
+    if (!state.job.outputFile.empty()) {
+        if (!writePathFile(state.job.outputFile, state.slicePaths)) {
+            result.success = false;
+            result.message = "Failed to write " + state.job.outputFile;
+        }
+    }
+
+    Clock::time_point end = Clock::now();
+    result.writeSeconds = secondsBetween(planEnd, end);
+    result.totalSeconds = secondsBetween(state.jobStart, end);
+
+    // Release the part's memory as soon as it is done
+    state.planner.reset();
+    state.slicePaths.clear();
+    state.slicePaths.shrink_to_fit();
+}
+
+static void startJob(const std::shared_ptr<JobState>& state, ThreadPool& pool) {
+    TRACE_SCOPE("batch::startJob");
+    BatchJobResult& result = *state->result;
+    state->jobStart = Clock::now();
+
+    if (!(state->job.toolLength > 0.0f)) {
+        result.message = "Tool length must be positive";
+        return;
+    }
+    if (!isValidSTLFile(state->job.stlFile)) {
+        result.message = "Invalid STL file: " + state->job.stlFile;
+        return;
+    }
+
+    STLFileLoader loader(state->job.stlFile);
+    if (!loader.loadSTLFile()) {
+        result.message = "Failed to load " + state->job.stlFile;
+        return;
+    }
+    Clock::time_point loaded = Clock::now();
+    result.loadSeconds = secondsBetween(state->jobStart, loaded);
+    result.facets = loader.getFacets().size();
+
+    if (state->job.precision == Precision::Double) {
+        state->planner = std::make_unique<PartPlannerT<double>>(convertFacets<double>(loader.getFacets()),
+                                                                state->job.toolLength);
+    }
+    else {
+        state->planner = std::make_unique<PartPlannerT<float>>(loader.getFacets(), state->job.toolLength);
+    }
+    size_t numSlices = state->planner->getSliceCount();
+    state->planStart = Clock::now();
+    result.sliceSeconds = secondsBetween(loaded, state->planStart);
+    result.slices = numSlices;
+    result.success = true;
+
+    state->slicePaths.resize(numSlices);
+    state->remainingSlices = numSlices;
+    if (numSlices == 0) {
+        finishJob(*state);
+        return;
+    }
+
+    // One task per slice; the last one to finish writes the output
+    for (size_t i = 0; i < numSlices; ++i) {
+        pool.submit([state, i]() {
+            TRACE_SCOPE("batch::planSlice");
+            state->slicePaths[i] = state->planner->planSlice(i);
+            if (state->remainingSlices.fetch_sub(1) == 1) {
+                finishJob(*state);
+            }
+        });
+    }
+}
+
+BatchReport runBatch(const std::vector<BatchJob>& jobs, ThreadPool& pool) {
+    BatchReport report;
+    report.jobs.assign(jobs.size(), BatchJobResult{false, "", 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0});
+
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        auto state = std::make_shared<JobState>();
+        state->job = jobs[i];
+        state->result = &report.jobs[i];
+        pool.submit([state, &pool]() { startJob(state, pool); });
+    }
+    pool.wait();
+    report.wallSeconds = secondsBetween(start, Clock::now());
+
+    return report;
+}
+
+bool readJobList(const std::string& filename, std::vector<BatchJob>& jobs) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        BatchJob job;
+        if (!(fields >> job.stlFile) || job.stlFile[0] == '#') {
+            continue;
+        }
+        if (!(fields >> job.toolLength) || !(job.toolLength > 0.0f)) {
+            return false;
+        }
+        std::string field;
+        while (fields >> field) {
+            if (!parsePrecision(field, job.precision)) {
+                job.outputFile = field;
+            }
+        }
+        jobs.push_back(job);
+    }
+
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef BATCHPLANNER_H
+#define BATCHPLANNER_H
+
+#include <vector>
+#include <string>
+#include "threadpool.h"
+#include "pathplanner.h"
+
+// One part to plan
+struct BatchJob {
+    std::string stlFile;
+    float toolLength;
+    std::string outputFile;  // .tpath toolpath, .nc/.gcode G-code, .src robot program; empty = none
+    Precision precision = Precision::Single;  // Scalar type for slicing and planning
+};
+
+// Outcome and timings of one job (seconds)
+struct BatchJobResult {
+    bool success;
+    std::string message;
+    size_t facets;
+    size_t slices;
+    size_t points;
+    double loadSeconds;
+    double sliceSeconds;
+    double planSeconds;   // From the first slice task starting to the last one finishing
+    double writeSeconds;
+    double totalSeconds;  // From the job starting to its output being written
+};
+
+struct BatchReport {
+    std::vector<BatchJobResult> jobs;
+    double wallSeconds;
+};
+
+// Plan all jobs on the pool. Parts are loaded and sliced in parallel, and
+// the slices of every part are planned as separate tasks on the same pool.
+BatchReport runBatch(const std::vector<BatchJob>& jobs, ThreadPool& pool);
+
+// Write planned slices in the format given by the file extension:
+// .tpath toolpath, .src robot program, anything else G-code
+bool writePathFile(const std::string& filename, const std::vector<std::vector<PathPoint>>& slicePaths);
+
+// Read a job list: one "<stl file> <tool length> [output file] [float|double]"
+// per line, blank lines and lines starting with # are skipped. Fails on a
+// line without a positive tool length.
+bool readJobList(const std::string& filename, std::vector<BatchJob>& jobs);
+
+#endif // BATCHPLANNER_H
@@ -0,0 +1,106 @@
+#include "threadpool.h"
+#include <algorithm>
+
+// Pool and deque of the worker running on this thread, if any
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local unsigned currentIndex = 0;
+
+ThreadPool::ThreadPool(unsigned numThreads) : queued_(0), unfinished_(0), nextQueue_(0), stop_(false) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < numThreads; ++i) {
+        queues_.push_back(std::make_unique<TaskQueue>());
+    }
+    for (unsigned i = 0; i < numThreads; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    // Workers keep their own tasks local, other threads spread them round-robin
+    unsigned index = (currentPool == this) ? currentIndex
+                                           : nextQueue_.fetch_add(1) % static_cast<unsigned>(queues_.size());
+
+    unfinished_.fetch_add(1);
+    {
+        // Count the task before it becomes visible so the counter never drops
+        // below zero; taking the lock orders it with a worker going to sleep
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    workAvailable_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    allDone_.wait(lock, [this]() { return unfinished_.load() == 0; });
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()>& task) {
+    // Newest task of our own deque first
+    {
+        TaskQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Otherwise steal the oldest task of another deque
+    size_t numQueues = queues_.size();
+    for (size_t offset = 1; offset < numQueues; ++offset) {
+        TaskQueue& victim = *queues_[(index + offset) % numQueues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (popTask(index, task)) {
+            queued_.fetch_sub(1);
+            task();
+
+            if (unfinished_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                allDone_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        workAvailable_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+        if (stop_ && queued_.load() == 0) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Work-stealing thread pool. Every worker owns a task deque: tasks submitted
+// from a worker go to the back of its own deque and are taken LIFO, idle
+// workers steal the oldest tasks from the front of other deques.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned numThreads = 0);  // 0 = hardware concurrency
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task, including tasks submitted by tasks, has finished
+    void wait();
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popTask(unsigned index, std::function<void()>& task);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_;     // Tasks waiting in any deque
+    std::atomic<size_t> unfinished_; // Tasks submitted but not yet finished
+    std::atomic<unsigned> nextQueue_;
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    bool stop_;
+};
+
+// Run worker() on numThreads threads, the calling thread being one of them,
+// and return once every one has finished. 0 = hardware concurrency. For
+// workers that keep per-thread state, e.g. a GL context, across their items.
+template <typename Worker>
+void runWorkers(unsigned numThreads, const Worker& worker) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Run body(i) for i in [0, count) on up to numThreads threads, handing out
+// chunks of indices through a shared counter so uneven costs balance out
+template <typename Body>
+void parallelFor(size_t count, unsigned numThreads, const Body& body, size_t chunk = 1) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    numThreads = static_cast<unsigned>(std::min<size_t>(numThreads, (count + chunk - 1) / chunk));
+    if (numThreads == 0) {
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    runWorkers(numThreads, [&]() {
+        while (true) {
+            size_t begin = next.fetch_add(chunk);
+            if (begin >= count) {
+                break;
+            }
+            size_t end = std::min(count, begin + chunk);
+            for (size_t i = begin; i < end; ++i) {
+                body(i);
+            }
+        }
+    });
+}
+
+#endif // THREADPOOL_H
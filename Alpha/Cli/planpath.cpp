@@ -0,0 +1,332 @@
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include "pathresampler.h"
+#include "gougecheck.h"
+#include "stocksimulator.h"
+#include "bandplanner.h"
+#include "pipelineplanner.h"
+#include "batchplanner.h"
+#include "trace.h"
+#include "memstats.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+static void printUsage() {
+    std::cout << "Usage: planpath <stl file> <tool length> [options]" << std::endl;
+    std::cout << "  -o <file>          Write the path (.tpath toolpath, .src robot program, else G-code)" << std::endl;
+    std::cout << "  --raster           Raster fill each slice instead of following the outline" << std::endl;
+    std::cout << "  --oneway           One-way raster passes (implies --raster)" << std::endl;
+    std::cout << "  --resample <chord> Resample the outline path at this chord length (not with --raster)" << std::endl;
+    std::cout << "  --gouge <radius>   Check and correct gouging for a ball tool of this radius" << std::endl;
+    std::cout << "  --stock <radius>   Simulate the stock cut by a ball tool of this radius" << std::endl;
+    std::cout << "  --budget <MB>      Plan out of core in Z bands holding at most this much facet data" << std::endl;
+    std::cout << "  --bands <n>        Plan out of core in this many Z bands (default: from budget and threads)" << std::endl;
+    std::cout << "  --pipeline         Plan while loading; overlaps fully when facets are sorted by Z" << std::endl;
+    std::cout << "  --threads <n>      Threads for the gouge check, stock and bands (default: all cores)" << std::endl;
+    std::cout << "  --trace <file>     Write a Chrome trace (JSON) and print a per-scope summary" << std::endl;
+    std::cout << "  --memory           Report allocations and peak heap per stage and container sizes" << std::endl;
+}
+
+// Times the stages of one run and prints them as a table at the end. With
+// memory accounting on, each stage also gets its allocations and heap peak.
+class StageTimer {
+public:
+    StageTimer() : start_(Clock::now()), last_(start_), memory_(getMemoryCounters()) {
+        resetMemoryPeak();
+    }
+
+    void stage(const char* name) {
+        Clock::time_point now = Clock::now();
+        MemoryCounters memory = getMemoryCounters();
+        names_.push_back(name);
+        seconds_.push_back(std::chrono::duration<double>(now - last_).count());
+        allocations_.push_back(memory.allocations - memory_.allocations);
+        peakBytes_.push_back(memory.peakBytes);
+        last_ = now;
+        resetMemoryPeak();
+        memory_ = getMemoryCounters();
+    }
+
+    void print() const {
+        bool memory = isMemoryAccountingEnabled() && memoryHooksInstalled();
+        std::cout << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < names_.size(); ++i) {
+            std::cout << std::left << std::setw(12) << names_[i] << std::right
+                      << std::setw(10) << seconds_[i] << " s";
+            if (memory) {
+                std::cout << std::setw(12) << allocations_[i] << " allocs"
+                          << std::setw(12) << peakBytes_[i] / (1024.0 * 1024.0) << " MB peak";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::left << std::setw(12) << "total" << std::right
+                  << std::setw(10) << std::chrono::duration<double>(last_ - start_).count() << " s" << std::endl;
+    }
+
+private:
+    Clock::time_point start_;
+    Clock::time_point last_;
+    MemoryCounters memory_;
+    std::vector<const char*> names_;
+    std::vector<double> seconds_;
+    std::vector<size_t> allocations_;
+    std::vector<size_t> peakBytes_;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string filename = argv[1];
+    float toolLength = static_cast<float>(std::atof(argv[2]));
+    std::string outputFile;
+    bool raster = false;
+    RasterMode rasterMode = RasterMode::ZigZag;
+    float chordLength = 0.0f;
+    float gougeRadius = 0.0f;
+    float stockRadius = 0.0f;
+    size_t budgetMB = 0;
+    size_t bandCount = 0;
+    bool pipeline = false;
+    unsigned threads = 0;
+    std::string traceFile;
+    bool memory = false;
+
+    for (int i = 3; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+            outputFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--raster") == 0) {
+            raster = true;
+        }
+        else if (std::strcmp(argv[i], "--oneway") == 0) {
+            raster = true;
+            rasterMode = RasterMode::OneWay;
+        }
+        else if (std::strcmp(argv[i], "--resample") == 0 && hasValue) {
+            chordLength = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--gouge") == 0 && hasValue) {
+            gougeRadius = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--stock") == 0 && hasValue) {
+            stockRadius = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--budget") == 0 && hasValue) {
+            budgetMB = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--bands") == 0 && hasValue) {
+            bandCount = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--pipeline") == 0) {
+            pipeline = true;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--memory") == 0) {
+            memory = true;
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            traceFile = argv[++i];
+        }
+        else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (toolLength <= 0.0f) {
+        std::cerr << "Tool length must be positive" << std::endl;
+        return 1;
+    }
+
+    // Out of core and pipelined the part is never loaded as a whole, so stages that need all facets are unavailable
+    bool outOfCore = budgetMB > 0 || bandCount > 0;
+    if ((outOfCore || pipeline) && (raster || gougeRadius > 0.0f || stockRadius > 0.0f)) {
+        std::cerr << "--budget, --bands and --pipeline plan outlines only; --raster, --gouge and --stock need "
+                  << "the whole part" << std::endl;
+        return 1;
+    }
+    if (raster && chordLength > 0.0f) {
+        // Raster paths are start/end pairs, one per span; resampling would join the spans
+        std::cerr << "--resample follows outlines and cannot be combined with --raster or --oneway" << std::endl;
+        return 1;
+    }
+    if (outOfCore && pipeline) {
+        std::cerr << "--pipeline cannot be combined with --budget or --bands" << std::endl;
+        return 1;
+    }
+
+    setTracingEnabled(!traceFile.empty());
+    setMemoryAccountingEnabled(memory);
+    StageTimer timer;
+
+    if (!isValidSTLFile(filename)) {
+        std::cerr << "Invalid STL file: " << filename << std::endl;
+        return 1;
+    }
+    STLFileLoader loader(filename);
+    const std::vector<Facet>& facets = loader.getFacets();
+    size_t facetCount = 0;
+    std::vector<float> slices;
+    std::vector<std::vector<PathPoint>> slicePaths;
+
+    auto collectSlice = [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+        slicePaths.resize(std::max(slicePaths.size(), sliceIndex + 1));
+        slicePaths[sliceIndex] = points;
+    };
+
+    if (pipeline) {
+        PipelineOptions pipelineOptions = {toolLength, threads, 0};
+        PipelineReport pipelineReport;
+        if (!planPipelined(filename, pipelineOptions, slices, collectSlice, pipelineReport)) {
+            std::cerr << "Failed to plan " << filename << " in a pipeline" << std::endl;
+            return 1;
+        }
+        slicePaths.resize(slices.size());
+        facetCount = pipelineReport.facets;
+        timer.stage("pipeline");
+        std::cout << pipelineReport.bands << " bands, " << pipelineReport.bandsDuringLoad << " planned while loading"
+                  << (pipelineReport.sortedInput ? "" : " (facets not sorted by Z)") << ", load done after "
+                  << pipelineReport.loadSeconds << " s of " << pipelineReport.seconds << " s" << std::endl;
+    }
+    else if (outOfCore) {
+        BandPlanOptions bandOptions = {toolLength, budgetMB * 1024 * 1024, bandCount, threads};
+        BandPlanReport bandReport;
+        if (!planInBands(filename, bandOptions, slices, collectSlice, bandReport)) {
+            std::cerr << "Failed to plan " << filename << " in bands" << std::endl;
+            return 1;
+        }
+        slicePaths.resize(slices.size());
+        facetCount = bandReport.facets;
+        timer.stage("bands");
+        std::cout << bandReport.bands << " bands, " << bandReport.spilledFacets << " facets spilled, "
+                  << bandReport.peakResidentBytes / (1024.0 * 1024.0) << " MB of band facets at most" << std::endl;
+    }
+    else {
+        if (!loader.loadSTLFile()) {
+            std::cerr << "Failed to load " << filename << std::endl;
+            return 1;
+        }
+        facetCount = facets.size();
+        timer.stage("load");
+
+        UniformSlicingAlgorithm slicer(facets);
+        slicer.setToolLength(toolLength);
+        slices = slicer.generateSlices();
+        timer.stage("slice");
+
+        // Plan slice by slice so every stage below keeps the slice boundaries
+        PathPlanner planner(facets);
+        slicePaths.resize(slices.size());
+        if (raster) {
+            for (size_t i = 0; i < slices.size(); ++i) {
+                slicePaths[i] = planner.calculateRasterPath({slices[i]}, toolLength, rasterMode);
+            }
+        }
+        else {
+            planner.streamPath(slices, [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+                slicePaths[sliceIndex] = points;
+            });
+        }
+        timer.stage("plan");
+    }
+
+    if (chordLength > 0.0f) {
+        ResampleOptions options = {chordLength, 0.0f};
+        for (auto& points : slicePaths) {
+            points = resamplePath(points, options);
+        }
+        timer.stage("resample");
+    }
+
+    size_t gouging = 0;
+    size_t remaining = 0;
+    if (gougeRadius > 0.0f) {
+        FacetBVH bvh(facets);
+        timer.stage("bvh");
+
+        ToolModel tool = {gougeRadius, toolLength, 1.0e-4f};
+        for (auto& points : slicePaths) {
+            for (const auto& result : checkGouging(bvh, points, tool, threads)) {
+                gouging += result.gouging ? 1 : 0;
+            }
+            remaining += correctGouging(bvh, points, tool, 4, threads);
+        }
+        timer.stage("gouge");
+    }
+
+    // Dexels one tool radius apart; the margin leaves one tool diameter of stock around the part
+    double removedVolume = 0.0;
+    size_t airPasses = 0;
+    double restVolume = 0.0;
+    size_t restRegions = 0;
+    if (stockRadius > 0.0f) {
+        StockSimulator stock(facets, {stockRadius, stockRadius * 2.0f, threads});
+        ToolModel tool = {stockRadius, toolLength, 0.0f};
+        for (const auto& removal : stock.cut(slicePaths, tool)) {
+            removedVolume += removal.removedVolume;
+            airPasses += removal.removedVolume == 0.0 ? 1 : 0;
+        }
+        restVolume = stock.getRestVolume();
+        restRegions = stock.findRestMaterial(stockRadius * 0.1f).size();
+        timer.stage("stock");
+    }
+
+    if (!outputFile.empty()) {
+        if (!writePathFile(outputFile, slicePaths)) {
+            std::cerr << "Failed to write " << outputFile << std::endl;
+            return 1;
+        }
+        timer.stage("write");
+    }
+
+    size_t points = 0;
+    size_t pathBytes = 0;
+    for (const auto& slicePath : slicePaths) {
+        points += slicePath.size();
+        pathBytes += slicePath.capacity() * sizeof(PathPoint);
+    }
+    MemoryTally pathTally("planned path");
+    pathTally.set(pathBytes);
+
+    std::cout << filename << ": " << facetCount << " facets, " << slices.size() << " slices, "
+              << points << " points" << std::endl;
+    if (gougeRadius > 0.0f) {
+        std::cout << gouging << " gouging points, " << remaining << " still gouging after correction" << std::endl;
+    }
+    if (stockRadius > 0.0f) {
+        std::cout << removedVolume << " removed, " << airPasses << " passes cutting only air, " << restVolume
+                  << " rest material in " << restRegions << " regions" << std::endl;
+    }
+    timer.print();
+
+    if (memory) {
+        std::cout << std::endl;
+        printMemoryReport(std::cout);
+    }
+
+    if (!traceFile.empty()) {
+        setTracingEnabled(false);
+        std::cout << std::endl;
+        printTraceSummary(std::cout);
+        if (!writeChromeTrace(traceFile)) {
+            std::cerr << "Failed to write " << traceFile << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
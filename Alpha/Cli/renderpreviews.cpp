@@ -0,0 +1,239 @@
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include "batchplanner.h"
+#include "threadpool.h"
+#include "offscreencontext.h"
+#include "previewrenderer.h"
+#include "pngwriter.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+// Exit code ctest treats as a skipped test
+constexpr int EXIT_SKIPPED = 77;
+
+static void printUsage() {
+    std::cout << "Usage: renderpreviews <stl file | job list> [tool length] [options]" << std::endl;
+    std::cout << "  Renders each part without a display to <output dir>/<part>_<view>.png." << std::endl;
+    std::cout << "  A job list has one \"<stl file> <tool length> [float|double]\" per line; parts are" << std::endl;
+    std::cout << "  sliced and planned in the precision their line asks for (default: float)." << std::endl;
+    std::cout << "  -o <dir>           Output directory (default: current directory)" << std::endl;
+    std::cout << "  --size <pixels>    Image width and height (default: 512)" << std::endl;
+    std::cout << "  --views <list>     Comma separated views: iso,front,side,top (default: all)" << std::endl;
+    std::cout << "  --threads <n>      Parts rendered at once, one GL context each (default: all cores)" << std::endl;
+    std::cout << "  --no-slices        Leave out the slice planes" << std::endl;
+    std::cout << "  --no-path          Leave out the tool path" << std::endl;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// File name without directory and extension
+static std::string partName(const std::string& filename) {
+    size_t slash = filename.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? filename : filename.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static bool selectViews(const std::string& list, std::vector<PreviewView>& views) {
+    std::istringstream names(list);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        const std::vector<PreviewView>& presets = getPreviewViews();
+        auto it = std::find_if(presets.begin(), presets.end(),
+                               [&](const PreviewView& view) { return view.name == name; });
+        if (it == presets.end()) {
+            return false;
+        }
+        views.push_back(*it);
+    }
+    return !views.empty();
+}
+
+// Slice and plan in the job's precision; the renderer takes float
+template <typename Scalar>
+static void planPart(const std::vector<FacetT<Scalar>>& facets, Scalar toolLength, bool planPath,
+                     std::vector<float>& slices, std::vector<PathPoint>& path) {
+    UniformSlicingAlgorithmT<Scalar> slicer(facets);
+    slicer.setToolLength(toolLength);
+    std::vector<Scalar> partSlices = slicer.generateSlices();
+    slices.assign(partSlices.begin(), partSlices.end());
+    if (planPath) {
+        PathPlannerT<Scalar> planner(facets);
+        path = convertPath<float>(planner.calculatePath(partSlices));
+    }
+}
+
+// Load, slice and plan one part, then render and write every view
+static bool renderPart(const BatchJob& job, const std::vector<PreviewView>& views, const PreviewOptions& options,
+                       const std::string& outputDir, OffscreenContext& context, std::string& message) {
+    TRACE_SCOPE("renderpreviews::part");
+    if (!isValidSTLFile(job.stlFile)) {
+        message = "Invalid STL file: " + job.stlFile;
+        return false;
+    }
+    STLFileLoader loader(job.stlFile);
+    if (!loader.loadSTLFile()) {
+        message = "Failed to load " + job.stlFile;
+        return false;
+    }
+    const std::vector<Facet>& facets = loader.getFacets();
+
+    std::vector<float> slices;
+    std::vector<PathPoint> path;
+    if (options.showSlices || options.showPath) {
+        if (job.precision == Precision::Double) {
+            planPart<double>(convertFacets<double>(facets), job.toolLength, options.showPath, slices, path);
+        }
+        else {
+            planPart<float>(facets, job.toolLength, options.showPath, slices, path);
+        }
+    }
+
+    PreviewRenderer renderer;
+    renderer.setPart(facets, slices, path);
+
+    std::vector<uint8_t> pixels;
+    std::string name = partName(job.stlFile);
+    for (const auto& view : views) {
+        renderer.render(view, options, context.getWidth(), context.getHeight());
+        context.readPixels(pixels);
+        std::string filename = outputDir + "/" + name + "_" + view.name + ".png";
+        if (!writePNG(filename, context.getWidth(), context.getHeight(), pixels)) {
+            renderer.release();
+            message = "Failed to write " + filename;
+            return false;
+        }
+    }
+    renderer.release();
+
+    message = std::to_string(facets.size()) + " facets, " + std::to_string(slices.size()) + " slices, " +
+              std::to_string(path.size()) + " points";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::string input = argv[1];
+    int argIndex = 2;
+    float toolLength = 1.0f;
+    if (argIndex < argc && argv[argIndex][0] != '-') {
+        toolLength = static_cast<float>(std::atof(argv[argIndex++]));
+    }
+
+    std::string outputDir = ".";
+    int size = 512;
+    unsigned threads = 0;
+    std::vector<PreviewView> views;
+    PreviewOptions options = {true, true, true};
+
+    for (int i = argIndex; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+            outputDir = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            size = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--views") == 0 && hasValue) {
+            if (!selectViews(argv[++i], views)) {
+                std::cerr << "Unknown view in " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--no-slices") == 0) {
+            options.showSlices = false;
+        }
+        else if (std::strcmp(argv[i], "--no-path") == 0) {
+            options.showPath = false;
+        }
+        else {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (toolLength <= 0.0f || size <= 0) {
+        std::cerr << "Tool length and image size must be positive" << std::endl;
+        return 1;
+    }
+    if (views.empty()) {
+        views = getPreviewViews();
+    }
+
+    std::vector<BatchJob> jobs;
+    if (endsWith(input, ".stl") || endsWith(input, ".STL")) {
+        jobs.push_back(BatchJob{input, toolLength, ""});
+    }
+    else if (!readJobList(input, jobs)) {
+        std::cerr << "Failed to read job list " << input << std::endl;
+        return 1;
+    }
+    if (jobs.empty()) {
+        std::cerr << "No parts to render in " << input << std::endl;
+        return 1;
+    }
+
+    if (!OffscreenContext::isSupported()) {
+        std::cerr << "Offscreen rendering is not available in this build" << std::endl;
+        return EXIT_SKIPPED;
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(jobs.size()));
+
+    // Every worker owns one context and takes the next part until none are left
+    Clock::time_point start = Clock::now();
+    std::atomic<size_t> nextJob(0);
+    std::atomic<size_t> failures(0);
+    std::atomic<size_t> contextFailures(0);
+    std::mutex outputMutex;
+    runWorkers(threads, [&]() {
+        OffscreenContext context;
+        if (!context.create(size, size)) {
+            contextFailures++;
+            return;
+        }
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            std::string message;
+            bool success = renderPart(jobs[i], views, options, outputDir, context, message);
+            failures += success ? 0 : 1;
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            (success ? std::cout : std::cerr) << jobs[i].stlFile << ": " << message << std::endl;
+        }
+        context.destroy();
+    });
+
+    if (contextFailures == threads) {
+        std::cerr << "Could not create an offscreen GL context" << std::endl;
+        return EXIT_SKIPPED;
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << jobs.size() << " parts, " << jobs.size() * views.size() << " images in " << seconds << " s"
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,442 @@
+#include "facetbvh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr int SAH_BINS = 12;
+constexpr size_t MAX_LEAF_SIZE = 4;
+constexpr int MAX_DEPTH = 60;         // Keeps the traversal stack below 64 entries
+
+static inline float dot3(const float a[3], const float b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline void sub3(const float a[3], const float b[3], float out[3]) {
+    out[0] = a[0] - b[0];
+    out[1] = a[1] - b[1];
+    out[2] = a[2] - b[2];
+}
+
+static inline float distanceSq3(const float a[3], const float b[3]) {
+    float d[3];
+    sub3(a, b, d);
+    return dot3(d, d);
+}
+
+static float surfaceArea(const float boundsMin[3], const float boundsMax[3]) {
+    float dx = boundsMax[0] - boundsMin[0];
+    float dy = boundsMax[1] - boundsMin[1];
+    float dz = boundsMax[2] - boundsMin[2];
+    if (dx < 0.0f || dy < 0.0f || dz < 0.0f) {
+        return 0.0f;
+    }
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+// Closest point on triangle abc to point p (Voronoi region walk)
+static void closestPointOnTriangle(const float p[3], const float a[3], const float b[3],
+                                   const float c[3], float out[3]) {
+    float ab[3], ac[3], ap[3];
+    sub3(b, a, ab);
+    sub3(c, a, ac);
+    sub3(p, a, ap);
+    float d1 = dot3(ab, ap), d2 = dot3(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        std::copy(a, a + 3, out);
+        return;
+    }
+
+    float bp[3];
+    sub3(p, b, bp);
+    float d3 = dot3(ab, bp), d4 = dot3(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        std::copy(b, b + 3, out);
+        return;
+    }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        for (int k = 0; k < 3; ++k) out[k] = a[k] + v * ab[k];
+        return;
+    }
+
+    float cp[3];
+    sub3(p, c, cp);
+    float d5 = dot3(ab, cp), d6 = dot3(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        std::copy(c, c + 3, out);
+        return;
+    }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        for (int k = 0; k < 3; ++k) out[k] = a[k] + w * ac[k];
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        for (int k = 0; k < 3; ++k) out[k] = b[k] + w * (c[k] - b[k]);
+        return;
+    }
+
+    float denom = 1.0f / (va + vb + vc);
+    float v = vb * denom, w = vc * denom;
+    for (int k = 0; k < 3; ++k) out[k] = a[k] + ab[k] * v + ac[k] * w;
+}
+
+// Squared distance between segments p1-q1 and p2-q2
+static float segmentSegmentDistanceSq(const float p1[3], const float q1[3],
+                                      const float p2[3], const float q2[3]) {
+    const float eps = 1.0e-12f;
+    float d1[3], d2[3], r[3];
+    sub3(q1, p1, d1);
+    sub3(q2, p2, d2);
+    sub3(p1, p2, r);
+    float a = dot3(d1, d1), e = dot3(d2, d2), f = dot3(d2, r);
+    float s, t;
+
+    if (a <= eps && e <= eps) {
+        return distanceSq3(p1, p2);
+    }
+    if (a <= eps) {
+        s = 0.0f;
+        t = std::clamp(f / e, 0.0f, 1.0f);
+    }
+    else {
+        float c = dot3(d1, r);
+        if (e <= eps) {
+            t = 0.0f;
+            s = std::clamp(-c / a, 0.0f, 1.0f);
+        }
+        else {
+            float b = dot3(d1, d2);
+            float denom = a * e - b * b;
+            s = (denom > eps) ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = std::clamp(-c / a, 0.0f, 1.0f);
+            }
+            else if (t > 1.0f) {
+                t = 1.0f;
+                s = std::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    float c1[3], c2[3];
+    for (int k = 0; k < 3; ++k) {
+        c1[k] = p1[k] + d1[k] * s;
+        c2[k] = p2[k] + d2[k] * t;
+    }
+    return distanceSq3(c1, c2);
+}
+
+// Segment p0-p1 crosses the interior of triangle abc
+static bool segmentIntersectsTriangle(const float p0[3], const float p1[3],
+                                      const float a[3], const float b[3], const float c[3]) {
+    float dir[3], e1[3], e2[3], h[3], s[3], q[3];
+    sub3(p1, p0, dir);
+    sub3(b, a, e1);
+    sub3(c, a, e2);
+    h[0] = dir[1] * e2[2] - dir[2] * e2[1];
+    h[1] = dir[2] * e2[0] - dir[0] * e2[2];
+    h[2] = dir[0] * e2[1] - dir[1] * e2[0];
+    float det = dot3(e1, h);
+    if (std::abs(det) < 1.0e-12f) {
+        return false;
+    }
+    float inv = 1.0f / det;
+    sub3(p0, a, s);
+    float u = dot3(s, h) * inv;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    q[0] = s[1] * e1[2] - s[2] * e1[1];
+    q[1] = s[2] * e1[0] - s[0] * e1[2];
+    q[2] = s[0] * e1[1] - s[1] * e1[0];
+    float v = dot3(dir, q) * inv;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    float t = dot3(e2, q) * inv;
+    return t >= 0.0f && t <= 1.0f;
+}
+
+float segmentTriangleDistance(const float p0[3], const float p1[3],
+                              const float a[3], const float b[3], const float c[3]) {
+    if (segmentIntersectsTriangle(p0, p1, a, b, c)) {
+        return 0.0f;
+    }
+
+    // Otherwise the closest pair involves a segment end or a triangle edge
+    float closest[3];
+    closestPointOnTriangle(p0, a, b, c, closest);
+    float best = distanceSq3(p0, closest);
+    closestPointOnTriangle(p1, a, b, c, closest);
+    best = std::min(best, distanceSq3(p1, closest));
+    best = std::min(best, segmentSegmentDistanceSq(p0, p1, a, b));
+    best = std::min(best, segmentSegmentDistanceSq(p0, p1, b, c));
+    best = std::min(best, segmentSegmentDistanceSq(p0, p1, c, a));
+    return std::sqrt(best);
+}
+
+FacetBVH::FacetBVH(const std::vector<Facet>& facets) {
+    if (facets.empty()) {
+        return;
+    }
+
+    std::vector<BuildItem> items(facets.size());
+    for (size_t i = 0; i < facets.size(); ++i) {
+        BuildItem& item = items[i];
+        for (int k = 0; k < 3; ++k) {
+            const Facet& f = facets[i];
+            item.boundsMin[k] = std::min({f.vertices[0][k], f.vertices[1][k], f.vertices[2][k]});
+            item.boundsMax[k] = std::max({f.vertices[0][k], f.vertices[1][k], f.vertices[2][k]});
+            item.centroid[k] = (f.vertices[0][k] + f.vertices[1][k] + f.vertices[2][k]) / 3.0f;
+        }
+        item.facet = static_cast<uint32_t>(i);
+    }
+
+    nodes_.reserve(2 * facets.size() / MAX_LEAF_SIZE + 1);
+    build(items, 0, items.size(), 0);
+
+    // Copy triangles in leaf order
+    triangles_.resize(items.size() * 9);
+    for (size_t i = 0; i < items.size(); ++i) {
+        const Facet& f = facets[items[i].facet];
+        for (int v = 0; v < 3; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                triangles_[i * 9 + v * 3 + k] = f.vertices[v][k];
+            }
+        }
+    }
+}
+
+uint32_t FacetBVH::build(std::vector<BuildItem>& items, size_t begin, size_t end, int depth) {
+    uint32_t nodeIndex = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(BVHNode());
+
+    float boundsMin[3], boundsMax[3], centroidMin[3], centroidMax[3];
+    for (int k = 0; k < 3; ++k) {
+        boundsMin[k] = centroidMin[k] = std::numeric_limits<float>::max();
+        boundsMax[k] = centroidMax[k] = -std::numeric_limits<float>::max();
+    }
+    for (size_t i = begin; i < end; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            boundsMin[k] = std::min(boundsMin[k], items[i].boundsMin[k]);
+            boundsMax[k] = std::max(boundsMax[k], items[i].boundsMax[k]);
+            centroidMin[k] = std::min(centroidMin[k], items[i].centroid[k]);
+            centroidMax[k] = std::max(centroidMax[k], items[i].centroid[k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        nodes_[nodeIndex].boundsMin[k] = boundsMin[k];
+        nodes_[nodeIndex].boundsMax[k] = boundsMax[k];
+    }
+
+    size_t count = end - begin;
+    auto makeLeaf = [&]() {
+        nodes_[nodeIndex].offset = static_cast<uint32_t>(begin);
+        nodes_[nodeIndex].count = static_cast<uint32_t>(count);
+        return nodeIndex;
+    };
+    if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH) {
+        return makeLeaf();
+    }
+
+    // Binned SAH: evaluate SAH_BINS - 1 split planes on every axis
+    int bestAxis = -1, bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis) {
+        float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f) {
+            continue;
+        }
+
+        struct Bin {
+            float boundsMin[3], boundsMax[3];
+            size_t count;
+        } bins[SAH_BINS];
+        for (auto& bin : bins) {
+            for (int k = 0; k < 3; ++k) {
+                bin.boundsMin[k] = std::numeric_limits<float>::max();
+                bin.boundsMax[k] = -std::numeric_limits<float>::max();
+            }
+            bin.count = 0;
+        }
+
+        float scale = SAH_BINS / extent;
+        for (size_t i = begin; i < end; ++i) {
+            int b = std::min(SAH_BINS - 1, static_cast<int>((items[i].centroid[axis] - centroidMin[axis]) * scale));
+            Bin& bin = bins[b];
+            bin.count++;
+            for (int k = 0; k < 3; ++k) {
+                bin.boundsMin[k] = std::min(bin.boundsMin[k], items[i].boundsMin[k]);
+                bin.boundsMax[k] = std::max(bin.boundsMax[k], items[i].boundsMax[k]);
+            }
+        }
+
+        // Sweep from the right to get the area and count of every right side
+        float rightArea[SAH_BINS];
+        size_t rightCount[SAH_BINS];
+        float accMin[3], accMax[3];
+        size_t accCount = 0;
+        for (int k = 0; k < 3; ++k) {
+            accMin[k] = std::numeric_limits<float>::max();
+            accMax[k] = -std::numeric_limits<float>::max();
+        }
+        for (int b = SAH_BINS - 1; b > 0; --b) {
+            for (int k = 0; k < 3; ++k) {
+                accMin[k] = std::min(accMin[k], bins[b].boundsMin[k]);
+                accMax[k] = std::max(accMax[k], bins[b].boundsMax[k]);
+            }
+            accCount += bins[b].count;
+            rightArea[b] = surfaceArea(accMin, accMax);
+            rightCount[b] = accCount;
+        }
+
+        // Sweep from the left and evaluate each split
+        for (int k = 0; k < 3; ++k) {
+            accMin[k] = std::numeric_limits<float>::max();
+            accMax[k] = -std::numeric_limits<float>::max();
+        }
+        accCount = 0;
+        for (int b = 0; b < SAH_BINS - 1; ++b) {
+            for (int k = 0; k < 3; ++k) {
+                accMin[k] = std::min(accMin[k], bins[b].boundsMin[k]);
+                accMax[k] = std::max(accMax[k], bins[b].boundsMax[k]);
+            }
+            accCount += bins[b].count;
+            if (accCount == 0 || rightCount[b + 1] == 0) {
+                continue;
+            }
+            float cost = surfaceArea(accMin, accMax) * accCount + rightArea[b + 1] * rightCount[b + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = b;
+            }
+        }
+    }
+
+    // Keep the node as a leaf when no split beats testing every triangle
+    float leafCost = surfaceArea(boundsMin, boundsMax) * count;
+    if (bestAxis < 0 || (bestCost >= leafCost && count <= 4 * MAX_LEAF_SIZE)) {
+        return makeLeaf();
+    }
+
+    float scale = SAH_BINS / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+    float splitMin = centroidMin[bestAxis];
+    auto middle = std::partition(items.begin() + begin, items.begin() + end, [&](const BuildItem& item) {
+        int b = std::min(SAH_BINS - 1, static_cast<int>((item.centroid[bestAxis] - splitMin) * scale));
+        return b <= bestSplit;
+    });
+    size_t mid = middle - items.begin();
+
+    build(items, begin, mid, depth + 1);
+    uint32_t secondChild = build(items, mid, end, depth + 1);
+    nodes_[nodeIndex].offset = secondChild;
+    nodes_[nodeIndex].count = 0;
+    return nodeIndex;
+}
+
+float FacetBVH::segmentDistance(const float a[3], const float b[3], float maxDistance) const {
+    float best = maxDistance;
+    if (nodes_.empty()) {
+        return best;
+    }
+
+    float segMin[3], segMax[3];
+    for (int k = 0; k < 3; ++k) {
+        segMin[k] = std::min(a[k], b[k]);
+        segMax[k] = std::max(a[k], b[k]);
+    }
+
+    uint32_t stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = nodes_[stack[--stackSize]];
+
+        // Skip nodes outside the segment bounds grown by the current best distance
+        bool overlaps = true;
+        for (int k = 0; k < 3; ++k) {
+            if (node.boundsMin[k] > segMax[k] + best || node.boundsMax[k] < segMin[k] - best) {
+                overlaps = false;
+                break;
+            }
+        }
+        if (!overlaps) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                const float* t = &triangles_[(node.offset + i) * 9];
+                best = std::min(best, segmentTriangleDistance(a, b, t, t + 3, t + 6));
+            }
+        }
+        else {
+            uint32_t first = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = first;
+        }
+    }
+
+    return best;
+}
+
+// Squared distance from p to a node's bounds, 0 inside
+static float boxDistanceSq(const BVHNode& node, const float p[3]) {
+    float distanceSq = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        float d = std::max({node.boundsMin[k] - p[k], 0.0f, p[k] - node.boundsMax[k]});
+        distanceSq += d * d;
+    }
+    return distanceSq;
+}
+
+float FacetBVH::pointDistance(const float p[3], float maxDistance) const {
+    float bestSq = maxDistance * maxDistance;
+    if (nodes_.empty()) {
+        return maxDistance;
+    }
+
+    uint32_t stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = nodes_[stack[--stackSize]];
+        if (boxDistanceSq(node, p) >= bestSq) {
+            continue;
+        }
+
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                const float* t = &triangles_[(node.offset + i) * 9];
+                float closest[3];
+                closestPointOnTriangle(p, t, t + 3, t + 6, closest);
+                bestSq = std::min(bestSq, distanceSq3(p, closest));
+            }
+        }
+        else {
+            // Push the farther child first so the nearer one is searched first
+            uint32_t first = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+            uint32_t second = node.offset;
+            if (boxDistanceSq(nodes_[first], p) > boxDistanceSq(nodes_[second], p)) {
+                std::swap(first, second);
+            }
+            stack[stackSize++] = second;
+            stack[stackSize++] = first;
+        }
+    }
+
+    return std::min(std::sqrt(bestSq), maxDistance);
+}
@@ -0,0 +1,50 @@
+#ifndef FACETBVH_H
+#define FACETBVH_H
+
+#include <vector>
+#include <cstdint>
+#include "stlfileloader.h"
+
+// Flattened BVH node (32 bytes). Nodes are stored depth first, so the first
+// child of an inner node is the next node and only the second child is linked.
+struct BVHNode {
+    float boundsMin[3];
+    uint32_t offset;    // Leaf: first triangle, inner: index of the second child
+    float boundsMax[3];
+    uint32_t count;     // Triangles in a leaf, 0 for inner nodes
+};
+
+// Bounding volume hierarchy over mesh facets, built with a binned surface
+// area heuristic. Triangles are copied in leaf order for cache-friendly queries.
+class FacetBVH {
+public:
+    FacetBVH(const std::vector<Facet>& facets);
+
+    // Shortest distance from segment a-b to the mesh, searching only up to
+    // maxDistance. Returns maxDistance if no facet is closer.
+    float segmentDistance(const float a[3], const float b[3], float maxDistance) const;
+
+    // Shortest distance from point p to the mesh, same conventions. Visits
+    // the nearer child first, so it is much cheaper than a zero-length segment.
+    float pointDistance(const float p[3], float maxDistance) const;
+
+    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getTriangleCount() const { return triangles_.size() / 9; }
+
+private:
+    struct BuildItem {
+        float boundsMin[3], boundsMax[3], centroid[3];
+        uint32_t facet;
+    };
+
+    uint32_t build(std::vector<BuildItem>& items, size_t begin, size_t end, int depth);
+
+    std::vector<BVHNode> nodes_;
+    std::vector<float> triangles_;   // 9 floats per triangle in leaf order
+};
+
+// Closest distance between segment p0-p1 and triangle (a, b, c)
+float segmentTriangleDistance(const float p0[3], const float p1[3],
+                              const float a[3], const float b[3], const float c[3]);
+
+#endif // FACETBVH_H
@@ -0,0 +1,76 @@
+#include "gougecheck.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cmath>
+
+// Path points handed out at a time; query costs vary, so chunks balance out
+constexpr size_t QUERY_CHUNK = 256;
+
+// Penetration of the mesh into the tool placed at a path point
+static float toolPenetration(const FacetBVH& bvh, const PathPoint& point, const ToolModel& tool) {
+    float length = std::sqrt(point.nx * point.nx + point.ny * point.ny + point.nz * point.nz);
+    if (length < 1.0e-6f) {
+        return 0.0f;  // No tool axis to check along
+    }
+    float axis[3] = {point.nx / length, point.ny / length, point.nz / length};
+
+    // Capsule axis from the tip sphere center to the end of the shank
+    float tip[3], top[3];
+    float position[3] = {point.x, point.y, point.z};
+    for (int k = 0; k < 3; ++k) {
+        tip[k] = position[k] + axis[k] * tool.radius;
+        top[k] = tip[k] + axis[k] * tool.length;
+    }
+
+    float distance = bvh.segmentDistance(tip, top, tool.radius);
+    return tool.radius - distance;
+}
+
+std::vector<GougeResult> checkGouging(const FacetBVH& bvh, const std::vector<PathPoint>& path,
+                                      const ToolModel& tool, unsigned numThreads) {
+    std::vector<GougeResult> results(path.size());
+
+    parallelFor(path.size(), numThreads, [&](size_t i) {
+        float penetration = toolPenetration(bvh, path[i], tool);
+        results[i].gouging = penetration > tool.tolerance;
+        results[i].penetration = std::max(0.0f, penetration);
+    }, QUERY_CHUNK);
+
+    return results;
+}
+
+size_t correctGouging(const FacetBVH& bvh, std::vector<PathPoint>& path, const ToolModel& tool,
+                      int maxIterations, unsigned numThreads) {
+    std::vector<size_t> pending(path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        pending[i] = i;
+    }
+
+    for (int iteration = 0; iteration <= maxIterations && !pending.empty(); ++iteration) {
+        std::vector<float> penetration(pending.size());
+        parallelFor(pending.size(), numThreads, [&](size_t i) {
+            penetration[i] = toolPenetration(bvh, path[pending[i]], tool);
+        }, QUERY_CHUNK);
+
+        std::vector<size_t> stillGouging;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (penetration[i] <= tool.tolerance) {
+                continue;
+            }
+            stillGouging.push_back(pending[i]);
+
+            // Retract along the tool axis by the penetration (the last pass only counts)
+            if (iteration < maxIterations) {
+                PathPoint& p = path[pending[i]];
+                float length = std::sqrt(p.nx * p.nx + p.ny * p.ny + p.nz * p.nz);
+                float step = penetration[i] + tool.tolerance;
+                p.x += p.nx / length * step;
+                p.y += p.ny / length * step;
+                p.z += p.nz / length * step;
+            }
+        }
+        pending.swap(stillGouging);
+    }
+
+    return pending.size();
+}
@@ -0,0 +1,31 @@
+#ifndef GOUGECHECK_H
+#define GOUGECHECK_H
+
+#include <vector>
+#include "facetbvh.h"
+#include "pathplanner.h"
+
+// Ball-end tool modelled as a capsule along the point normal. The tip sphere
+// touches the surface at the path point and the shank extends away from it.
+struct ToolModel {
+    float radius;      // Tip and shank radius
+    float length;      // Shank length above the tip sphere center
+    float tolerance;   // Penetration below this is not reported
+};
+
+struct GougeResult {
+    bool gouging;
+    float penetration;  // How far the mesh reaches into the tool (0 if clear)
+};
+
+// Check every path point against the mesh, split over numThreads worker
+// threads (0 = hardware concurrency)
+std::vector<GougeResult> checkGouging(const FacetBVH& bvh, const std::vector<PathPoint>& path,
+                                      const ToolModel& tool, unsigned numThreads = 0);
+
+// Retract gouging points along their normal until the tool is clear, re-checking
+// up to maxIterations times. Returns the number of points still gouging.
+size_t correctGouging(const FacetBVH& bvh, std::vector<PathPoint>& path, const ToolModel& tool,
+                      int maxIterations = 4, unsigned numThreads = 0);
+
+#endif // GOUGECHECK_H
@@ -0,0 +1,567 @@
+#include "meshdecimator.h"
+#include "facetbvh.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+// Weight of the planes that hold open boundary edges in place
+constexpr double BOUNDARY_WEIGHT = 100.0;
+
+// Smallest determinant (relative to the quadric's scale) for which the
+// optimal collapse position is solved for instead of picking a candidate
+constexpr double SINGULAR_EPSILON = 1.0e-10;
+
+// Symmetric 4x4 error quadric of the squared distances to a set of planes
+struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+    static Quadric zero() {
+        return Quadric{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    }
+
+    // Plane a*x + b*y + c*z + d = 0 with unit normal
+    static Quadric plane(double a, double b, double c, double d, double weight) {
+        return Quadric{weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+                       weight * b * b, weight * b * c, weight * b * d,
+                       weight * c * c, weight * c * d, weight * d * d};
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd; d2 += q.d2;
+        return *this;
+    }
+
+    double evaluate(const double p[3]) const {
+        double x = p[0], y = p[1], z = p[2];
+        return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+             + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+             + c2 * z * z + 2.0 * cd * z + d2;
+    }
+
+    // Point of minimal error, if the quadric is not singular
+    bool minimize(double out[3]) const {
+        double det = a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+        double scale = std::max({a2, b2, c2});
+        if (std::abs(det) <= SINGULAR_EPSILON * scale * scale * scale) {
+            return false;
+        }
+        // Cramer's rule for A * p = -(ad, bd, cd)
+        double rx = -ad, ry = -bd, rz = -cd;
+        out[0] = (rx * (b2 * c2 - bc * bc) - ab * (ry * c2 - bc * rz) + ac * (ry * bc - b2 * rz)) / det;
+        out[1] = (a2 * (ry * c2 - bc * rz) - rx * (ab * c2 - bc * ac) + ac * (ab * rz - ry * ac)) / det;
+        out[2] = (a2 * (b2 * rz - ry * bc) - ab * (ab * rz - ry * ac) + rx * (ab * bc - b2 * ac)) / det;
+        return true;
+    }
+};
+
+// Queued edge collapse; stale once either vertex has changed since
+struct Collapse {
+    double cost;
+    uint32_t v0, v1;
+    uint32_t version0, version1;
+    double target[3];
+
+    bool operator<(const Collapse& other) const {
+        return cost > other.cost;  // Cheapest on top of the queue
+    }
+};
+
+static void cross3(const double a[3], const double b[3], double out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static double dot3(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Unnormalized normal of triangle abc
+static void triangleNormal(const double a[3], const double b[3], const double c[3], double out[3]) {
+    double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    cross3(e1, e2, out);
+}
+
+// Working state of one decimation run
+class EdgeCollapser {
+public:
+    explicit EdgeCollapser(const IndexedMesh& mesh);
+
+    void run(size_t targetTriangles);
+    IndexedMesh result() const;
+
+private:
+    void position(uint32_t v, double out[3]) const;
+    void collectNeighbors(uint32_t v, std::vector<uint32_t>& out) const;
+    size_t countEdgeTriangles(uint32_t v0, uint32_t v1) const;
+    bool isBoundaryVertex(uint32_t v) const;
+    bool flipsTriangle(uint32_t moved, uint32_t other, const double target[3]) const;
+    void pushCollapse(uint32_t v0, uint32_t v1);
+    bool isValid(const Collapse& collapse) const;
+    void apply(const Collapse& collapse);
+
+    std::vector<double> positions_;
+    std::vector<uint32_t> triangles_;
+    std::vector<bool> triangleAlive_;
+    std::vector<std::vector<uint32_t>> vertexTriangles_;
+    std::vector<Quadric> quadrics_;
+    std::vector<uint32_t> versions_;
+    std::priority_queue<Collapse> queue_;
+    size_t liveTriangles_;
+
+    mutable std::vector<uint32_t> scratch0_, scratch1_;
+};
+
+EdgeCollapser::EdgeCollapser(const IndexedMesh& mesh)
+    : positions_(mesh.positions.begin(), mesh.positions.end()),
+      triangles_(mesh.triangles),
+      triangleAlive_(mesh.getTriangleCount(), true),
+      vertexTriangles_(mesh.getVertexCount()),
+      quadrics_(mesh.getVertexCount(), Quadric::zero()),
+      versions_(mesh.getVertexCount(), 0),
+      liveTriangles_(mesh.getTriangleCount()) {
+    size_t numTriangles = mesh.getTriangleCount();
+    for (size_t t = 0; t < numTriangles; ++t) {
+        for (int i = 0; i < 3; ++i) {
+            vertexTriangles_[triangles_[3 * t + i]].push_back(static_cast<uint32_t>(t));
+        }
+    }
+
+    // Plane quadric of every triangle, weighted by its area
+    std::unordered_map<uint64_t, int> edgeUse;
+    edgeUse.reserve(numTriangles * 3);
+    auto edgeKey = [](uint32_t a, uint32_t b) {
+        return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+    };
+    for (size_t t = 0; t < numTriangles; ++t) {
+        const uint32_t* v = &triangles_[3 * t];
+        double p[3][3];
+        for (int i = 0; i < 3; ++i) {
+            position(v[i], p[i]);
+            edgeUse[edgeKey(v[i], v[(i + 1) % 3])]++;
+        }
+        double n[3];
+        triangleNormal(p[0], p[1], p[2], n);
+        double length = std::sqrt(dot3(n, n));
+        if (length <= 0.0) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            n[k] /= length;
+        }
+        Quadric q = Quadric::plane(n[0], n[1], n[2], -dot3(n, p[0]), 0.5 * length);
+        for (int i = 0; i < 3; ++i) {
+            quadrics_[v[i]] += q;
+        }
+    }
+
+    // Boundary edges get a plane through the edge, perpendicular to its
+    // triangle, so collapses do not pull the boundary inwards
+    for (size_t t = 0; t < numTriangles; ++t) {
+        const uint32_t* v = &triangles_[3 * t];
+        double p[3][3];
+        for (int i = 0; i < 3; ++i) {
+            position(v[i], p[i]);
+        }
+        double n[3];
+        triangleNormal(p[0], p[1], p[2], n);
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3;
+            if (edgeUse[edgeKey(v[i], v[j])] != 1) {
+                continue;
+            }
+            double edge[3] = {p[j][0] - p[i][0], p[j][1] - p[i][1], p[j][2] - p[i][2]};
+            double side[3];
+            cross3(edge, n, side);
+            double length = std::sqrt(dot3(side, side));
+            if (length <= 0.0) {
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                side[k] /= length;
+            }
+            Quadric q = Quadric::plane(side[0], side[1], side[2], -dot3(side, p[i]),
+                                       BOUNDARY_WEIGHT * dot3(edge, edge));
+            quadrics_[v[i]] += q;
+            quadrics_[v[j]] += q;
+        }
+    }
+
+    // Every edge once, from the triangle that has it running v0 -> v1 with v0 < v1
+    // (or from its only triangle on a boundary)
+    for (size_t t = 0; t < numTriangles; ++t) {
+        const uint32_t* v = &triangles_[3 * t];
+        for (int i = 0; i < 3; ++i) {
+            uint32_t a = v[i];
+            uint32_t b = v[(i + 1) % 3];
+            if (a < b || edgeUse[edgeKey(a, b)] == 1) {
+                pushCollapse(a, b);
+            }
+        }
+    }
+}
+
+void EdgeCollapser::position(uint32_t v, double out[3]) const {
+    out[0] = positions_[3 * v];
+    out[1] = positions_[3 * v + 1];
+    out[2] = positions_[3 * v + 2];
+}
+
+void EdgeCollapser::collectNeighbors(uint32_t v, std::vector<uint32_t>& out) const {
+    out.clear();
+    for (uint32_t t : vertexTriangles_[v]) {
+        if (!triangleAlive_[t]) {
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (triangles_[3 * t + i] != v) {
+                out.push_back(triangles_[3 * t + i]);
+            }
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+size_t EdgeCollapser::countEdgeTriangles(uint32_t v0, uint32_t v1) const {
+    size_t count = 0;
+    for (uint32_t t : vertexTriangles_[v0]) {
+        if (!triangleAlive_[t]) {
+            continue;
+        }
+        const uint32_t* v = &triangles_[3 * t];
+        if (v[0] == v1 || v[1] == v1 || v[2] == v1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool EdgeCollapser::isBoundaryVertex(uint32_t v) const {
+    std::vector<uint32_t> neighbors;
+    collectNeighbors(v, neighbors);
+    for (uint32_t w : neighbors) {
+        if (countEdgeTriangles(v, w) == 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// True if moving vertex moved to target turns over or degenerates any of its
+// triangles that do not also contain other (those disappear in the collapse)
+bool EdgeCollapser::flipsTriangle(uint32_t moved, uint32_t other, const double target[3]) const {
+    for (uint32_t t : vertexTriangles_[moved]) {
+        if (!triangleAlive_[t]) {
+            continue;
+        }
+        const uint32_t* v = &triangles_[3 * t];
+        if (v[0] == other || v[1] == other || v[2] == other) {
+            continue;
+        }
+        double before[3][3], after[3][3];
+        for (int i = 0; i < 3; ++i) {
+            position(v[i], before[i]);
+            if (v[i] == moved) {
+                std::copy(target, target + 3, after[i]);
+            }
+            else {
+                position(v[i], after[i]);
+            }
+        }
+        double n0[3], n1[3];
+        triangleNormal(before[0], before[1], before[2], n0);
+        triangleNormal(after[0], after[1], after[2], n1);
+        if (dot3(n0, n1) <= 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EdgeCollapser::pushCollapse(uint32_t v0, uint32_t v1) {
+    Quadric q = quadrics_[v0];
+    q += quadrics_[v1];
+
+    Collapse collapse;
+    collapse.v0 = v0;
+    collapse.v1 = v1;
+    collapse.version0 = versions_[v0];
+    collapse.version1 = versions_[v1];
+
+    double p0[3], p1[3];
+    position(v0, p0);
+    position(v1, p1);
+    if (q.minimize(collapse.target)) {
+        collapse.cost = q.evaluate(collapse.target);
+    }
+    else {
+        // Best of the two ends and the midpoint
+        double mid[3] = {(p0[0] + p1[0]) * 0.5, (p0[1] + p1[1]) * 0.5, (p0[2] + p1[2]) * 0.5};
+        const double* candidates[3] = {p0, p1, mid};
+        collapse.cost = std::numeric_limits<double>::max();
+        for (const double* candidate : candidates) {
+            double cost = q.evaluate(candidate);
+            if (cost < collapse.cost) {
+                collapse.cost = cost;
+                std::copy(candidate, candidate + 3, collapse.target);
+            }
+        }
+    }
+    collapse.cost = std::max(collapse.cost, 0.0);  // Rounding can go slightly negative
+    queue_.push(collapse);
+}
+
+bool EdgeCollapser::isValid(const Collapse& collapse) const {
+    uint32_t v0 = collapse.v0;
+    uint32_t v1 = collapse.v1;
+    if (collapse.version0 != versions_[v0] || collapse.version1 != versions_[v1]) {
+        return false;
+    }
+
+    // Link condition: the ends may only share the neighbors across the
+    // edge's own triangles, otherwise the collapse pinches the surface
+    size_t edgeTriangles = countEdgeTriangles(v0, v1);
+    if (edgeTriangles == 0 || edgeTriangles > 2) {
+        return false;
+    }
+    collectNeighbors(v0, scratch0_);
+    collectNeighbors(v1, scratch1_);
+    size_t shared = 0;
+    for (uint32_t w : scratch0_) {
+        shared += std::binary_search(scratch1_.begin(), scratch1_.end(), w) ? 1 : 0;
+    }
+    if (shared != edgeTriangles) {
+        return false;
+    }
+    // A closed tetrahedron would collapse into two coincident triangles
+    if (edgeTriangles == 2 && scratch0_.size() <= 3 && scratch1_.size() <= 3) {
+        return false;
+    }
+    // Joining two boundary vertices across the interior pinches the boundary
+    if (edgeTriangles == 2 && isBoundaryVertex(v0) && isBoundaryVertex(v1)) {
+        return false;
+    }
+
+    return !flipsTriangle(v0, v1, collapse.target) && !flipsTriangle(v1, v0, collapse.target);
+}
+
+// Merge v1 into v0 at the collapse target
+void EdgeCollapser::apply(const Collapse& collapse) {
+    uint32_t v0 = collapse.v0;
+    uint32_t v1 = collapse.v1;
+
+    for (uint32_t t : vertexTriangles_[v1]) {
+        if (!triangleAlive_[t]) {
+            continue;
+        }
+        uint32_t* v = &triangles_[3 * t];
+        if (v[0] == v0 || v[1] == v0 || v[2] == v0) {
+            triangleAlive_[t] = false;
+            --liveTriangles_;
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (v[i] == v1) {
+                v[i] = v0;
+            }
+        }
+        vertexTriangles_[v0].push_back(t);
+    }
+    vertexTriangles_[v1].clear();
+    vertexTriangles_[v1].shrink_to_fit();
+
+    auto& triangles = vertexTriangles_[v0];
+    triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+                                   [this](uint32_t t) { return !triangleAlive_[t]; }),
+                    triangles.end());
+
+    for (int k = 0; k < 3; ++k) {
+        positions_[3 * v0 + k] = collapse.target[k];
+    }
+    quadrics_[v0] += quadrics_[v1];
+    ++versions_[v0];
+    ++versions_[v1];
+
+    // Edges around the merged vertex have new costs
+    std::vector<uint32_t> neighbors;
+    collectNeighbors(v0, neighbors);
+    for (uint32_t w : neighbors) {
+        pushCollapse(v0, w);
+    }
+}
+
+void EdgeCollapser::run(size_t targetTriangles) {
+    while (liveTriangles_ > targetTriangles && !queue_.empty()) {
+        Collapse collapse = queue_.top();
+        queue_.pop();
+        if (isValid(collapse)) {
+            apply(collapse);
+        }
+    }
+}
+
+IndexedMesh EdgeCollapser::result() const {
+    IndexedMesh mesh;
+    std::vector<uint32_t> newIndex(versions_.size(), UINT32_MAX);
+    for (size_t t = 0; t < triangleAlive_.size(); ++t) {
+        if (!triangleAlive_[t]) {
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            uint32_t v = triangles_[3 * t + i];
+            if (newIndex[v] == UINT32_MAX) {
+                newIndex[v] = static_cast<uint32_t>(mesh.getVertexCount());
+                for (int k = 0; k < 3; ++k) {
+                    mesh.positions.push_back(static_cast<float>(positions_[3 * v + k]));
+                }
+            }
+            mesh.triangles.push_back(newIndex[v]);
+        }
+    }
+    return mesh;
+}
+
+IndexedMesh indexFacets(const std::vector<Facet>& facets) {
+    IndexedMesh mesh;
+    mesh.triangles.reserve(facets.size() * 3);
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+    buckets.reserve(facets.size());
+    auto weld = [&](const float p[3]) {
+        float q[3] = {p[0] + 0.0f, p[1] + 0.0f, p[2] + 0.0f};  // Fold -0.0 into 0.0
+        uint32_t bits[3];
+        std::memcpy(bits, q, sizeof(bits));
+        uint64_t hash = (static_cast<uint64_t>(bits[0]) * 73856093u) ^
+                        (static_cast<uint64_t>(bits[1]) * 19349663u) ^
+                        (static_cast<uint64_t>(bits[2]) * 83492791u);
+        auto& bucket = buckets[hash];
+        for (uint32_t index : bucket) {
+            if (std::memcmp(&mesh.positions[3 * index], q, sizeof(q)) == 0) {
+                return index;
+            }
+        }
+        uint32_t index = static_cast<uint32_t>(mesh.getVertexCount());
+        mesh.positions.insert(mesh.positions.end(), q, q + 3);
+        bucket.push_back(index);
+        return index;
+    };
+
+    for (const auto& facet : facets) {
+        uint32_t v[3];
+        for (int i = 0; i < 3; ++i) {
+            v[i] = weld(facet.vertices[i]);
+        }
+        if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0]) {
+            continue;  // Degenerate facet
+        }
+        mesh.triangles.insert(mesh.triangles.end(), v, v + 3);
+    }
+    return mesh;
+}
+
+std::vector<Facet> meshToFacets(const IndexedMesh& mesh) {
+    std::vector<Facet> facets(mesh.getTriangleCount());
+    for (size_t t = 0; t < facets.size(); ++t) {
+        Facet& facet = facets[t];
+        for (int i = 0; i < 3; ++i) {
+            const float* p = &mesh.positions[3 * mesh.triangles[3 * t + i]];
+            std::copy(p, p + 3, facet.vertices[i]);
+        }
+        float e1[3], e2[3];
+        for (int k = 0; k < 3; ++k) {
+            e1[k] = facet.vertices[1][k] - facet.vertices[0][k];
+            e2[k] = facet.vertices[2][k] - facet.vertices[0][k];
+        }
+        float n[3] = {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0]
+        };
+        float length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        for (int k = 0; k < 3; ++k) {
+            facet.normal[k] = (length > 0.0f) ? n[k] / length : 0.0f;
+        }
+    }
+    return facets;
+}
+
+IndexedMesh decimateMesh(const IndexedMesh& mesh, size_t targetTriangles) {
+    TRACE_SCOPE("decimateMesh");
+    if (mesh.getTriangleCount() <= targetTriangles) {
+        return mesh;
+    }
+    EdgeCollapser collapser(mesh);
+    collapser.run(targetTriangles);
+    return collapser.result();
+}
+
+std::vector<std::vector<Facet>> buildLevelsOfDetail(const std::vector<Facet>& facets, size_t maxLevels,
+                                                    float reduction, size_t minFacets) {
+    TRACE_SCOPE("buildLevelsOfDetail");
+    std::vector<std::vector<Facet>> levels;
+    if (maxLevels == 0) {
+        return levels;
+    }
+    levels.push_back(facets);
+
+    IndexedMesh mesh = indexFacets(facets);
+    while (levels.size() < maxLevels) {
+        size_t previous = mesh.getTriangleCount();
+        size_t target = static_cast<size_t>(previous * reduction);
+        if (target < minFacets) {
+            break;
+        }
+        mesh = decimateMesh(mesh, target);
+        if (mesh.getTriangleCount() >= previous) {
+            break;  // No collapse left that keeps the surface valid
+        }
+        levels.push_back(meshToFacets(mesh));
+    }
+    return levels;
+}
+
+size_t selectLevelOfDetail(float viewDistance, float modelSize, size_t levelCount) {
+    if (levelCount <= 1 || modelSize <= 0.0f) {
+        return 0;
+    }
+    float ratio = viewDistance / (2.0f * modelSize);
+    if (ratio <= 1.0f) {
+        return 0;
+    }
+    size_t level = static_cast<size_t>(std::ceil(std::log2(ratio)));
+    return std::min(level, levelCount - 1);
+}
+
+// Largest distance from the samples of one mesh to the surface of the other
+static float directedHausdorff(const std::vector<Facet>& from, const FacetBVH& to, float maxDistance) {
+    float worst = 0.0f;
+    for (const auto& facet : from) {
+        float centroid[3];
+        for (int k = 0; k < 3; ++k) {
+            centroid[k] = (facet.vertices[0][k] + facet.vertices[1][k] + facet.vertices[2][k]) / 3.0f;
+        }
+        worst = std::max(worst, to.pointDistance(centroid, maxDistance));
+        for (int i = 0; i < 3; ++i) {
+            worst = std::max(worst, to.pointDistance(facet.vertices[i], maxDistance));
+        }
+    }
+    return worst;
+}
+
+float hausdorffDistance(const std::vector<Facet>& a, const std::vector<Facet>& b) {
+    if (a.empty() || b.empty()) {
+        return std::numeric_limits<float>::infinity();
+    }
+    FacetBVH bvhA(a);
+    FacetBVH bvhB(b);
+    float maxDistance = std::numeric_limits<float>::max();
+    return std::max(directedHausdorff(a, bvhB, maxDistance), directedHausdorff(b, bvhA, maxDistance));
+}
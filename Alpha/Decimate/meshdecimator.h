@@ -0,0 +1,43 @@
+#ifndef MESHDECIMATOR_H
+#define MESHDECIMATOR_H
+
+#include <vector>
+#include <cstdint>
+#include "stlfileloader.h"
+
+// Triangle mesh with shared vertices
+struct IndexedMesh {
+    std::vector<float> positions;     // 3 floats per vertex
+    std::vector<uint32_t> triangles;  // 3 vertex indices per triangle, counter-clockwise
+
+    size_t getVertexCount() const { return positions.size() / 3; }
+    size_t getTriangleCount() const { return triangles.size() / 3; }
+};
+
+// Weld facet corners with bit-identical positions into shared vertices
+IndexedMesh indexFacets(const std::vector<Facet>& facets);
+
+// Facets of an indexed mesh with flat normals from the triangle winding
+std::vector<Facet> meshToFacets(const IndexedMesh& mesh);
+
+// Quadric error edge collapse (Garland and Heckbert). Edges are collapsed
+// cheapest first from a priority queue until at most targetTriangles remain
+// or no collapse is left that keeps the surface manifold without flipping
+// a triangle. Open boundaries are held in place by penalty quadrics.
+IndexedMesh decimateMesh(const IndexedMesh& mesh, size_t targetTriangles);
+
+// Levels of detail: level 0 is the input unchanged, each further level has
+// about reduction times the facets of the one before and is decimated from
+// it. Stops early once a level would fall below minFacets.
+std::vector<std::vector<Facet>> buildLevelsOfDetail(const std::vector<Facet>& facets, size_t maxLevels = 4,
+                                                    float reduction = 0.25f, size_t minFacets = 256);
+
+// Level to display at viewDistance from a model of the given size: the full
+// mesh up to twice the model size, one level coarser per doubling beyond that
+size_t selectLevelOfDetail(float viewDistance, float modelSize, size_t levelCount);
+
+// Symmetric Hausdorff distance between two meshes, sampled at the vertices
+// and facet centroids of each mesh against the surface of the other
+float hausdorffDistance(const std::vector<Facet>& a, const std::vector<Facet>& b);
+
+#endif // MESHDECIMATOR_H
@@ -0,0 +1,138 @@
+#include "memstats.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+
+// Replacement global operator new/delete that report every block to
+// memstats. Each block carries a 16-byte header in front of the returned
+// pointer holding its size and whether it was counted, so blocks allocated
+// while accounting was off are not counted when freed. Over-aligned blocks
+// keep their malloc pointer in the word before the header.
+
+extern std::atomic<bool> memoryHooksLinked;
+
+namespace {
+
+struct BlockHeader {
+    size_t size;
+    size_t counted;
+};
+constexpr size_t HEADER_SIZE = sizeof(BlockHeader);
+static_assert(HEADER_SIZE == 16, "header keeps blocks 16-byte aligned");
+
+struct HookInstaller {
+    HookInstaller() { memoryHooksLinked.store(true); }
+};
+HookInstaller installer;
+
+void* allocateBlock(size_t size) {
+    void* raw = std::malloc(size + HEADER_SIZE);
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    BlockHeader* header = static_cast<BlockHeader*>(raw);
+    header->size = size;
+    header->counted = recordAllocation(size);
+    return static_cast<char*>(raw) + HEADER_SIZE;
+}
+
+void freeBlock(void* p) {
+    if (p == nullptr) {
+        return;
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - HEADER_SIZE);
+    if (header->counted) {
+        recordDeallocation(header->size);
+    }
+    std::free(header);
+}
+
+void* allocateAlignedBlock(size_t size, size_t alignment) {
+    void* raw = std::malloc(size + alignment + HEADER_SIZE + sizeof(void*));
+    if (raw == nullptr) {
+        return nullptr;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw) + HEADER_SIZE + sizeof(void*);
+    uintptr_t aligned = (start + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(aligned - HEADER_SIZE);
+    header->size = size;
+    header->counted = recordAllocation(size);
+    reinterpret_cast<void**>(header)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void freeAlignedBlock(void* p) {
+    if (p == nullptr) {
+        return;
+    }
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - HEADER_SIZE);
+    if (header->counted) {
+        recordDeallocation(header->size);
+    }
+    std::free(reinterpret_cast<void**>(header)[-1]);
+}
+
+// Like the standard operator new, retry through the new handler until it
+// frees memory or gives up
+void* allocateOrThrow(size_t size) {
+    for (;;) {
+        void* p = allocateBlock(size);
+        if (p != nullptr) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* allocateAlignedOrThrow(size_t size, size_t alignment) {
+    for (;;) {
+        void* p = allocateAlignedBlock(size, alignment);
+        if (p != nullptr) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateBlock(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateBlock(size); }
+
+void operator delete(void* p) noexcept { freeBlock(p); }
+void operator delete[](void* p) noexcept { freeBlock(p); }
+void operator delete(void* p, size_t) noexcept { freeBlock(p); }
+void operator delete[](void* p, size_t) noexcept { freeBlock(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { freeBlock(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { freeBlock(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocateAlignedOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocateAlignedOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAlignedBlock(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateAlignedBlock(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { freeAlignedBlock(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { freeAlignedBlock(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { freeAlignedBlock(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { freeAlignedBlock(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAlignedBlock(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { freeAlignedBlock(p); }
@@ -0,0 +1,219 @@
+#include "memstats.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <map>
+#include <mutex>
+
+// Hook counters are plain atomics so recording never allocates or locks
+static std::atomic<bool> accountingEnabled(false);
+static std::atomic<size_t> liveBytes(0);
+static std::atomic<size_t> peakBytes(0);
+static std::atomic<size_t> allocationCount(0);
+static std::atomic<size_t> deallocationCount(0);
+static std::atomic<size_t> allocatedBytes(0);
+
+// Set by the memhooks object library when it is linked in
+std::atomic<bool> memoryHooksLinked(false);
+
+static std::mutex statsMutex;
+static std::vector<MemoryStageStats> stages;
+
+struct TallyEntry {
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+    size_t instances = 0;
+};
+static std::map<std::string, TallyEntry> tallies;
+
+void setMemoryAccountingEnabled(bool enabled) {
+    accountingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isMemoryAccountingEnabled() {
+    return accountingEnabled.load(std::memory_order_relaxed);
+}
+
+bool memoryHooksInstalled() {
+    return memoryHooksLinked.load(std::memory_order_relaxed);
+}
+
+static void raisePeak(size_t live) {
+    size_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+bool recordAllocation(size_t bytes) {
+    if (!accountingEnabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    size_t live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    raisePeak(live);
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return true;
+}
+
+void recordDeallocation(size_t bytes) {
+    // Only counted blocks get here, and like tallies they are given back even
+    // if accounting was switched off in between
+    liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    deallocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+MemoryCounters getMemoryCounters() {
+    return {
+        liveBytes.load(std::memory_order_relaxed),
+        peakBytes.load(std::memory_order_relaxed),
+        allocationCount.load(std::memory_order_relaxed),
+        deallocationCount.load(std::memory_order_relaxed),
+        allocatedBytes.load(std::memory_order_relaxed)
+    };
+}
+
+void resetMemoryPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+MemoryStage::MemoryStage(const char* name) : name_(name), active_(isMemoryAccountingEnabled()) {
+    if (active_) {
+        // Measure this stage's own peak, and fold it into the outer one at the end
+        outerPeak_ = peakBytes.load(std::memory_order_relaxed);
+        resetMemoryPeak();
+        start_ = getMemoryCounters();
+    }
+}
+
+MemoryStage::~MemoryStage() {
+    if (!active_) {
+        return;
+    }
+    MemoryCounters end = getMemoryCounters();
+    MemoryStageStats stats = {
+        name_,
+        end.allocations - start_.allocations,
+        end.allocatedBytes - start_.allocatedBytes,
+        static_cast<int64_t>(end.liveBytes) - static_cast<int64_t>(start_.liveBytes),
+        end.peakBytes
+    };
+    raisePeak(outerPeak_);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stages.push_back(stats);
+}
+
+std::vector<MemoryStageStats> getMemoryStages() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stages;
+}
+
+// Move a tally by a signed amount
+static void adjustTally(const char* name, size_t removeBytes, size_t addBytes) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    TallyEntry& entry = tallies[name];
+    if (removeBytes > 0) {
+        entry.liveBytes -= removeBytes;
+        entry.instances--;
+    }
+    if (addBytes > 0) {
+        entry.liveBytes += addBytes;
+        entry.instances++;
+        entry.peakBytes = std::max(entry.peakBytes, entry.liveBytes);
+    }
+}
+
+MemoryTally::MemoryTally(const MemoryTally& other) : name_(other.name_), bytes_(0) {
+    set(other.bytes_);
+}
+
+MemoryTally& MemoryTally::operator=(const MemoryTally& other) {
+    if (this != &other) {
+        set(0);
+        name_ = other.name_;
+        set(other.bytes_);
+    }
+    return *this;
+}
+
+MemoryTally::~MemoryTally() {
+    set(0);
+}
+
+void MemoryTally::set(size_t bytes) {
+    // Once recorded, bytes are always given back, even if accounting was
+    // switched off in between
+    if (bytes > 0 && !isMemoryAccountingEnabled()) {
+        bytes = 0;
+    }
+    if (bytes != bytes_) {
+        adjustTally(name_, bytes_, bytes);
+        bytes_ = bytes;
+    }
+}
+
+std::vector<MemoryTallyStats> getMemoryTallies() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    std::vector<MemoryTallyStats> result;
+    for (const auto& entry : tallies) {
+        result.push_back({entry.first, entry.second.liveBytes, entry.second.peakBytes, entry.second.instances});
+    }
+    return result;
+}
+
+void clearMemoryStats() {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stages.clear();
+        for (auto& entry : tallies) {
+            entry.second.peakBytes = entry.second.liveBytes;
+        }
+    }
+    resetMemoryPeak();
+}
+
+static double megabytes(double bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void printMemoryReport(std::ostream& out) {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    if (memoryHooksInstalled()) {
+        MemoryCounters counters = getMemoryCounters();
+        out << "Heap: " << megabytes(counters.liveBytes) << " MB live, " << megabytes(counters.peakBytes)
+            << " MB peak, " << counters.allocations << " allocations, " << counters.deallocations
+            << " frees" << std::endl;
+
+        std::vector<MemoryStageStats> stageList = getMemoryStages();
+        if (!stageList.empty()) {
+            out << std::left << std::setw(24) << "Stage" << std::right << std::setw(12) << "Allocs"
+                << std::setw(14) << "Alloc MB" << std::setw(12) << "Net MB" << std::setw(12) << "Peak MB" << std::endl;
+            for (const auto& stage : stageList) {
+                out << std::left << std::setw(24) << stage.name << std::right << std::setw(12) << stage.allocations
+                    << std::setw(14) << megabytes(static_cast<double>(stage.allocatedBytes))
+                    << std::setw(12) << megabytes(static_cast<double>(stage.netBytes))
+                    << std::setw(12) << megabytes(static_cast<double>(stage.peakBytes)) << std::endl;
+            }
+        }
+    }
+    else {
+        out << "Heap: allocation hooks not linked, tallies only" << std::endl;
+    }
+
+    std::vector<MemoryTallyStats> tallyList = getMemoryTallies();
+    if (!tallyList.empty()) {
+        out << std::left << std::setw(36) << "Container" << std::right << std::setw(10) << "Count"
+            << std::setw(12) << "Live MB" << std::setw(12) << "Peak MB" << std::endl;
+        for (const auto& tally : tallyList) {
+            out << std::left << std::setw(36) << tally.name << std::right << std::setw(10) << tally.instances
+                << std::setw(12) << megabytes(static_cast<double>(tally.liveBytes))
+                << std::setw(12) << megabytes(static_cast<double>(tally.peakBytes)) << std::endl;
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
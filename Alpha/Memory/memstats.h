@@ -0,0 +1,104 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Opt-in memory accounting.
+//
+// Two sources feed it while enabled:
+//  - allocation hooks: executables that link the memhooks object library
+//    count every operator new/delete (live bytes, peak, allocation counts)
+//  - tallies: MemoryTally members of the large containers (loaded facets,
+//    the facet copies in the slicer and planner) report their bytes by name
+//
+// Counters are process-wide; stages are meant to bracket the steps of one
+// pipeline run, not work running concurrently on other threads.
+
+void setMemoryAccountingEnabled(bool enabled);
+bool isMemoryAccountingEnabled();
+
+// True if the allocation hooks are linked into this executable
+bool memoryHooksInstalled();
+
+struct MemoryCounters {
+    size_t liveBytes;        // Currently allocated through operator new
+    size_t peakBytes;        // Highest liveBytes since the last resetMemoryPeak
+    size_t allocations;      // Number of operator new calls
+    size_t deallocations;    // Number of counted blocks freed
+    size_t allocatedBytes;   // Total bytes requested
+};
+
+MemoryCounters getMemoryCounters();
+
+// Start a new peak measurement at the current live bytes
+void resetMemoryPeak();
+
+// Called by the hooks. recordAllocation returns whether the block was
+// counted; only counted blocks are passed to recordDeallocation when freed.
+bool recordAllocation(size_t bytes);
+void recordDeallocation(size_t bytes);
+
+// Allocation statistics of one finished stage
+struct MemoryStageStats {
+    std::string name;
+    size_t allocations;
+    size_t allocatedBytes;
+    int64_t netBytes;     // Live bytes at the end minus at the start
+    size_t peakBytes;     // Highest live bytes during the stage
+};
+
+// Measures the allocations of the enclosing scope and adds them to the stage list
+class MemoryStage {
+public:
+    explicit MemoryStage(const char* name);
+    ~MemoryStage();
+
+    MemoryStage(const MemoryStage&) = delete;
+    MemoryStage& operator=(const MemoryStage&) = delete;
+
+private:
+    const char* name_;
+    MemoryCounters start_;
+    size_t outerPeak_;
+    bool active_;
+};
+
+std::vector<MemoryStageStats> getMemoryStages();
+
+// Named byte count of a container, e.g. a member vector. Copies count again,
+// destruction gives the bytes back. Nothing is recorded while accounting is
+// disabled.
+class MemoryTally {
+public:
+    explicit MemoryTally(const char* name) : name_(name), bytes_(0) {}
+    MemoryTally(const MemoryTally& other);
+    MemoryTally& operator=(const MemoryTally& other);
+    ~MemoryTally();
+
+    void set(size_t bytes);
+
+private:
+    const char* name_;
+    size_t bytes_;
+};
+
+struct MemoryTallyStats {
+    std::string name;
+    size_t liveBytes;
+    size_t peakBytes;
+    size_t instances;   // Live tallies with this name
+};
+
+std::vector<MemoryTallyStats> getMemoryTallies();
+
+// Drop the recorded stages and tallies' peaks and reset the peak counter
+void clearMemoryStats();
+
+// Print the counters, stages and tallies as tables
+void printMemoryReport(std::ostream& out);
+
+#endif // MEMSTATS_H
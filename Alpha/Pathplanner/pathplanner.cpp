@@ -1,16 +1,18 @@
 #include "pathplanner.h"
-#include <numeric>
+#include "rasterfill.h"
+#include "slicecontours.h"
+#include "trace.h"
 #include <algorithm>
 #include <cmath>
 #include <set>
 #include <map>
 
-// Small epsilon for floating point comparisons
-constexpr float EPSILON = 1.0e-6f;
-
 // Structure to represent a 2D point (for slice contours)
+template <typename Scalar>
 struct Point2D {
-    float x, y;  // Now representing X and Y coordinates in vertical slice plane
+    static constexpr Scalar EPSILON = GeometryTraits<Scalar>::epsilon;
+
+    Scalar x, y;  // Now representing X and Y coordinates in vertical slice plane
     
     bool operator==(const Point2D& other) const {
         return std::abs(x - other.x) < EPSILON && std::abs(y - other.y) < EPSILON;
@@ -24,25 +26,30 @@ struct Point2D {
 };
 
 // Structure to represent an edge in 2D
+template <typename Scalar>
 struct Edge2D {
-    Point2D p1, p2;
+    Point2D<Scalar> p1, p2;
     
     bool operator==(const Edge2D& other) const {
         return (p1 == other.p1 && p2 == other.p2) || (p1 == other.p2 && p2 == other.p1);
     }
 };
 
-PathPlanner::PathPlanner(const std::vector<Facet>& facets) : facets_(facets) {}
+template <typename Scalar>
+PathPlannerT<Scalar>::PathPlannerT(const std::vector<FacetT<Scalar>>& facets) : facets_(facets) {
+    facetsTally_.set(facets_.capacity() * sizeof(FacetT<Scalar>));
+}
 
 // Function to calculate intersection of a line segment with the vertical slice plane
-bool calculateIntersection(const float v1[3], const float v2[3], float sliceZ, float result[3]) {
+template <typename Scalar>
+bool calculateIntersection(const Scalar v1[3], const Scalar v2[3], Scalar sliceZ, Scalar result[3]) {
     // Check if the line crosses the plane
     if ((v1[2] - sliceZ) * (v2[2] - sliceZ) >= 0) {
         return false;  // No intersection
     }
     
     // Calculate intersection parameter t where v1 + t*(v2-v1) intersects the plane
-    float t = (sliceZ - v1[2]) / (v2[2] - v1[2]);
+    Scalar t = (sliceZ - v1[2]) / (v2[2] - v1[2]);
     
     // Calculate intersection point
     result[0] = v1[0] + t * (v2[0] - v1[0]);  // X coordinate
@@ -52,13 +59,22 @@ bool calculateIntersection(const float v1[3], const float v2[3], float sliceZ, f
     return true;
 }
 
+// Contour point together with the normals of the facets it was found on
+template <typename Scalar>
+struct SlicePoint {
+    Point2D<Scalar> p;
+    Scalar normal[3];       // Sum of the contributing facet normals
+    Scalar facetNormal[3];  // Normal of the first contributing facet
+};
+
 // Function to find the centroid of a set of 2D points
-Point2D findCentroid(const std::vector<Point2D>& points) {
-    Point2D centroid = {0.0f, 0.0f};
+template <typename Scalar>
+Point2D<Scalar> findCentroid(const std::vector<SlicePoint<Scalar>>& points) {
+    Point2D<Scalar> centroid = {0.0f, 0.0f};
     
-    for (const auto& p : points) {
-        centroid.x += p.x;
-        centroid.y += p.y;
+    for (const auto& sp : points) {
+        centroid.x += sp.p.x;
+        centroid.y += sp.p.y;
     }
     
     if (!points.empty()) {
@@ -70,127 +86,195 @@ Point2D findCentroid(const std::vector<Point2D>& points) {
 }
 
 // Function to calculate angle between two points relative to a center point
-float calculateAngle(const Point2D& center, const Point2D& point) {
+template <typename Scalar>
+Scalar calculateAngle(const Point2D<Scalar>& center, const Point2D<Scalar>& point) {
     return std::atan2(point.y - center.y, point.x - center.x);
 }
 
 // Sort points in clockwise or counter-clockwise order around their centroid
-std::vector<Point2D> sortPointsRadially(const std::vector<Point2D>& points) {
+template <typename Scalar>
+std::vector<SlicePoint<Scalar>> sortPointsRadially(const std::vector<SlicePoint<Scalar>>& points) {
+    TRACE_SCOPE("sortPointsRadially");
     if (points.size() <= 2) {
         return points;  // No need to sort with 0, 1, or 2 points
     }
     
     // Find the centroid
-    Point2D centroid = findCentroid(points);
+    Point2D<Scalar> centroid = findCentroid(points);
     
     // Create a copy of points for sorting
-    std::vector<Point2D> sortedPoints = points;
+    std::vector<SlicePoint<Scalar>> sortedPoints = points;
     
     // Sort points by angle around the centroid
     std::sort(sortedPoints.begin(), sortedPoints.end(), 
-        [&centroid](const Point2D& a, const Point2D& b) {
-            return calculateAngle(centroid, a) < calculateAngle(centroid, b);
+        [&centroid](const SlicePoint<Scalar>& a, const SlicePoint<Scalar>& b) {
+            return calculateAngle(centroid, a.p) < calculateAngle(centroid, b.p);
         });
     
     return sortedPoints;
 }
 
-std::vector<PathPoint> PathPlanner::calculatePath(const std::vector<float>& slices) {
-    std::vector<PathPoint> path;
-
-    for (float z : slices) {  // Iterate over Z-axis slices
-        std::vector<Point2D> intersectionPoints;
-        std::vector<float> normalX, normalY, normalZ;  // Store normals for later averaging
-        
-        // Find all intersection points for this slice
+// Build the radially ordered contour for one slice. Each point carries the
+// normalized sum of the normals of the facets it was found on.
+template <typename Scalar>
+bool PathPlannerT<Scalar>::buildSliceContour(Scalar z, std::vector<Point>& contour) const {
+    TRACE_SCOPE("PathPlanner::buildSliceContour");
+    constexpr Scalar EPSILON = GeometryTraits<Scalar>::epsilon;
+    std::vector<SlicePoint<Scalar>> intersectionPoints;
+    
+    // Find all intersection points for this slice, merging duplicates
+    {
+        TRACE_SCOPE("PathPlanner::intersectAndDedup");
         for (const auto& facet : facets_) {
-            std::vector<float> intersections[3]; // Can have up to 2 intersection points per facet
-            int numIntersections = 0;
-            
             // Check each edge of the triangle for intersection
             for (int i = 0; i < 3; ++i) {
                 int j = (i + 1) % 3;
-                float intersection[3];
-                
-                if (calculateIntersection(facet.vertices[i], facet.vertices[j], z, intersection)) {
-                    // Store the intersection point
-                    intersections[numIntersections].resize(3);
-                    for (int k = 0; k < 3; ++k) {
-                        intersections[numIntersections][k] = intersection[k];
-                    }
-                    numIntersections++;
-                    
-                    // Also store the facet normal
-                    normalX.push_back(facet.normal[0]);
-                    normalY.push_back(facet.normal[1]);
-                    normalZ.push_back(facet.normal[2]);
+                Scalar intersection[3];
+            
+                if (!calculateIntersection(facet.vertices[i], facet.vertices[j], z, intersection)) {
+                    continue;
                 }
-            }
+
+                Point2D<Scalar> p = {intersection[0], intersection[1]}; // X and Y coordinates
             
-            // Add unique intersection points to our collection
-            for (int i = 0; i < numIntersections; ++i) {
-                Point2D p = {intersections[i][0], intersections[i][1]}; // X and Y coordinates
-                
-                // Check if this point is already in our collection (using approximate equality)
+                // Merge with an existing point (using approximate equality)
                 bool exists = false;
-                for (const auto& existing : intersectionPoints) {
-                    if (std::abs(existing.x - p.x) < EPSILON && std::abs(existing.y - p.y) < EPSILON) {
+                for (auto& existing : intersectionPoints) {
+                    if (std::abs(existing.p.x - p.x) < EPSILON && std::abs(existing.p.y - p.y) < EPSILON) {
+                        for (int k = 0; k < 3; ++k) {
+                            existing.normal[k] += facet.normal[k];
+                        }
                         exists = true;
                         break;
                     }
                 }
-                
+            
                 if (!exists) {
-                    intersectionPoints.push_back(p);
+                    SlicePoint<Scalar> sp;
+                    sp.p = p;
+                    for (int k = 0; k < 3; ++k) {
+                        sp.normal[k] = facet.normal[k];
+                        sp.facetNormal[k] = facet.normal[k];
+                    }
+                    intersectionPoints.push_back(sp);
                 }
             }
         }
-        
-        // Sort points to form a contour
-        std::vector<Point2D> contour = sortPointsRadially(intersectionPoints);
-        
-        // If we have points, create a path point for this slice
-        if (!contour.empty() && !normalX.empty()) {
-            // Average normals of all facets that intersect this slice
-            float avgNX = std::accumulate(normalX.begin(), normalX.end(), 0.0f) / normalX.size();
-            float avgNY = std::accumulate(normalY.begin(), normalY.end(), 0.0f) / normalY.size();
-            float avgNZ = std::accumulate(normalZ.begin(), normalZ.end(), 0.0f) / normalZ.size();
-            
-            // Normalize the average normal
-            float normalLength = std::sqrt(avgNX*avgNX + avgNY*avgNY + avgNZ*avgNZ);
-            if (normalLength > EPSILON) {
-                avgNX /= normalLength;
-                avgNY /= normalLength;
-                avgNZ /= normalLength;
-            }
+    }
+    TRACE_COUNTER("slicePoints", intersectionPoints.size());
 
-            // For each point in the contour, create a path point
-            for (size_t i = 0; i < contour.size(); ++i) {
-                PathPoint point;
-                point.x = contour[i].x;
-                point.y = contour[i].y;
-                point.z = z;
-                point.nx = avgNX;
-                point.ny = avgNY;
-                point.nz = avgNZ;
-                
-                path.push_back(point);
+    // Sort points to form a contour
+    std::vector<SlicePoint<Scalar>> sorted = sortPointsRadially(intersectionPoints);
+
+    contour.clear();
+    for (const auto& sp : sorted) {
+        Scalar n[3] = {sp.normal[0], sp.normal[1], sp.normal[2]};
+
+        // Normalize the summed normal; opposing facets (thin walls) cancel
+        // out, in which case the first facet's normal is used
+        Scalar normalLength = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (normalLength > EPSILON) {
+            for (int k = 0; k < 3; ++k) {
+                n[k] /= normalLength;
             }
-            
+        }
+        else {
+            for (int k = 0; k < 3; ++k) {
+                n[k] = sp.facetNormal[k];
+            }
+        }
+
+        contour.push_back({sp.p.x, sp.p.y, z, n[0], n[1], n[2]});
+    }
+    
+    return !contour.empty();
+}
+
+template <typename Scalar>
+std::vector<typename PathPlannerT<Scalar>::Point> PathPlannerT<Scalar>::calculatePath(const std::vector<Scalar>& slices) {
+    TRACE_SCOPE("PathPlanner::calculatePath");
+    std::vector<Point> path;
+
+    streamPath(slices, [&path](size_t, const std::vector<Point>& points) {
+        path.insert(path.end(), points.begin(), points.end());
+    });
+
+    return path;
+}
+
+template <typename Scalar>
+void PathPlannerT<Scalar>::streamPath(const std::vector<Scalar>& slices, const SliceCallback& onSlice) {
+    TRACE_SCOPE("PathPlanner::streamPath");
+    std::vector<Point> contour;
+
+    for (size_t i = 0; i < slices.size(); ++i) {  // Iterate over Z-axis slices
+        // If we have points, hand over the contour for this slice
+        if (buildSliceContour(slices[i], contour)) {
             // Add a point to close the loop (return to the first point)
-            if (!contour.empty()) {
-                PathPoint closingPoint;
-                closingPoint.x = contour[0].x;
-                closingPoint.y = contour[0].y;
-                closingPoint.z = z;
-                closingPoint.nx = avgNX;
-                closingPoint.ny = avgNY;
-                closingPoint.nz = avgNZ;
-                
-                path.push_back(closingPoint);
+            contour.push_back(contour[0]);
+            onSlice(i, contour);
+        }
+    }
+}
+
+template <typename Scalar>
+std::vector<typename PathPlannerT<Scalar>::Point> PathPlannerT<Scalar>::calculateSlicePath(Scalar z) const {
+    std::vector<Point> contour;
+
+    if (buildSliceContour(z, contour)) {
+        // Add a point to close the loop (return to the first point)
+        contour.push_back(contour[0]);
+    }
+
+    return contour;
+}
+
+template <typename Scalar>
+std::vector<SliceContoursT<Scalar>> PathPlannerT<Scalar>::calculateContours(const std::vector<Scalar>& slices) {
+    TRACE_SCOPE("PathPlanner::calculateContours");
+    std::vector<SliceContoursT<Scalar>> result;
+    result.reserve(slices.size());
+
+    for (Scalar z : slices) {
+        SliceContoursT<Scalar> slice;
+        slice.z = z;
+        slice.contours = buildSliceContours(facets_, z);
+        result.push_back(slice);
+    }
+
+    return result;
+}
+
+template <typename Scalar>
+std::vector<typename PathPlannerT<Scalar>::Point> PathPlannerT<Scalar>::calculateRasterPath(const std::vector<Scalar>& slices,
+                                                                                        Scalar toolLength, RasterMode mode) {
+    TRACE_SCOPE("PathPlanner::calculateRasterPath");
+    std::vector<Point> path;
+
+    // Passes overlap by the same ratio as the slice spacing
+    Scalar stepover = toolLength * Scalar(0.75);
+    if (stepover <= GeometryTraits<Scalar>::epsilon) {
+        return path;
+    }
+
+    for (Scalar z : slices) {
+        // Fill every closed loop; holes are skipped by the even-odd rule
+        std::vector<std::vector<Point>> polygons;
+        for (auto& contour : buildSliceContours(facets_, z)) {
+            if (contour.closed) {
+                polygons.push_back(std::move(contour.points));
             }
         }
+        if (polygons.empty()) {
+            continue;
+        }
+
+        std::vector<Point> fill = generateRasterFill(polygons, z, stepover, mode);
+        path.insert(path.end(), fill.begin(), fill.end());
     }
 
     return path;
-}
\ No newline at end of file
+}
+
+template class PathPlannerT<float>;
+template class PathPlannerT<double>;
@@ -2,22 +2,100 @@
 #define PATHPLANNER_H
 
 #include <vector>
+#include <functional>
 #include "stlfileloader.h"
 
 // Structure to represent a point in the tool path
-struct PathPoint {
-    float x, y, z;        // Position
-    float nx, ny, nz;     // Normal vector
+template <typename Scalar>
+struct PathPointT {
+    Scalar x, y, z;        // Position
+    Scalar nx, ny, nz;     // Surface normal at the point
 };
 
-class PathPlanner {
+using PathPoint = PathPointT<float>;
+using PathPointD = PathPointT<double>;
+
+// Convert path points to another scalar type, e.g. a double precision plan
+// to float for the path writers
+template <typename To, typename From>
+std::vector<PathPointT<To>> convertPath(const std::vector<PathPointT<From>>& path) {
+    std::vector<PathPointT<To>> converted;
+    converted.reserve(path.size());
+    for (const auto& p : path) {
+        converted.push_back({static_cast<To>(p.x), static_cast<To>(p.y), static_cast<To>(p.z),
+                             static_cast<To>(p.nx), static_cast<To>(p.ny), static_cast<To>(p.nz)});
+    }
+    return converted;
+}
+
+// One loop of a slice cross-section. Loops of a slice form a containment
+// tree: even depth loops are outer boundaries, odd depth loops are holes.
+template <typename Scalar>
+struct ContourT {
+    std::vector<PathPointT<Scalar>> points;  // Ordered loop, first point repeated at the end when closed
+    bool closed;                    // False for chains left open by a non-watertight mesh
+    int parent;                     // Index of the enclosing contour, -1 at top level
+    int depth;                      // Nesting depth (0 = outermost boundary)
+    std::vector<int> children;      // Indices of contours directly inside this one
+
+    bool isHole() const { return depth % 2 == 1; }
+};
+
+using Contour = ContourT<float>;
+
+// All loops of one slice, ordered so that a parent always precedes its children
+template <typename Scalar>
+struct SliceContoursT {
+    Scalar z;
+    std::vector<ContourT<Scalar>> contours;
+};
+
+using SliceContours = SliceContoursT<float>;
+
+// Pass pattern used when filling the area inside a slice contour
+enum class RasterMode {
+    ZigZag,   // Alternate pass direction so passes link without a return move
+    OneWay    // Every pass runs in +X, returning to the start side in between
+};
+
+// Slices and plans in the scalar type of the mesh; instantiated for float
+// (PathPlanner) and double (PathPlannerD)
+template <typename Scalar>
+class PathPlannerT {
 public:
-    PathPlanner(const std::vector<Facet>& facets);
+    using Point = PathPointT<Scalar>;
+
+    PathPlannerT(const std::vector<FacetT<Scalar>>& facets);
     
-    std::vector<PathPoint> calculatePath(const std::vector<float>& slices);
+    std::vector<Point> calculatePath(const std::vector<Scalar>& slices);
+
+    // Closed contour of a single slice (empty if the plane misses the part).
+    // Only reads the facets, so slices can be planned concurrently.
+    std::vector<Point> calculateSlicePath(Scalar z) const;
+
+    // Same path as calculatePath, handed over one slice at a time as soon as the
+    // slice is planned, so consumers can write it out without holding the whole path.
+    // The points vector is reused between calls.
+    using SliceCallback = std::function<void(size_t sliceIndex, const std::vector<Point>& points)>;
+    void streamPath(const std::vector<Scalar>& slices, const SliceCallback& onSlice);
+
+    // Chain the slice cross-sections into separate loops with an outer/hole
+    // containment tree, so islands and holes are not merged into one path.
+    std::vector<SliceContoursT<Scalar>> calculateContours(const std::vector<Scalar>& slices);
+
+    // Cover the area inside each slice contour with raster passes.
+    // Stepover is derived from the tool length the same way as the slice spacing.
+    std::vector<Point> calculateRasterPath(const std::vector<Scalar>& slices, Scalar toolLength,
+                                           RasterMode mode = RasterMode::ZigZag);
     
 private:
-    std::vector<Facet> facets_;
+    bool buildSliceContour(Scalar z, std::vector<Point>& contour) const;
+
+    std::vector<FacetT<Scalar>> facets_;
+    MemoryTally facetsTally_{"PathPlanner facets"};
 };
 
+using PathPlanner = PathPlannerT<float>;
+using PathPlannerD = PathPlannerT<double>;
+
 #endif // PATHPLANNER_H
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "pathresampler.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Input points are split into separate coordinate arrays so the length and
+// interpolation loops run over contiguous floats and vectorize.
+struct PointArrays {
+    std::vector<float> x, y, z, nx, ny, nz;
+
+    void assign(const PathPoint* points, size_t n) {
+        x.resize(n); y.resize(n); z.resize(n);
+        nx.resize(n); ny.resize(n); nz.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = points[i].x;   y[i] = points[i].y;   z[i] = points[i].z;
+            nx[i] = points[i].nx; ny[i] = points[i].ny; nz[i] = points[i].nz;
+        }
+    }
+};
+
+// Resample points[0, n) and append the result to out
+static void resampleRange(const PathPoint* points, size_t n, const ResampleOptions& options,
+                          std::vector<PathPoint>& out) {
+    if (n < 2 || options.chordLength <= 0.0f) {
+        out.insert(out.end(), points, points + n);
+        return;
+    }
+
+    PointArrays in;
+    in.assign(points, n);
+    size_t numSegments = n - 1;
+
+    // Segment lengths
+    std::vector<float> length(numSegments);
+    const float* x = in.x.data();
+    const float* y = in.y.data();
+    const float* z = in.z.data();
+    for (size_t i = 0; i < numSegments; ++i) {
+        float dx = x[i + 1] - x[i];
+        float dy = y[i + 1] - y[i];
+        float dz = z[i + 1] - z[i];
+        length[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    // Allowed spacing at each input point. With a tolerance, the local radius is
+    // estimated from the turning angle and the spacing follows from the sagitta
+    // e = s^2 / (8 R), i.e. s = sqrt(8 R e).
+    std::vector<float> spacing(n, options.chordLength);
+    if (options.chordTolerance > 0.0f) {
+        for (size_t i = 1; i + 1 < n; ++i) {
+            float l0 = length[i - 1], l1 = length[i];
+            if (l0 <= 0.0f || l1 <= 0.0f) {
+                continue;
+            }
+            float ax = (x[i] - x[i - 1]) / l0, ay = (y[i] - y[i - 1]) / l0, az = (z[i] - z[i - 1]) / l0;
+            float bx = (x[i + 1] - x[i]) / l1, by = (y[i + 1] - y[i]) / l1, bz = (z[i + 1] - z[i]) / l1;
+            float cosAngle = std::clamp(ax * bx + ay * by + az * bz, -1.0f, 1.0f);
+            float angle = std::acos(cosAngle);
+            if (angle > 1.0e-6f) {
+                float radius = 0.5f * (l0 + l1) / angle;
+                spacing[i] = std::min(options.chordLength, std::sqrt(8.0f * radius * options.chordTolerance));
+            }
+        }
+    }
+
+    // Sample count as a function of arc length: integral of 1 / spacing,
+    // with the spacing varying linearly along each segment
+    std::vector<double> samples(n, 0.0);
+    for (size_t i = 0; i < numSegments; ++i) {
+        float density = 0.5f * (1.0f / spacing[i] + 1.0f / spacing[i + 1]);
+        samples[i + 1] = samples[i] + length[i] * density;
+    }
+
+    double total = samples.back();
+    size_t numOut = static_cast<size_t>(std::ceil(total - 1.0e-6)) + 1;
+    if (numOut < 2) {
+        numOut = 2;
+    }
+    double step = total / (numOut - 1);
+
+    // Locate each output sample on its segment (both sequences are sorted)
+    std::vector<uint32_t> segment(numOut);
+    std::vector<float> t(numOut);
+    size_t s = 0;
+    for (size_t k = 0; k < numOut; ++k) {
+        double target = (k + 1 == numOut) ? total : k * step;
+        while (s + 1 < numSegments && samples[s + 1] < target) {
+            s++;
+        }
+        double span = samples[s + 1] - samples[s];
+        segment[k] = static_cast<uint32_t>(s);
+        t[k] = (span > 0.0) ? static_cast<float>(std::clamp((target - samples[s]) / span, 0.0, 1.0)) : 0.0f;
+    }
+
+    // Interpolate positions and normals
+    size_t base = out.size();
+    out.resize(base + numOut);
+    PathPoint* result = out.data() + base;
+    const float* nx = in.nx.data();
+    const float* ny = in.ny.data();
+    const float* nz = in.nz.data();
+    for (size_t k = 0; k < numOut; ++k) {
+        uint32_t i = segment[k];
+        float u = t[k];
+        PathPoint& p = result[k];
+        p.x = x[i] + u * (x[i + 1] - x[i]);
+        p.y = y[i] + u * (y[i + 1] - y[i]);
+        p.z = z[i] + u * (z[i + 1] - z[i]);
+        p.nx = nx[i] + u * (nx[i + 1] - nx[i]);
+        p.ny = ny[i] + u * (ny[i + 1] - ny[i]);
+        p.nz = nz[i] + u * (nz[i + 1] - nz[i]);
+    }
+    for (size_t k = 0; k < numOut; ++k) {
+        PathPoint& p = result[k];
+        float normalLength = std::sqrt(p.nx * p.nx + p.ny * p.ny + p.nz * p.nz);
+        float scale = (normalLength > 1.0e-6f) ? 1.0f / normalLength : 0.0f;
+        p.nx *= scale;
+        p.ny *= scale;
+        p.nz *= scale;
+    }
+}
+
+std::vector<PathPoint> resampleContour(const std::vector<PathPoint>& contour, const ResampleOptions& options) {
+    std::vector<PathPoint> result;
+    resampleRange(contour.data(), contour.size(), options, result);
+    return result;
+}
+
+std::vector<PathPoint> resamplePath(const std::vector<PathPoint>& path, const ResampleOptions& options) {
+    TRACE_SCOPE("resamplePath");
+    std::vector<PathPoint> result;
+    result.reserve(path.size());
+
+    size_t begin = 0;
+    for (size_t i = 1; i <= path.size(); ++i) {
+        if (i == path.size() || path[i].z != path[begin].z) {
+            resampleRange(path.data() + begin, i - begin, options, result);
+            begin = i;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,21 @@
+#ifndef PATHRESAMPLER_H
+#define PATHRESAMPLER_H
+
+#include <vector>
+#include "pathplanner.h"
+
+struct ResampleOptions {
+    float chordLength;     // Longest spacing between output points
+    float chordTolerance;  // If > 0, spacing shrinks on curved stretches so the
+                           // chord deviates from the arc by at most this much
+};
+
+// Re-parameterize one polyline by arc length and emit evenly spaced points.
+// The first and last points are kept, so closed loops stay closed. Normals are
+// interpolated between the neighbouring input points and renormalized.
+std::vector<PathPoint> resampleContour(const std::vector<PathPoint>& contour, const ResampleOptions& options);
+
+// Resample every slice of a path separately (a new slice starts where z changes)
+std::vector<PathPoint> resamplePath(const std::vector<PathPoint>& path, const ResampleOptions& options);
+
+#endif // PATHRESAMPLER_H
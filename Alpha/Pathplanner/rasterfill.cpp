@@ -0,0 +1,108 @@
+#include "rasterfill.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+// Non-horizontal polygon edge stored in the sorted edge table
+template <typename Scalar>
+struct ScanEdge {
+    Scalar yMin, yMax;  // Edge covers scanlines in [yMin, yMax)
+    Scalar xAtYMin;     // X where the edge starts
+    Scalar dxdy;        // X change per unit Y
+};
+
+template <typename Scalar>
+std::vector<PathPointT<Scalar>> generateRasterFill(const std::vector<std::vector<PathPointT<Scalar>>>& polygons,
+                                                   Scalar z, Scalar stepover, RasterMode mode) {
+    TRACE_SCOPE("generateRasterFill");
+    using Point = PathPointT<Scalar>;
+    constexpr Scalar FILL_EPSILON = GeometryTraits<Scalar>::epsilon;
+    std::vector<Point> fill;
+    if (stepover <= FILL_EPSILON) {
+        return fill;
+    }
+
+    // Build the edge table from every polygon (closing each loop)
+    std::vector<ScanEdge<Scalar>> edges;
+    for (const auto& polygon : polygons) {
+        size_t n = polygon.size();
+        for (size_t i = 0; i < n; ++i) {
+            const Point& a = polygon[i];
+            const Point& b = polygon[(i + 1) % n];
+            if (std::abs(a.y - b.y) < FILL_EPSILON) {
+                continue;  // Horizontal edges never cross a scanline
+            }
+            const Point& lo = (a.y < b.y) ? a : b;
+            const Point& hi = (a.y < b.y) ? b : a;
+            edges.push_back({lo.y, hi.y, lo.x, (hi.x - lo.x) / (hi.y - lo.y)});
+        }
+    }
+    if (edges.empty()) {
+        return fill;
+    }
+
+    std::sort(edges.begin(), edges.end(),
+        [](const ScanEdge<Scalar>& a, const ScanEdge<Scalar>& b) { return a.yMin < b.yMin; });
+
+    Scalar yMin = edges.front().yMin;
+    Scalar yMax = yMin;
+    for (const auto& e : edges) {
+        yMax = std::max(yMax, e.yMax);
+    }
+
+    // Center the passes within the Y extent of the polygons
+    int numPasses = std::max(1, static_cast<int>(std::ceil((yMax - yMin) / stepover)));
+    Scalar firstY = yMin + ((yMax - yMin) - (numPasses - 1) * stepover) * 0.5f;
+
+    std::vector<const ScanEdge<Scalar>*> active;
+    std::vector<Scalar> crossings;
+    size_t nextEdge = 0;
+    bool reverse = false;
+
+    for (int pass = 0; pass < numPasses; ++pass) {
+        Scalar y = firstY + pass * stepover;
+
+        // Bring in edges that start at or below this scanline, drop finished ones
+        while (nextEdge < edges.size() && edges[nextEdge].yMin <= y) {
+            active.push_back(&edges[nextEdge]);
+            nextEdge++;
+        }
+        active.erase(std::remove_if(active.begin(), active.end(),
+            [y](const ScanEdge<Scalar>* e) { return e->yMax <= y; }), active.end());
+
+        crossings.clear();
+        for (const ScanEdge<Scalar>* e : active) {
+            crossings.push_back(e->xAtYMin + (y - e->yMin) * e->dxdy);
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // Pair up crossings into inside spans (even-odd rule)
+        size_t numSpans = crossings.size() / 2;
+        bool emitted = false;
+        for (size_t s = 0; s < numSpans; ++s) {
+            size_t span = reverse ? numSpans - 1 - s : s;
+            Scalar x0 = crossings[2 * span];
+            Scalar x1 = crossings[2 * span + 1];
+            if (x1 - x0 < FILL_EPSILON) {
+                continue;
+            }
+            if (reverse) {
+                std::swap(x0, x1);
+            }
+            fill.push_back({x0, y, z, 0.0f, 0.0f, 1.0f});
+            fill.push_back({x1, y, z, 0.0f, 0.0f, 1.0f});
+            emitted = true;
+        }
+
+        if (mode == RasterMode::ZigZag && emitted) {
+            reverse = !reverse;
+        }
+    }
+
+    return fill;
+}
+
+template std::vector<PathPointT<float>> generateRasterFill(const std::vector<std::vector<PathPointT<float>>>&,
+                                                           float, float, RasterMode);
+template std::vector<PathPointT<double>> generateRasterFill(const std::vector<std::vector<PathPointT<double>>>&,
+                                                            double, double, RasterMode);
@@ -0,0 +1,16 @@
+#ifndef RASTERFILL_H
+#define RASTERFILL_H
+
+#include <vector>
+#include "pathplanner.h"
+
+// Generate raster passes covering the area enclosed by closed polygons at height z.
+// Passes run along X and are spaced stepover apart in Y. Nested polygons are
+// treated as holes (even-odd rule), so a pass may be split into several spans.
+// Each span is emitted as a start and end point with the slice plane normal.
+// Instantiated for float and double.
+template <typename Scalar>
+std::vector<PathPointT<Scalar>> generateRasterFill(const std::vector<std::vector<PathPointT<Scalar>>>& polygons,
+                                                   Scalar z, Scalar stepover, RasterMode mode);
+
+#endif // RASTERFILL_H
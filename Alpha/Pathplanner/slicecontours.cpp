@@ -0,0 +1,346 @@
+#include "slicecontours.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+// Axis-aligned bounds of a loop in the slice plane
+template <typename Scalar>
+struct LoopBounds {
+    Scalar minX, minY, maxX, maxY;
+
+    bool contains(const LoopBounds& other) const {
+        return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+    }
+};
+
+// Key of a crossing point, built from its exact coordinates
+static uint64_t pointKey(float x, float y) {
+    // Fold -0.0 into 0.0 so both map to the same key
+    x += 0.0f;
+    y += 0.0f;
+    uint32_t bx, by;
+    std::memcpy(&bx, &x, sizeof(bx));
+    std::memcpy(&by, &y, sizeof(by));
+    return (static_cast<uint64_t>(bx) << 32) | by;
+}
+
+// Double coordinates need both 64-bit patterns
+struct DoublePointKey {
+    uint64_t x, y;
+
+    bool operator==(const DoublePointKey& other) const { return x == other.x && y == other.y; }
+};
+
+static DoublePointKey pointKey(double x, double y) {
+    x += 0.0;
+    y += 0.0;
+    DoublePointKey key;
+    std::memcpy(&key.x, &x, sizeof(key.x));
+    std::memcpy(&key.y, &y, sizeof(key.y));
+    return key;
+}
+
+struct PointKeyHash {
+    size_t operator()(uint64_t key) const { return std::hash<uint64_t>()(key); }
+    size_t operator()(const DoublePointKey& key) const {
+        return std::hash<uint64_t>()(key.x ^ (key.y * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+// Crossing of a mesh edge with the plane. The edge is always interpolated from
+// its lexicographically smaller vertex, so the two facets sharing the edge
+// produce bit-identical points that weld exactly.
+template <typename Scalar>
+static void edgeCrossing(const Scalar a[3], const Scalar b[3], Scalar z, Scalar out[2]) {
+    const Scalar* p = a;
+    const Scalar* q = b;
+    if (std::lexicographical_compare(b, b + 3, a, a + 3)) {
+        std::swap(p, q);
+    }
+    Scalar t = (z - p[2]) / (q[2] - p[2]);
+    out[0] = p[0] + t * (q[0] - p[0]);
+    out[1] = p[1] + t * (q[1] - p[1]);
+}
+
+template <typename Scalar>
+static double signedArea(const std::vector<PathPointT<Scalar>>& loop) {
+    double area = 0.0;
+    size_t n = loop.size();
+    for (size_t i = 0; i < n; ++i) {
+        const PathPointT<Scalar>& a = loop[i];
+        const PathPointT<Scalar>& b = loop[(i + 1) % n];
+        area += static_cast<double>(a.x) * b.y - static_cast<double>(b.x) * a.y;
+    }
+    return area * 0.5;
+}
+
+// Even-odd ray casting test of a point against a loop
+template <typename Scalar>
+static bool pointInLoop(Scalar x, Scalar y, const std::vector<PathPointT<Scalar>>& loop) {
+    bool inside = false;
+    size_t n = loop.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const PathPointT<Scalar>& a = loop[i];
+        const PathPointT<Scalar>& b = loop[j];
+        if ((a.y > y) != (b.y > y)) {
+            Scalar xCross = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (x < xCross) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+template <typename Scalar>
+std::vector<ContourT<Scalar>> buildSliceContours(const std::vector<FacetT<Scalar>>& facets, Scalar z) {
+    TRACE_SCOPE("buildSliceContours");
+    using PathPoint = PathPointT<Scalar>;
+    using Contour = ContourT<Scalar>;
+    using PointKey = decltype(pointKey(Scalar(), Scalar()));
+    constexpr Scalar CONTOUR_EPSILON = GeometryTraits<Scalar>::epsilon;
+    std::vector<Scalar> pointX, pointY;       // Welded crossing points
+    std::vector<Scalar> pointNormal;          // Summed facet normals per point (3 values each)
+    std::vector<Scalar> firstNormal;          // Normal of the first facet found on each point (3 values each)
+    std::vector<std::pair<int, int>> segments;
+    std::unordered_map<PointKey, int, PointKeyHash> pointIndex;
+
+    // Weld a crossing point and add the normal of the facet it was found on.
+    // A point on a shared mesh edge ends up with the sum of both facet normals.
+    auto weld = [&](const Scalar p[2], const Scalar normal[3]) {
+        auto inserted = pointIndex.emplace(pointKey(p[0], p[1]), static_cast<int>(pointX.size()));
+        if (inserted.second) {
+            pointX.push_back(p[0]);
+            pointY.push_back(p[1]);
+            pointNormal.insert(pointNormal.end(), 3, 0.0f);
+            firstNormal.insert(firstNormal.end(), normal, normal + 3);
+        }
+        int index = inserted.first->second;
+        for (int k = 0; k < 3; ++k) {
+            pointNormal[3 * index + k] += normal[k];
+        }
+        return index;
+    };
+
+    // Intersect every facet with the plane. Vertices on the plane count as
+    // above it, so a crossing facet always yields exactly two points.
+    for (const auto& facet : facets) {
+        bool above[3];
+        int numAbove = 0;
+        for (int i = 0; i < 3; ++i) {
+            above[i] = facet.vertices[i][2] >= z;
+            numAbove += above[i] ? 1 : 0;
+        }
+        if (numAbove == 0 || numAbove == 3) {
+            continue;
+        }
+
+        int ends[2];
+        int numEnds = 0;
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3;
+            if (above[i] != above[j]) {
+                Scalar crossing[2];
+                edgeCrossing(facet.vertices[i], facet.vertices[j], z, crossing);
+                ends[numEnds++] = weld(crossing, facet.normal);
+            }
+        }
+        if (ends[0] == ends[1]) {
+            continue;  // Facet only touches the plane at one point
+        }
+
+        segments.emplace_back(ends[0], ends[1]);
+    }
+
+    std::vector<Contour> contours;
+    if (segments.empty()) {
+        return contours;
+    }
+
+    // Normalize the per-point normals. Where opposing facets cancel out,
+    // keep the first facet's normal instead.
+    size_t numPoints = pointX.size();
+    for (size_t i = 0; i < numPoints; ++i) {
+        Scalar* n = &pointNormal[3 * i];
+        Scalar normalLength = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if (normalLength > CONTOUR_EPSILON) {
+            for (int k = 0; k < 3; ++k) {
+                n[k] /= normalLength;
+            }
+        }
+        else {
+            for (int k = 0; k < 3; ++k) {
+                n[k] = firstNormal[3 * i + k];
+            }
+        }
+    }
+
+    // Point to segment adjacency in compressed row form
+    std::vector<int> adjStart(numPoints + 1, 0);
+    for (const auto& seg : segments) {
+        adjStart[seg.first + 1]++;
+        adjStart[seg.second + 1]++;
+    }
+    for (size_t i = 0; i < numPoints; ++i) {
+        adjStart[i + 1] += adjStart[i];
+    }
+    std::vector<int> adjacency(adjStart.back());
+    std::vector<int> fill(adjStart.begin(), adjStart.end() - 1);
+    for (size_t s = 0; s < segments.size(); ++s) {
+        adjacency[fill[segments[s].first]++] = static_cast<int>(s);
+        adjacency[fill[segments[s].second]++] = static_cast<int>(s);
+    }
+
+    // Walk the segments into chains. Chain ends (odd degree points) go first
+    // so open chains are traced from one end to the other.
+    std::vector<bool> used(segments.size(), false);
+    std::vector<int> startOrder;
+    for (size_t i = 0; i < numPoints; ++i) {
+        if ((adjStart[i + 1] - adjStart[i]) % 2 == 1) {
+            startOrder.push_back(static_cast<int>(i));
+        }
+    }
+    for (size_t i = 0; i < numPoints; ++i) {
+        if ((adjStart[i + 1] - adjStart[i]) % 2 == 0) {
+            startOrder.push_back(static_cast<int>(i));
+        }
+    }
+
+    auto makePoint = [&](int index) {
+        const Scalar* n = &pointNormal[3 * index];
+        return PathPoint{pointX[index], pointY[index], z, n[0], n[1], n[2]};
+    };
+
+    for (int start : startOrder) {
+        while (true) {
+            int current = start;
+            Contour contour;
+            contour.parent = -1;
+            contour.depth = 0;
+            contour.points.push_back(makePoint(current));
+
+            while (true) {
+                int next = -1;
+                for (int a = adjStart[current]; a < adjStart[current + 1]; ++a) {
+                    int s = adjacency[a];
+                    if (!used[s]) {
+                        used[s] = true;
+                        next = (segments[s].first == current) ? segments[s].second : segments[s].first;
+                        break;
+                    }
+                }
+                if (next < 0) {
+                    break;
+                }
+                current = next;
+                contour.points.push_back(makePoint(current));
+                if (current == start) {
+                    break;
+                }
+            }
+
+            if (contour.points.size() < 2) {
+                break;  // No unused segment left at this start point
+            }
+            contour.closed = (current == start) && contour.points.size() > 3;
+            contours.push_back(contour);
+        }
+    }
+
+    // Bounds and area of each closed loop (without the repeated closing point)
+    size_t numContours = contours.size();
+    std::vector<LoopBounds<Scalar>> bounds(numContours);
+    std::vector<double> areas(numContours, 0.0);
+    std::vector<std::vector<PathPoint>> loops(numContours);
+    for (size_t i = 0; i < numContours; ++i) {
+        const auto& points = contours[i].points;
+        LoopBounds<Scalar> b = {points[0].x, points[0].y, points[0].x, points[0].y};
+        for (const auto& p : points) {
+            b.minX = std::min(b.minX, p.x);
+            b.minY = std::min(b.minY, p.y);
+            b.maxX = std::max(b.maxX, p.x);
+            b.maxY = std::max(b.maxY, p.y);
+        }
+        bounds[i] = b;
+        if (contours[i].closed) {
+            loops[i].assign(points.begin(), points.end() - 1);
+            areas[i] = signedArea(loops[i]);
+        }
+    }
+
+    // Insert loops from largest to smallest area, descending the tree through
+    // children whose bounds contain the new loop. Only loops that pass the
+    // bounds test are checked point-in-polygon.
+    std::vector<int> order(numContours);
+    for (size_t i = 0; i < numContours; ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return std::abs(areas[a]) > std::abs(areas[b]);
+    });
+
+    std::vector<int> roots;
+    for (int index : order) {
+        Contour& contour = contours[index];
+        if (!contour.closed) {
+            continue;
+        }
+
+        const PathPoint& probe = loops[index][0];
+        const std::vector<int>* candidates = &roots;
+        while (true) {
+            int container = -1;
+            for (int c : *candidates) {
+                if (bounds[c].contains(bounds[index]) && pointInLoop(probe.x, probe.y, loops[c])) {
+                    container = c;
+                    break;
+                }
+            }
+            if (container < 0) {
+                break;
+            }
+            contour.parent = container;
+            contour.depth = contours[container].depth + 1;
+            candidates = &contours[container].children;
+        }
+
+        if (contour.parent < 0) {
+            roots.push_back(index);
+        }
+        else {
+            contours[contour.parent].children.push_back(index);
+        }
+
+        // Outer boundaries run counter-clockwise, holes clockwise
+        bool counterClockwise = areas[index] > 0.0;
+        if (counterClockwise == contour.isHole()) {
+            std::reverse(contour.points.begin(), contour.points.end());
+        }
+    }
+
+    // Reorder so every parent precedes its children
+    std::vector<int> newIndex(numContours);
+    for (size_t i = 0; i < numContours; ++i) {
+        newIndex[order[i]] = static_cast<int>(i);
+    }
+    std::vector<Contour> sorted;
+    sorted.reserve(numContours);
+    for (int index : order) {
+        Contour contour = std::move(contours[index]);
+        if (contour.parent >= 0) {
+            contour.parent = newIndex[contour.parent];
+        }
+        for (int& child : contour.children) {
+            child = newIndex[child];
+        }
+        sorted.push_back(std::move(contour));
+    }
+
+    return sorted;
+}
+
+template std::vector<ContourT<float>> buildSliceContours(const std::vector<FacetT<float>>&, float);
+template std::vector<ContourT<double>> buildSliceContours(const std::vector<FacetT<double>>&, double);
@@ -0,0 +1,15 @@
+#ifndef SLICECONTOURS_H
+#define SLICECONTOURS_H
+
+#include <vector>
+#include "stlfileloader.h"
+#include "pathplanner.h"
+
+// Intersect the facets with the plane at height z and chain the resulting
+// segments into loops. Closed loops are oriented counter-clockwise for outer
+// boundaries and clockwise for holes, and linked into a containment tree.
+// Instantiated for float and double.
+template <typename Scalar>
+std::vector<ContourT<Scalar>> buildSliceContours(const std::vector<FacetT<Scalar>>& facets, Scalar z);
+
+#endif // SLICECONTOURS_H
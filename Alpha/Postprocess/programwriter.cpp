@@ -0,0 +1,191 @@
+#include "programwriter.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+#include <system_error>
+
+ProgramDialect gcodeDialect() {
+    ProgramDialect dialect;
+    dialect.header = "%\nG21 G90 G17\n";
+    dialect.sliceHeader = "(Slice %S)\n";
+    dialect.rapid = "G0 X%X Y%Y Z%Z\n";
+    dialect.move = "G1 X%X Y%Y Z%Z\n";
+    dialect.footer = "M30\n%\n";
+    dialect.precision = 4;
+    return dialect;
+}
+
+ProgramDialect robotDialect() {
+    ProgramDialect dialect;
+    dialect.header = "DEF TOOLPATH()\n";
+    dialect.sliceHeader = "; Slice %S\n";
+    dialect.rapid = "PTP {X %X,Y %Y,Z %Z} ; Axis %I %J %K\n";
+    dialect.move = "LIN {X %X,Y %Y,Z %Z} C_DIS ; Axis %I %J %K\n";
+    dialect.footer = "END\n";
+    dialect.precision = 3;
+    return dialect;
+}
+
+ProgramWriter::ProgramWriter(const ProgramDialect& dialect, size_t bufferSize)
+    : dialect_(dialect), buffer_(std::max<size_t>(bufferSize, 256)), used_(0), pointsWritten_(0) {
+    // Values below half of the last printed digit are written as zero
+    zeroThreshold_ = 0.5f * std::pow(10.0f, -static_cast<float>(dialect.precision));
+    header_ = parseTemplate(dialect.header);
+    sliceHeader_ = parseTemplate(dialect.sliceHeader);
+    rapid_ = parseTemplate(dialect.rapid);
+    move_ = parseTemplate(dialect.move);
+    footer_ = parseTemplate(dialect.footer);
+}
+
+ProgramWriter::~ProgramWriter() {
+    if (file_.is_open()) {
+        close();
+    }
+}
+
+std::vector<ProgramWriter::Token> ProgramWriter::parseTemplate(const std::string& pattern) {
+    std::vector<Token> tokens;
+    std::string literal;
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        char field = (c == '%' && i + 1 < pattern.size()) ? pattern[i + 1] : 0;
+        if (field == '%') {
+            literal += '%';
+            i++;
+        }
+        else if (field != 0 && std::string("XYZIJKNS").find(field) != std::string::npos) {
+            i++;
+            if (!literal.empty()) {
+                tokens.push_back({0, literal});
+                literal.clear();
+            }
+            tokens.push_back({field, ""});
+        }
+        else {
+            literal += c;
+        }
+    }
+    if (!literal.empty()) {
+        tokens.push_back({0, literal});
+    }
+
+    return tokens;
+}
+
+bool ProgramWriter::open(const std::string& filename) {
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open program file: " << filename << std::endl;
+        return false;
+    }
+
+    used_ = 0;
+    pointsWritten_ = 0;
+    writeTemplate(header_, nullptr, 0);
+    return true;
+}
+
+void ProgramWriter::writeSlice(size_t sliceIndex, const std::vector<PathPoint>& points) {
+    if (points.empty()) {
+        return;
+    }
+
+    writeTemplate(sliceHeader_, nullptr, sliceIndex);
+    writeTemplate(rapid_, &points[0], sliceIndex);
+    for (size_t i = 1; i < points.size(); ++i) {
+        writeTemplate(move_, &points[i], sliceIndex);
+    }
+}
+
+bool ProgramWriter::close() {
+    writeTemplate(footer_, nullptr, 0);
+    flush();
+    file_.close();
+    return !file_.fail();
+}
+
+void ProgramWriter::writeTemplate(const std::vector<Token>& tokens, const PathPoint* point, size_t sliceIndex) {
+    for (const auto& token : tokens) {
+        switch (token.field) {
+        case 0:   append(token.text.data(), token.text.size()); break;
+        case 'S': appendInteger(sliceIndex); break;
+        case 'N': appendInteger(pointsWritten_); break;
+        default:
+            if (point == nullptr) {
+                break;  // Position fields are only valid in move templates
+            }
+            switch (token.field) {
+            case 'X': appendNumber(point->x); break;
+            case 'Y': appendNumber(point->y); break;
+            case 'Z': appendNumber(point->z); break;
+            case 'I': appendNumber(point->nx); break;
+            case 'J': appendNumber(point->ny); break;
+            case 'K': appendNumber(point->nz); break;
+            default: break;
+            }
+        }
+    }
+
+    if (point != nullptr) {
+        pointsWritten_++;
+    }
+}
+
+void ProgramWriter::appendNumber(float value) {
+    // Make sure the longest fixed-point float fits without a partial flush:
+    // sign, 39 integer digits, the point and the fraction digits
+    size_t longest = 41 + static_cast<size_t>(std::max(dialect_.precision, 0));
+    if (buffer_.size() - used_ < longest) {
+        flush();
+        if (buffer_.size() < longest) {
+            buffer_.resize(longest);
+        }
+    }
+
+    // Avoid printing "-0.0000" for values that round to zero
+    if (std::abs(value) < zeroThreshold_) {
+        value = 0.0f;
+    }
+
+    char* begin = buffer_.data() + used_;
+    auto result = std::to_chars(begin, buffer_.data() + buffer_.size(), value,
+                                std::chars_format::fixed, dialect_.precision);
+    if (result.ec != std::errc()) {
+        // Leave the number out and let close() report the program as broken
+        file_.setstate(std::ios::failbit);
+        return;
+    }
+    used_ = result.ptr - buffer_.data();
+}
+
+void ProgramWriter::appendInteger(size_t value) {
+    if (buffer_.size() - used_ < 32) {
+        flush();
+    }
+
+    char* begin = buffer_.data() + used_;
+    auto result = std::to_chars(begin, buffer_.data() + buffer_.size(), value);
+    used_ = result.ptr - buffer_.data();
+}
+
+void ProgramWriter::append(const char* data, size_t size) {
+    if (size > buffer_.size() - used_) {
+        flush();
+        if (size > buffer_.size()) {
+            file_.write(data, size);
+            return;
+        }
+    }
+
+    std::copy(data, data + size, buffer_.data() + used_);
+    used_ += size;
+}
+
+void ProgramWriter::flush() {
+    if (used_ > 0 && file_.is_open()) {
+        file_.write(buffer_.data(), used_);
+    }
+    used_ = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef PROGRAMWRITER_H
+#define PROGRAMWRITER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "pathplanner.h"
+
+// Text layout of a machine program. Templates may use these placeholders:
+//   %X %Y %Z  point position       %I %J %K  tool axis (point normal)
+//   %N        running point number %S        slice number
+//   %%        a literal percent sign (a lone % is also kept as is)
+struct ProgramDialect {
+    std::string header;       // Written once before the first slice
+    std::string sliceHeader;  // Written before each slice
+    std::string rapid;        // Move to the first point of a slice
+    std::string move;         // Move to every following point of a slice
+    std::string footer;       // Written once when the program is closed
+    int precision;            // Digits after the decimal point
+};
+
+// ISO G-code for a 3-axis controller
+ProgramDialect gcodeDialect();
+
+// Robot program with linear moves and the tool axis carried as a comment
+ProgramDialect robotDialect();
+
+// Writes a program slice by slice through a large output buffer, so the
+// complete path never has to be held in memory.
+class ProgramWriter {
+public:
+    ProgramWriter(const ProgramDialect& dialect, size_t bufferSize = 1 << 20);
+    ~ProgramWriter();
+
+    bool open(const std::string& filename);
+    void writeSlice(size_t sliceIndex, const std::vector<PathPoint>& points);
+    bool close();
+
+    size_t getPointsWritten() const { return pointsWritten_; }
+
+private:
+    // One piece of a parsed template: literal text or a placeholder
+    struct Token {
+        char field;        // 0 for literal text, otherwise the placeholder letter
+        std::string text;
+    };
+
+    static std::vector<Token> parseTemplate(const std::string& pattern);
+    void writeTemplate(const std::vector<Token>& tokens, const PathPoint* point, size_t sliceIndex);
+    void appendNumber(float value);
+    void appendInteger(size_t value);
+    void append(const char* data, size_t size);
+    void flush();
+
+    ProgramDialect dialect_;
+    float zeroThreshold_;
+    std::vector<Token> header_, sliceHeader_, rapid_, move_, footer_;
+    std::vector<char> buffer_;
+    size_t used_;
+    size_t pointsWritten_;
+    std::ofstream file_;
+};
+
+#endif // PROGRAMWRITER_H
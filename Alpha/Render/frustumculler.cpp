@@ -0,0 +1,205 @@
+#include "frustumculler.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Relation of a box to the frustum
+enum class BoxSide { Outside, Crossing, Inside };
+
+Frustum frustumFromMatrices(const float projection[16], const float modelview[16]) {
+    // clip = projection * modelview, column-major
+    float clip[16];
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) {
+                sum += projection[k * 4 + row] * modelview[column * 4 + k];
+            }
+            clip[column * 4 + row] = sum;
+        }
+    }
+
+    // Planes from sums and differences of the rows (Gribb and Hartmann)
+    Frustum frustum;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int k = 0; k < 4; ++k) {
+            float w = clip[k * 4 + 3];
+            float v = clip[k * 4 + axis];
+            frustum.planes[2 * axis][k] = w + v;
+            frustum.planes[2 * axis + 1][k] = w - v;
+        }
+    }
+
+    for (auto& plane : frustum.planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (int k = 0; k < 4; ++k) {
+                plane[k] /= length;
+            }
+        }
+    }
+    return frustum;
+}
+
+static BoxSide classifyBox(const Frustum& frustum, const float boundsMin[3], const float boundsMax[3]) {
+    BoxSide side = BoxSide::Inside;
+    for (const auto& plane : frustum.planes) {
+        // Corners farthest along and against the plane normal
+        float far = plane[3];
+        float near = plane[3];
+        for (int k = 0; k < 3; ++k) {
+            if (plane[k] >= 0.0f) {
+                far += plane[k] * boundsMax[k];
+                near += plane[k] * boundsMin[k];
+            }
+            else {
+                far += plane[k] * boundsMin[k];
+                near += plane[k] * boundsMax[k];
+            }
+        }
+        if (far < 0.0f) {
+            return BoxSide::Outside;
+        }
+        if (near < 0.0f) {
+            side = BoxSide::Crossing;
+        }
+    }
+    return side;
+}
+
+bool boxInFrustum(const Frustum& frustum, const float boundsMin[3], const float boundsMax[3]) {
+    return classifyBox(frustum, boundsMin, boundsMax) != BoxSide::Outside;
+}
+
+static void facetCentroid(const Facet& facet, float out[3]) {
+    for (int k = 0; k < 3; ++k) {
+        out[k] = (facet.vertices[0][k] + facet.vertices[1][k] + facet.vertices[2][k]) / 3.0f;
+    }
+}
+
+FacetOctree::FacetOctree(std::vector<Facet> facets, size_t maxLeafFacets, int maxDepth)
+    : facets_(std::move(facets)) {
+    TRACE_SCOPE("FacetOctree::build");
+    if (facets_.empty()) {
+        return;
+    }
+    nodes_.push_back(Node{{0, 0, 0}, {0, 0, 0}, 0, static_cast<uint32_t>(facets_.size()), 0, 0});
+    build(0, 0, std::max<size_t>(maxLeafFacets, 1), maxDepth);
+}
+
+void FacetOctree::build(uint32_t nodeIndex, int depth, size_t maxLeafFacets, int maxDepth) {
+    auto begin = facets_.begin() + nodes_[nodeIndex].first;
+    auto end = begin + nodes_[nodeIndex].count;
+
+    // Bounds of the whole facets, and of their centroids for splitting
+    float boundsMin[3], boundsMax[3], centerMin[3], centerMax[3];
+    for (int k = 0; k < 3; ++k) {
+        boundsMin[k] = centerMin[k] = std::numeric_limits<float>::max();
+        boundsMax[k] = centerMax[k] = std::numeric_limits<float>::lowest();
+    }
+    for (auto it = begin; it != end; ++it) {
+        float centroid[3];
+        facetCentroid(*it, centroid);
+        for (int k = 0; k < 3; ++k) {
+            for (int i = 0; i < 3; ++i) {
+                boundsMin[k] = std::min(boundsMin[k], it->vertices[i][k]);
+                boundsMax[k] = std::max(boundsMax[k], it->vertices[i][k]);
+            }
+            centerMin[k] = std::min(centerMin[k], centroid[k]);
+            centerMax[k] = std::max(centerMax[k], centroid[k]);
+        }
+    }
+    std::copy(boundsMin, boundsMin + 3, nodes_[nodeIndex].boundsMin);
+    std::copy(boundsMax, boundsMax + 3, nodes_[nodeIndex].boundsMax);
+
+    if (nodes_[nodeIndex].count <= maxLeafFacets || depth >= maxDepth) {
+        return;
+    }
+
+    // Split into octants around the middle of the centroids: x, then y
+    // within each half, then z within each quarter
+    float middle[3];
+    for (int k = 0; k < 3; ++k) {
+        middle[k] = 0.5f * (centerMin[k] + centerMax[k]);
+    }
+    auto below = [&middle](int axis) {
+        return [&middle, axis](const Facet& facet) {
+            float centroid[3];
+            facetCentroid(facet, centroid);
+            return centroid[axis] < middle[axis];
+        };
+    };
+    std::vector<decltype(begin)> cuts = {begin, end};
+    for (int axis = 0; axis < 3; ++axis) {
+        std::vector<decltype(begin)> refined;
+        for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+            refined.push_back(cuts[i]);
+            refined.push_back(std::partition(cuts[i], cuts[i + 1], below(axis)));
+        }
+        refined.push_back(end);
+        cuts = refined;
+    }
+
+    // All centroids in one octant (coincident facets): keep as a leaf
+    uint32_t childCount = 0;
+    for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+        childCount += (cuts[i + 1] > cuts[i]) ? 1 : 0;
+    }
+    if (childCount < 2) {
+        return;
+    }
+
+    uint32_t firstChild = static_cast<uint32_t>(nodes_.size());
+    nodes_[nodeIndex].firstChild = firstChild;
+    nodes_[nodeIndex].childCount = childCount;
+    for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+        if (cuts[i + 1] > cuts[i]) {
+            uint32_t first = static_cast<uint32_t>(cuts[i] - facets_.begin());
+            uint32_t count = static_cast<uint32_t>(cuts[i + 1] - cuts[i]);
+            nodes_.push_back(Node{{0, 0, 0}, {0, 0, 0}, first, count, 0, 0});
+        }
+    }
+    for (uint32_t child = 0; child < childCount; ++child) {
+        build(firstChild + child, depth + 1, maxLeafFacets, maxDepth);
+    }
+}
+
+CullStats FacetOctree::cull(const Frustum& frustum, std::vector<TriangleRange>& visible) const {
+    visible.clear();
+    CullStats stats = {0, facets_.size(), 0};
+    if (nodes_.empty()) {
+        return stats;
+    }
+
+    auto emit = [&](const Node& node) {
+        stats.submittedTriangles += node.count;
+        if (!visible.empty() && visible.back().first + visible.back().count == node.first) {
+            visible.back().count += node.count;
+        }
+        else {
+            visible.push_back(TriangleRange{node.first, node.count});
+        }
+    };
+
+    // Depth first with children in order, so ranges come out sorted
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        ++stats.visitedNodes;
+
+        BoxSide side = classifyBox(frustum, node.boundsMin, node.boundsMax);
+        if (side == BoxSide::Outside) {
+            continue;
+        }
+        if (side == BoxSide::Inside || node.childCount == 0) {
+            emit(node);
+            continue;
+        }
+        for (uint32_t child = node.childCount; child > 0; --child) {
+            stack.push_back(node.firstChild + child - 1);
+        }
+    }
+    return stats;
+}
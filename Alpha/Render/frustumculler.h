@@ -0,0 +1,64 @@
+#ifndef FRUSTUMCULLER_H
+#define FRUSTUMCULLER_H
+
+#include <vector>
+#include <cstdint>
+#include "stlfileloader.h"
+
+// View frustum as six planes a*x + b*y + c*z + d >= 0 for points inside
+struct Frustum {
+    float planes[6][4];
+};
+
+// Frustum of the product projection * modelview, both column-major as
+// returned by glGetFloatv, in the coordinates the modelview is applied to
+Frustum frustumFromMatrices(const float projection[16], const float modelview[16]);
+
+// False only if the axis-aligned box lies entirely outside the frustum
+bool boxInFrustum(const Frustum& frustum, const float boundsMin[3], const float boundsMax[3]);
+
+// Run of consecutive triangles in FacetOctree::getFacets() order
+struct TriangleRange {
+    size_t first;
+    size_t count;
+};
+
+struct CullStats {
+    size_t submittedTriangles;
+    size_t totalTriangles;
+    size_t visitedNodes;
+};
+
+// Octree over mesh facets, built once at load time. Facets are reordered so
+// every node covers one contiguous range, and node bounds enclose the whole
+// facets, so culling a node never drops a visible facet. Needs no GL context.
+class FacetOctree {
+public:
+    explicit FacetOctree(std::vector<Facet> facets, size_t maxLeafFacets = 2048, int maxDepth = 8);
+
+    // Facets in octree order; upload these so the ranges index the buffer
+    const std::vector<Facet>& getFacets() const { return facets_; }
+
+    // Ranges of facets in or crossing the frustum, in increasing order with
+    // adjacent ranges merged
+    CullStats cull(const Frustum& frustum, std::vector<TriangleRange>& visible) const;
+
+    size_t getNodeCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t first;        // First facet
+        uint32_t count;        // Facets in this node and all below it
+        uint32_t firstChild;   // Children are consecutive nodes
+        uint32_t childCount;   // 0 for leaves
+    };
+
+    void build(uint32_t nodeIndex, int depth, size_t maxLeafFacets, int maxDepth);
+
+    std::vector<Facet> facets_;
+    std::vector<Node> nodes_;
+};
+
+#endif // FRUSTUMCULLER_H
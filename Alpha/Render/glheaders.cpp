@@ -0,0 +1,57 @@
+// Declare the buffer object prototypes before gl.h pulls in glext.h
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(GL_GLEXT_PROTOTYPES)
+#define GL_GLEXT_PROTOTYPES
+#endif
+
+#include "glheaders.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <GL/glext.h>
+#endif
+
+// Windows exports only OpenGL 1.1 from opengl32.dll; later functions come
+// from the driver through wglGetProcAddress and need a current context.
+// Elsewhere the library exports them directly.
+static GLBufferFunctions loadBufferFunctions() {
+    GLBufferFunctions functions = {};
+#ifdef _WIN32
+    functions.genBuffers = reinterpret_cast<decltype(functions.genBuffers)>(wglGetProcAddress("glGenBuffers"));
+    functions.deleteBuffers = reinterpret_cast<decltype(functions.deleteBuffers)>(wglGetProcAddress("glDeleteBuffers"));
+    functions.bindBuffer = reinterpret_cast<decltype(functions.bindBuffer)>(wglGetProcAddress("glBindBuffer"));
+    functions.bufferData = reinterpret_cast<decltype(functions.bufferData)>(wglGetProcAddress("glBufferData"));
+    if (!functions.genBuffers || !functions.deleteBuffers || !functions.bindBuffer || !functions.bufferData) {
+        functions = GLBufferFunctions();
+    }
+#else
+    functions.genBuffers = glGenBuffers;
+    functions.deleteBuffers = glDeleteBuffers;
+    functions.bindBuffer = glBindBuffer;
+    functions.bufferData = reinterpret_cast<decltype(functions.bufferData)>(glBufferData);
+#endif
+    return functions;
+}
+
+const GLBufferFunctions& getGLBufferFunctions() {
+    static const GLBufferFunctions functions = loadBufferFunctions();
+    return functions;
+}
+
+GLuint createStaticBuffer(GLenum target, size_t bytes, const void* data) {
+    const GLBufferFunctions& gl = getGLBufferFunctions();
+    if (gl.genBuffers == nullptr) {
+        return 0;
+    }
+
+    GLuint buffer = 0;
+    gl.genBuffers(1, &buffer);
+    gl.bindBuffer(target, buffer);
+    gl.bufferData(target, static_cast<std::ptrdiff_t>(bytes), data, GL_STATIC_DRAW);
+    gl.bindBuffer(target, 0);
+    return buffer;
+}
+
+void deleteStaticBuffer(GLuint buffer) {
+    if (buffer != 0) {
+        getGLBufferFunctions().deleteBuffers(1, &buffer);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef GLHEADERS_H
+#define GLHEADERS_H
+
+// Platform OpenGL headers plus the few OpenGL 1.5 buffer object names that
+// the Windows headers (OpenGL 1.1) do not declare
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef __APPLE__
+#ifndef GL_SILENCE_DEPRECATION
+#define GL_SILENCE_DEPRECATION
+#endif
+#include <OpenGL/gl.h>
+#include <OpenGL/glu.h>
+#else
+#include <GL/gl.h>
+#include <GL/glu.h>
+#endif
+
+#include <cstddef>
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER         0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW          0x88E4
+#endif
+
+// Vertex buffer object entry points, looked up once a context is current.
+// All pointers are null if the driver has no buffer objects.
+struct GLBufferFunctions {
+    void (APIENTRY* genBuffers)(GLsizei n, GLuint* buffers);
+    void (APIENTRY* deleteBuffers)(GLsizei n, const GLuint* buffers);
+    void (APIENTRY* bindBuffer)(GLenum target, GLuint buffer);
+    void (APIENTRY* bufferData)(GLenum target, std::ptrdiff_t size, const void* data, GLenum usage);
+};
+
+const GLBufferFunctions& getGLBufferFunctions();
+
+// Buffer object holding a copy of data, or 0 without buffer objects
+GLuint createStaticBuffer(GLenum target, size_t bytes, const void* data);
+void deleteStaticBuffer(GLuint buffer);
+
+#endif // GLHEADERS_H
@@ -0,0 +1,127 @@
+#include "meshbuffer.h"
+#include "trace.h"
+#include <cstring>
+#include <unordered_map>
+
+// Hash of a vertex by the exact bits of its position and normal
+struct VertexKey {
+    uint32_t bits[6];
+
+    bool operator==(const VertexKey& other) const {
+        return std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey& key) const {
+        uint64_t hash = 1469598103934665603ull;  // FNV-1a over the six words
+        for (uint32_t word : key.bits) {
+            hash = (hash ^ word) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+void buildIndexedMesh(const std::vector<Facet>& facets, std::vector<MeshVertex>& vertices,
+                      std::vector<uint32_t>& indices) {
+    TRACE_SCOPE("buildIndexedMesh");
+    vertices.clear();
+    indices.clear();
+    indices.reserve(facets.size() * 3);
+
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> vertexIndex;
+    vertexIndex.reserve(facets.size() * 3);
+    for (const auto& facet : facets) {
+        for (int i = 0; i < 3; ++i) {
+            MeshVertex vertex;
+            for (int k = 0; k < 3; ++k) {
+                // Fold -0.0 into 0.0 so both share a vertex
+                vertex.position[k] = facet.vertices[i][k] + 0.0f;
+                vertex.normal[k] = facet.normal[k] + 0.0f;
+            }
+            VertexKey key;
+            std::memcpy(key.bits, &vertex, sizeof(key.bits));
+
+            auto inserted = vertexIndex.emplace(key, static_cast<uint32_t>(vertices.size()));
+            if (inserted.second) {
+                vertices.push_back(vertex);
+            }
+            indices.push_back(inserted.first->second);
+        }
+    }
+}
+
+MeshBuffer::MeshBuffer() : vertexBuffer_(0), indexBuffer_(0), vertexCount_(0), indexCount_(0) {}
+
+MeshBuffer::~MeshBuffer() {
+    release();
+}
+
+void MeshBuffer::upload(const std::vector<Facet>& facets) {
+    TRACE_SCOPE("MeshBuffer::upload");
+    release();
+
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    buildIndexedMesh(facets, vertices, indices);
+    vertexCount_ = vertices.size();
+    indexCount_ = indices.size();
+
+    vertexBuffer_ = createStaticBuffer(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data());
+    if (vertexBuffer_ == 0) {
+        vertices_ = std::move(vertices);
+        indices_ = std::move(indices);
+        return;
+    }
+    indexBuffer_ = createStaticBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data());
+}
+
+void MeshBuffer::release() {
+    deleteStaticBuffer(vertexBuffer_);
+    deleteStaticBuffer(indexBuffer_);
+    vertexBuffer_ = 0;
+    indexBuffer_ = 0;
+    vertices_.clear();
+    indices_.clear();
+    vertexCount_ = 0;
+    indexCount_ = 0;
+}
+
+void MeshBuffer::draw() const {
+    draw({TriangleRange{0, indexCount_ / 3}});
+}
+
+void MeshBuffer::draw(const std::vector<TriangleRange>& ranges) const {
+    if (indexCount_ == 0 || ranges.empty()) {
+        return;
+    }
+
+    // With a bound buffer the pointers are offsets into it
+    const GLBufferFunctions& gl = getGLBufferFunctions();
+    const char* vertexBase = reinterpret_cast<const char*>(vertices_.data());
+    const char* indexBase = reinterpret_cast<const char*>(indices_.data());
+    if (usesBufferObjects()) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+        gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+        vertexBase = nullptr;
+        indexBase = nullptr;
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), vertexBase + offsetof(MeshVertex, position));
+    glNormalPointer(GL_FLOAT, sizeof(MeshVertex), vertexBase + offsetof(MeshVertex, normal));
+
+    for (const auto& range : ranges) {
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.count * 3), GL_UNSIGNED_INT,
+                       indexBase + range.first * 3 * sizeof(uint32_t));
+    }
+
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    if (usesBufferObjects()) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+        gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef MESHBUFFER_H
+#define MESHBUFFER_H
+
+#include <vector>
+#include <cstdint>
+#include "stlfileloader.h"
+#include "glheaders.h"
+#include "frustumculler.h"
+
+// Interleaved vertex as uploaded to the GPU
+struct MeshVertex {
+    float position[3];
+    float normal[3];
+};
+
+// Indexed triangle list of a facet mesh. Corners with the same position and
+// normal share one vertex, so flat regions are stored only once. Triangles
+// keep the facet order.
+void buildIndexedMesh(const std::vector<Facet>& facets, std::vector<MeshVertex>& vertices,
+                      std::vector<uint32_t>& indices);
+
+// Facet mesh stored on the GPU once and drawn with one call per frame.
+// Falls back to client-side vertex arrays if the driver has no buffer objects.
+// Create, upload, draw and destroy with the same GL context current.
+class MeshBuffer {
+public:
+    MeshBuffer();
+    ~MeshBuffer();
+
+    MeshBuffer(const MeshBuffer&) = delete;
+    MeshBuffer& operator=(const MeshBuffer&) = delete;
+
+    void upload(const std::vector<Facet>& facets);
+    void release();
+
+    // Draw with the current color, material and polygon mode
+    void draw() const;
+
+    // Draw only the given facet ranges, one call per range
+    void draw(const std::vector<TriangleRange>& ranges) const;
+
+    bool usesBufferObjects() const { return vertexBuffer_ != 0; }
+    size_t getVertexCount() const { return vertexCount_; }
+    size_t getTriangleCount() const { return indexCount_ / 3; }
+
+private:
+    GLuint vertexBuffer_;
+    GLuint indexBuffer_;
+    size_t vertexCount_;
+    size_t indexCount_;
+
+    // Only kept without buffer objects
+    std::vector<MeshVertex> vertices_;
+    std::vector<uint32_t> indices_;
+};
+
+#endif // MESHBUFFER_H
@@ -0,0 +1,168 @@
+#include "offscreencontext.h"
+#include "glheaders.h"
+#include <algorithm>
+
+#ifdef ALPHA_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// Prefer the surfaceless platform so no X server is needed; fall back to the
+// default display otherwise
+static EGLDisplay openDisplay() {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+            return display;
+        }
+    }
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+#endif
+
+OffscreenContext::OffscreenContext()
+    : width_(0), height_(0), display_(nullptr), surface_(nullptr), context_(nullptr) {}
+
+OffscreenContext::~OffscreenContext() {
+    destroy();
+}
+
+bool OffscreenContext::isSupported() {
+#ifdef ALPHA_HAVE_EGL
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool OffscreenContext::create(int width, int height) {
+    destroy();
+#ifdef ALPHA_HAVE_EGL
+    EGLDisplay display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        return false;
+    }
+    display_ = display;
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs == 0 ||
+        !eglBindAPI(EGL_OPENGL_API)) {
+        destroy();
+        return false;
+    }
+
+    const EGLint surfaceAttributes[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+    if (surface == EGL_NO_SURFACE) {
+        destroy();
+        return false;
+    }
+    surface_ = surface;
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT) {
+        destroy();
+        return false;
+    }
+    context_ = context;
+
+    width_ = width;
+    height_ = height;
+    if (!makeCurrent()) {
+        destroy();
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+#else
+    (void)width;
+    (void)height;
+    return false;
+#endif
+}
+
+void OffscreenContext::destroy() {
+#ifdef ALPHA_HAVE_EGL
+    if (display_ != nullptr) {
+        EGLDisplay display = static_cast<EGLDisplay>(display_);
+        if (eglGetCurrentContext() == static_cast<EGLContext>(context_)) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        }
+        if (context_ != nullptr) {
+            eglDestroyContext(display, static_cast<EGLContext>(context_));
+        }
+        if (surface_ != nullptr) {
+            eglDestroySurface(display, static_cast<EGLSurface>(surface_));
+        }
+        // The display is shared by every context in the process, so it is
+        // left initialized
+    }
+#endif
+    display_ = nullptr;
+    surface_ = nullptr;
+    context_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+}
+
+bool OffscreenContext::makeCurrent() {
+#ifdef ALPHA_HAVE_EGL
+    if (context_ == nullptr) {
+        return false;
+    }
+    EGLSurface surface = static_cast<EGLSurface>(surface_);
+    return eglMakeCurrent(static_cast<EGLDisplay>(display_), surface, surface,
+                          static_cast<EGLContext>(context_)) == EGL_TRUE;
+#else
+    return false;
+#endif
+}
+
+void OffscreenContext::releaseCurrent() {
+#ifdef ALPHA_HAVE_EGL
+    if (display_ != nullptr) {
+        eglMakeCurrent(static_cast<EGLDisplay>(display_), EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+#endif
+}
+
+void OffscreenContext::readPixels(std::vector<uint8_t>& rgb) const {
+    rgb.assign(static_cast<size_t>(width_) * height_ * 3, 0);
+    if (context_ == nullptr) {
+        return;
+    }
+
+    glFinish();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+
+    // OpenGL returns the bottom row first
+    size_t rowBytes = static_cast<size_t>(width_) * 3;
+    std::vector<uint8_t> row(rowBytes);
+    for (int y = 0; y < height_ / 2; ++y) {
+        uint8_t* top = &rgb[y * rowBytes];
+        uint8_t* bottom = &rgb[(height_ - 1 - y) * rowBytes];
+        std::copy(top, top + rowBytes, row.begin());
+        std::copy(bottom, bottom + rowBytes, top);
+        std::copy(row.begin(), row.end(), bottom);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef OFFSCREENCONTEXT_H
+#define OFFSCREENCONTEXT_H
+
+#include <vector>
+#include <cstdint>
+
+// Window-less OpenGL context rendering into a pbuffer, for tests and batch
+// rendering on machines without a display. Uses EGL on a surfaceless Mesa
+// display; create() returns false where that is not available. One context
+// is current on at most one thread at a time.
+class OffscreenContext {
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    // Create the context and make it current on the calling thread
+    bool create(int width, int height);
+    void destroy();
+
+    bool makeCurrent();
+    void releaseCurrent();
+
+    // Read back the color buffer as RGB rows, top row first
+    void readPixels(std::vector<uint8_t>& rgb) const;
+
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+    bool isValid() const { return context_ != nullptr; }
+
+    // True if this build was compiled with offscreen support
+    static bool isSupported();
+
+private:
+    int width_;
+    int height_;
+    void* display_;
+    void* surface_;
+    void* context_;
+};
+
+#endif // OFFSCREENCONTEXT_H
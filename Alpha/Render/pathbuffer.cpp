@@ -0,0 +1,155 @@
+#include "pathbuffer.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+// Resolution of the end effector sphere
+constexpr int GLYPH_SLICES = 12;
+constexpr int GLYPH_STACKS = 12;
+constexpr float GLYPH_PI = 3.14159265358979f;
+
+PathBuffer::PathBuffer() : buffer_(0), pointCount_(0) {}
+
+PathBuffer::~PathBuffer() {
+    release();
+}
+
+void PathBuffer::upload(const std::vector<PathPoint>& path) {
+    TRACE_SCOPE("PathBuffer::upload");
+    release();
+
+    // Points are uploaded as they are; the normals are skipped by the stride
+    pointCount_ = path.size();
+    if (path.empty()) {
+        return;
+    }
+    buffer_ = createStaticBuffer(GL_ARRAY_BUFFER, path.size() * sizeof(PathPoint), path.data());
+    if (buffer_ == 0) {
+        points_ = path;
+    }
+}
+
+void PathBuffer::release() {
+    deleteStaticBuffer(buffer_);
+    buffer_ = 0;
+    pointCount_ = 0;
+    points_.clear();
+}
+
+void PathBuffer::draw(size_t completedCount) const {
+    if (pointCount_ == 0) {
+        return;
+    }
+
+    const GLBufferFunctions& gl = getGLBufferFunctions();
+    const void* base = points_.data();
+    if (usesBufferObjects()) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, buffer_);
+        base = nullptr;
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(PathPoint), base);
+
+    GLsizei count = static_cast<GLsizei>(pointCount_);
+
+    // All path points
+    glPointSize(3.0f);
+    glColor3f(0.0f, 0.6f, 1.0f);  // Light blue for all points
+    glDrawArrays(GL_POINTS, 0, count);
+
+    // Path lines
+    glLineWidth(1.5f);
+    glColor3f(0.0f, 0.8f, 1.0f);  // Slightly brighter blue for lines
+    glDrawArrays(GL_LINE_STRIP, 0, count);
+
+    // Completed segments
+    GLsizei completed = static_cast<GLsizei>(std::min(completedCount, pointCount_));
+    if (completed > 0) {
+        glLineWidth(2.5f);
+        glColor3f(0.0f, 1.0f, 0.5f);  // Green for completed path
+        glDrawArrays(GL_LINE_STRIP, 0, completed);
+    }
+
+    glLineWidth(1.0f);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (usesBufferObjects()) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+EndEffectorGlyph::EndEffectorGlyph() : buffer_(0) {}
+
+EndEffectorGlyph::~EndEffectorGlyph() {
+    release();
+}
+
+void EndEffectorGlyph::upload() {
+    release();
+
+    auto addVertex = [this](float phi, float theta) {
+        vertices_.push_back(std::sin(phi) * std::cos(theta));
+        vertices_.push_back(std::sin(phi) * std::sin(theta));
+        vertices_.push_back(std::cos(phi));
+    };
+
+    vertices_.reserve(GLYPH_STACKS * GLYPH_SLICES * 4 * 3);
+    for (int i = 0; i < GLYPH_STACKS; ++i) {
+        float phi1 = static_cast<float>(i) / GLYPH_STACKS * GLYPH_PI;
+        float phi2 = static_cast<float>(i + 1) / GLYPH_STACKS * GLYPH_PI;
+        for (int j = 0; j < GLYPH_SLICES; ++j) {
+            float theta1 = static_cast<float>(j) / GLYPH_SLICES * 2.0f * GLYPH_PI;
+            float theta2 = static_cast<float>(j + 1) / GLYPH_SLICES * 2.0f * GLYPH_PI;
+            addVertex(phi1, theta1);
+            addVertex(phi1, theta2);
+            addVertex(phi2, theta2);
+            addVertex(phi2, theta1);
+        }
+    }
+
+    // The vertices stay on the CPU as well; they are only a few kilobytes
+    buffer_ = createStaticBuffer(GL_ARRAY_BUFFER, vertices_.size() * sizeof(float), vertices_.data());
+}
+
+void EndEffectorGlyph::release() {
+    deleteStaticBuffer(buffer_);
+    buffer_ = 0;
+    vertices_.clear();
+}
+
+void EndEffectorGlyph::draw(const PathPoint& point, float radius, float normalLength) const {
+    if (vertices_.empty()) {
+        return;
+    }
+
+    glPushMatrix();
+    glTranslatef(point.x, point.y, point.z);
+
+    // Sphere
+    glPushMatrix();
+    glScalef(radius, radius, radius);
+    glColor3f(1.0f, 0.2f, 0.2f);  // Red for the end effector
+
+    const GLBufferFunctions& gl = getGLBufferFunctions();
+    const void* base = vertices_.data();
+    if (buffer_ != 0) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, buffer_);
+        base = nullptr;
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, base);
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(getVertexCount()));
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (buffer_ != 0) {
+        gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glPopMatrix();
+
+    // Line showing the normal direction
+    glBegin(GL_LINES);
+    glColor3f(1.0f, 1.0f, 0.0f);  // Yellow for normal
+    glVertex3f(0.0f, 0.0f, 0.0f);
+    glVertex3f(point.nx * normalLength, point.ny * normalLength, point.nz * normalLength);
+    glEnd();
+
+    glPopMatrix();
+}
@@ -0,0 +1,57 @@
+#ifndef PATHBUFFER_H
+#define PATHBUFFER_H
+
+#include <vector>
+#include "pathplanner.h"
+#include "glheaders.h"
+
+// Tool path stored on the GPU once. Each frame draws the points, the full
+// line strip and the completed part as ranged draws of the same buffer, so
+// the CPU cost no longer depends on the path length.
+class PathBuffer {
+public:
+    PathBuffer();
+    ~PathBuffer();
+
+    PathBuffer(const PathBuffer&) = delete;
+    PathBuffer& operator=(const PathBuffer&) = delete;
+
+    void upload(const std::vector<PathPoint>& path);
+    void release();
+
+    // Points and lines of the whole path, then the first completedCount
+    // points highlighted
+    void draw(size_t completedCount) const;
+
+    bool usesBufferObjects() const { return buffer_ != 0; }
+    size_t getPointCount() const { return pointCount_; }
+
+private:
+    GLuint buffer_;
+    size_t pointCount_;
+    std::vector<PathPoint> points_;  // Only kept without buffer objects
+};
+
+// Sphere marking the end effector, tessellated once at unit radius
+class EndEffectorGlyph {
+public:
+    EndEffectorGlyph();
+    ~EndEffectorGlyph();
+
+    EndEffectorGlyph(const EndEffectorGlyph&) = delete;
+    EndEffectorGlyph& operator=(const EndEffectorGlyph&) = delete;
+
+    void upload();
+    void release();
+
+    // Sphere of the given radius around point, with its normal as a line
+    void draw(const PathPoint& point, float radius, float normalLength) const;
+
+    size_t getVertexCount() const { return vertices_.size() / 3; }
+
+private:
+    GLuint buffer_;
+    std::vector<float> vertices_;  // Quads, 3 floats per vertex
+};
+
+#endif // PATHBUFFER_H
@@ -0,0 +1,117 @@
+#include "pngwriter.h"
+#include <algorithm>
+#include <fstream>
+#ifdef ALPHA_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+struct CRCTable {
+    uint32_t entries[256];
+
+    CRCTable() {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+    }
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    static const CRCTable table;  // Thread-safe one-time initialization
+    for (size_t i = 0; i < length; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void writeChunk(std::ofstream& file, const char type[4], const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    appendBigEndian(chunk, static_cast<uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    uint32_t crc = crc32Update(0xFFFFFFFFu, chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFFu;
+    appendBigEndian(chunk, crc);
+    file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+}
+
+// zlib stream of the filtered scanlines
+static std::vector<uint8_t> deflateScanlines(const std::vector<uint8_t>& raw) {
+#ifdef ALPHA_HAVE_ZLIB
+    uLongf length = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<uint8_t> compressed(length);
+    if (compress2(compressed.data(), &length, raw.data(), static_cast<uLong>(raw.size()), Z_DEFAULT_COMPRESSION) == Z_OK) {
+        compressed.resize(length);
+        return compressed;
+    }
+#endif
+    // Stored (uncompressed) deflate blocks of at most 65535 bytes
+    std::vector<uint8_t> out = {0x78, 0x01};
+    size_t offset = 0;
+    do {
+        size_t length = std::min<size_t>(raw.size() - offset, 65535);
+        bool last = offset + length == raw.size();
+        out.push_back(last ? 1 : 0);
+        out.push_back(static_cast<uint8_t>(length));
+        out.push_back(static_cast<uint8_t>(length >> 8));
+        out.push_back(static_cast<uint8_t>(~length));
+        out.push_back(static_cast<uint8_t>(~length >> 8));
+        out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendBigEndian(out, (b << 16) | a);
+    return out;
+}
+
+bool writePNG(const std::string& filename, int width, int height, const std::vector<uint8_t>& rgb) {
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    if (width <= 0 || height <= 0 || rgb.size() < rowBytes * height) {
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(width));
+    appendBigEndian(header, static_cast<uint32_t>(height));
+    header.push_back(8);  // Bit depth
+    header.push_back(2);  // Color type RGB
+    header.push_back(0);  // Deflate
+    header.push_back(0);  // Adaptive filtering
+    header.push_back(0);  // No interlace
+    writeChunk(file, "IHDR", header);
+
+    // Every scanline starts with filter type 0 (none)
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb.begin() + y * rowBytes, rgb.begin() + (y + 1) * rowBytes);
+    }
+    writeChunk(file, "IDAT", deflateScanlines(raw));
+    writeChunk(file, "IEND", std::vector<uint8_t>());
+
+    return file.good();
+}
@@ -0,0 +1,13 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Write 8-bit RGB pixels (rows top first, as OffscreenContext::readPixels
+// returns them) as a PNG file. Compressed with zlib when the build has it,
+// stored uncompressed otherwise.
+bool writePNG(const std::string& filename, int width, int height, const std::vector<uint8_t>& rgb);
+
+#endif // PNGWRITER_H
@@ -0,0 +1,63 @@
+#include "previewrenderer.h"
+#include "scenedraw.h"
+#include "trace.h"
+
+const std::vector<PreviewView>& getPreviewViews() {
+    static const std::vector<PreviewView> views = {
+        {"iso", 20.0f, 30.0f},
+        {"front", 0.0f, 0.0f},
+        {"side", 0.0f, 90.0f},
+        {"top", 90.0f, 0.0f},
+    };
+    return views;
+}
+
+PreviewRenderer::PreviewRenderer() : modelSize_(1.0f), modelCenter_{0.0f, 0.0f, 0.0f} {
+}
+
+void PreviewRenderer::setPart(const std::vector<Facet>& facets, const std::vector<float>& slices,
+                              const std::vector<PathPoint>& path) {
+    TRACE_SCOPE("PreviewRenderer::setPart");
+    calculateModelBounds(facets, modelSize_, modelCenter_);
+    mesh_.upload(facets);
+    path_.upload(path);
+    slices_ = slices;
+}
+
+void PreviewRenderer::release() {
+    mesh_.release();
+    path_.release();
+    slices_.clear();
+}
+
+void PreviewRenderer::render(const PreviewView& view, const PreviewOptions& options, int width, int height) const {
+    TRACE_SCOPE("PreviewRenderer::render");
+    glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    // Same framing as Visu when it opens a part
+    float zoom = modelSize_ * 2.0f;
+    setupCamera(width, height, zoom, view.rotX, view.rotY);
+
+    if (options.showAxis) {
+        drawAxis(modelSize_ * 0.5f);
+    }
+
+    setupModelLighting(zoom);
+    glTranslatef(-modelCenter_[0], -modelCenter_[1], -modelCenter_[2]);
+    mesh_.draw();
+    glDisable(GL_LIGHTING);
+
+    if (options.showSlices) {
+        for (float z : slices_) {
+            drawSlicePlane(z, modelSize_);
+        }
+    }
+
+    if (options.showPath) {
+        path_.draw(0);
+    }
+
+    glFinish();
+}
@@ -0,0 +1,47 @@
+#ifndef PREVIEWRENDERER_H
+#define PREVIEWRENDERER_H
+
+#include <string>
+#include <vector>
+#include "meshbuffer.h"
+#include "pathbuffer.h"
+
+// Camera angles of a preview, in Visu's convention (degrees about X, then Y)
+struct PreviewView {
+    std::string name;
+    float rotX;
+    float rotY;
+};
+
+// Visu's startup view ("iso") and the three axis views
+const std::vector<PreviewView>& getPreviewViews();
+
+struct PreviewOptions {
+    bool showSlices;
+    bool showPath;
+    bool showAxis;
+};
+
+// Draws one part the way Visu does, for thumbnails and path previews. The
+// part is uploaded once and can then be rendered from any number of views.
+// Upload, render and destroy with the same GL context current.
+class PreviewRenderer {
+public:
+    PreviewRenderer();
+
+    void setPart(const std::vector<Facet>& facets, const std::vector<float>& slices,
+                 const std::vector<PathPoint>& path);
+    void release();
+
+    // Clear and draw the part into the current framebuffer
+    void render(const PreviewView& view, const PreviewOptions& options, int width, int height) const;
+
+private:
+    MeshBuffer mesh_;
+    PathBuffer path_;
+    std::vector<float> slices_;
+    float modelSize_;
+    float modelCenter_[3];
+};
+
+#endif // PREVIEWRENDERER_H
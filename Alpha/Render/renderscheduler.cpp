@@ -0,0 +1,95 @@
+#include "renderscheduler.h"
+#include <algorithm>
+
+RenderScheduler::RenderScheduler(SchedulerDuration minFrameInterval, SchedulerDuration pollInterval)
+    : minFrameInterval_(minFrameInterval), pollInterval_(pollInterval),
+      dirty_(true), hasScheduled_(false), hasFrame_(false), frameCount_(0) {}
+
+void RenderScheduler::scheduleAt(SchedulerTime when) {
+    if (!hasScheduled_ || when < scheduled_) {
+        scheduled_ = when;
+        hasScheduled_ = true;
+    }
+}
+
+bool RenderScheduler::shouldDraw(SchedulerTime now) const {
+    bool due = dirty_ || (hasScheduled_ && now >= scheduled_);
+    if (!due) {
+        return false;
+    }
+    return !hasFrame_ || now - lastFrame_ >= minFrameInterval_;
+}
+
+void RenderScheduler::frameDrawn(SchedulerTime now) {
+    lastFrame_ = now;
+    hasFrame_ = true;
+    dirty_ = false;
+    if (hasScheduled_ && now >= scheduled_) {
+        hasScheduled_ = false;
+    }
+    ++frameCount_;
+}
+
+SchedulerDuration RenderScheduler::timeUntilNextEvent(SchedulerTime now) const {
+    SchedulerDuration wait = pollInterval_;
+    if (hasScheduled_) {
+        wait = std::min(wait, scheduled_ - now);
+    }
+    if (dirty_ || (hasScheduled_ && now >= scheduled_)) {
+        // Only the frame rate limit holds the frame back
+        wait = hasFrame_ ? std::min(wait, lastFrame_ + minFrameInterval_ - now) : SchedulerDuration::zero();
+    }
+    return std::max(wait, SchedulerDuration::zero());
+}
+
+AnimationClock::AnimationClock(double stepsPerSecond)
+    : stepsPerSecond_(stepsPerSecond), running_(false) {}
+
+SchedulerDuration AnimationClock::stepDuration() const {
+    return std::chrono::duration_cast<SchedulerDuration>(std::chrono::duration<double>(1.0 / stepsPerSecond_));
+}
+
+void AnimationClock::start(SchedulerTime now) {
+    anchor_ = now;
+    running_ = true;
+}
+
+void AnimationClock::setStepsPerSecond(double stepsPerSecond, SchedulerTime now) {
+    if (running_) {
+        // Keep the fraction of the current step that has already passed
+        double fraction = std::chrono::duration<double>(now - anchor_).count() * stepsPerSecond_;
+        fraction = std::min(std::max(fraction, 0.0), 1.0);
+        anchor_ = now - std::chrono::duration_cast<SchedulerDuration>(
+            std::chrono::duration<double>(fraction / stepsPerSecond));
+    }
+    stepsPerSecond_ = stepsPerSecond;
+}
+
+size_t AnimationClock::advance(SchedulerTime now) {
+    if (!running_ || now <= anchor_) {
+        return 0;
+    }
+    SchedulerDuration step = stepDuration();
+    size_t steps = static_cast<size_t>((now - anchor_) / step);
+    anchor_ += step * static_cast<SchedulerDuration::rep>(steps);
+    return steps;
+}
+
+SchedulerTime AnimationClock::nextStepTime() const {
+    return anchor_ + stepDuration();
+}
+
+RateLimiter::RateLimiter(SchedulerDuration interval)
+    : interval_(interval), hasLast_(false), suppressed_(0), pendingSuppressed_(0) {}
+
+bool RateLimiter::allow(SchedulerTime now) {
+    if (hasLast_ && now - last_ < interval_) {
+        ++pendingSuppressed_;
+        return false;
+    }
+    last_ = now;
+    hasLast_ = true;
+    suppressed_ = pendingSuppressed_;
+    pendingSuppressed_ = 0;
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+
+// Timing helpers for an event-driven viewer loop. None of them read the
+// clock themselves; the caller passes the current time, so they are easy to
+// drive from tests.
+using SchedulerClock = std::chrono::steady_clock;
+using SchedulerTime = SchedulerClock::time_point;
+using SchedulerDuration = SchedulerClock::duration;
+
+// Decides when a frame has to be drawn: after input or new data marked the
+// view dirty, or once a scheduled time (an animation tick) has passed. Frames
+// are at least minFrameInterval apart; between them the loop polls for input
+// every pollInterval without drawing.
+class RenderScheduler {
+public:
+    explicit RenderScheduler(SchedulerDuration minFrameInterval = std::chrono::milliseconds(16),
+                             SchedulerDuration pollInterval = std::chrono::milliseconds(10));
+
+    // The view changed; draw at the next opportunity
+    void requestRedraw() { dirty_ = true; }
+
+    // Draw no later than when (keeps the earliest pending time)
+    void scheduleAt(SchedulerTime when);
+
+    bool shouldDraw(SchedulerTime now) const;
+    void frameDrawn(SchedulerTime now);
+
+    // How long the loop may sleep before it has to poll or draw again
+    SchedulerDuration timeUntilNextEvent(SchedulerTime now) const;
+
+    size_t getFrameCount() const { return frameCount_; }
+
+private:
+    SchedulerDuration minFrameInterval_;
+    SchedulerDuration pollInterval_;
+    SchedulerTime lastFrame_;
+    SchedulerTime scheduled_;
+    bool dirty_;
+    bool hasScheduled_;
+    bool hasFrame_;
+    size_t frameCount_;
+};
+
+// Animation steps at a fixed rate of wall-clock time. When frames come late
+// the steps that were due in between are returned together, so the animation
+// keeps its speed regardless of the frame rate.
+class AnimationClock {
+public:
+    explicit AnimationClock(double stepsPerSecond = 6.0);
+
+    void start(SchedulerTime now);
+    void stop() { running_ = false; }
+    bool isRunning() const { return running_; }
+
+    // Takes effect from now on without jumping
+    void setStepsPerSecond(double stepsPerSecond, SchedulerTime now);
+    double getStepsPerSecond() const { return stepsPerSecond_; }
+
+    // Whole steps due since the last call
+    size_t advance(SchedulerTime now);
+
+    // Time the next step is due
+    SchedulerTime nextStepTime() const;
+
+private:
+    SchedulerDuration stepDuration() const;
+
+    double stepsPerSecond_;
+    SchedulerTime anchor_;  // Time of the last step taken
+    bool running_;
+};
+
+// Lets a message through at most once per interval and counts the ones it
+// held back, so a fast animation does not flood the console
+class RateLimiter {
+public:
+    explicit RateLimiter(SchedulerDuration interval = std::chrono::milliseconds(250));
+
+    // True if a message may be written now
+    bool allow(SchedulerTime now);
+
+    // Messages held back since the last one let through
+    size_t getSuppressedCount() const { return suppressed_; }
+
+private:
+    SchedulerDuration interval_;
+    SchedulerTime last_;
+    bool hasLast_;
+    size_t suppressed_;
+    size_t pendingSuppressed_;
+};
+
+#endif // RENDERSCHEDULER_H
@@ -0,0 +1,161 @@
+#include "scenedraw.h"
+#include <algorithm>
+#include <cmath>
+
+void calculateModelBounds(const std::vector<Facet>& facets, float& size, float center[3]) {
+    if (facets.empty()) {
+        size = 1.0f;
+        center[0] = center[1] = center[2] = 0.0f;
+        return;
+    }
+
+    // Initialize bounds
+    float minX = facets[0].vertices[0][0];
+    float maxX = minX;
+    float minY = facets[0].vertices[0][1];
+    float maxY = minY;
+    float minZ = facets[0].vertices[0][2];
+    float maxZ = minZ;
+
+    // Find min and max values for each dimension
+    for (const auto& facet : facets) {
+        for (int i = 0; i < 3; ++i) {
+            minX = std::min(minX, facet.vertices[i][0]);
+            maxX = std::max(maxX, facet.vertices[i][0]);
+            minY = std::min(minY, facet.vertices[i][1]);  // Track Y-axis
+            maxY = std::max(maxY, facet.vertices[i][1]);  // Track Y-axis
+            minZ = std::min(minZ, facet.vertices[i][2]);
+            maxZ = std::max(maxZ, facet.vertices[i][2]);
+        }
+    }
+
+    // Calculate center point
+    center[0] = (minX + maxX) / 2.0f;
+    center[1] = (minY + maxY) / 2.0f;  // Center along Y-axis
+    center[2] = (minZ + maxZ) / 2.0f;
+
+    // Calculate model size
+    float dx = maxX - minX;
+    float dy = maxY - minY;  // Size along Y-axis
+    float dz = maxZ - minZ;
+    size = std::max({ dx, dy, dz });
+
+    if (size < 0.001f) size = 1.0f;  // Prevent too small models
+}
+
+void setupCamera(int width, int height, float zoom, float rotX, float rotY) {
+    glViewport(0, 0, width, height);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    float aspect = (float)width / (float)height;
+
+    float fovY = 45.0f;
+    float nearPlane = 0.1f;
+    float farPlane = zoom * 10.0f;
+
+    float tanHalfFovy = tanf((fovY * 3.14159f / 180.0f) / 2.0f);
+    float f = 1.0f / tanHalfFovy;
+
+    float perspective[16] = {
+        f / aspect, 0, 0, 0,
+        0, f, 0, 0,
+        0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
+        0, 0, (2 * farPlane * nearPlane) / (nearPlane - farPlane), 0
+    };
+    glMultMatrixf(perspective);
+
+    // Set modelview
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // Position camera
+    glTranslatef(0, 0, -zoom);
+
+    // Apply rotation
+    glRotatef(rotX, 1, 0, 0);
+    glRotatef(rotY, 0, 1, 0);
+}
+
+void setupModelLighting(float zoom) {
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+
+    // Set light position
+    GLfloat lightPos[] = { zoom * 2.0f, zoom * 2.0f, zoom * 2.0f, 1.0f };
+    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+
+    // Set ambient light
+    GLfloat ambientLight[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+    glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
+
+    // Set diffuse light
+    GLfloat diffuseLight[] = { 0.7f, 0.7f, 0.7f, 1.0f };
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
+
+    // Material properties for solid mode
+    GLfloat modelColor[] = { 0.8f, 0.8f, 0.8f, 1.0f };
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, modelColor);
+}
+
+// Draw axis for orientation
+void drawAxis(float size) {
+    glLineWidth(2.0f);
+
+    // X-axis (red)
+    glBegin(GL_LINES);
+    glColor3f(1.0f, 0.0f, 0.0f);
+    glVertex3f(0.0f, 0.0f, 0.0f);
+    glVertex3f(size, 0.0f, 0.0f);
+    glEnd();
+
+    // Y-axis (green)
+    glBegin(GL_LINES);
+    glColor3f(0.0f, 1.0f, 0.0f);
+    glVertex3f(0.0f, 0.0f, 0.0f);
+    glVertex3f(0.0f, size, 0.0f);
+    glEnd();
+
+    // Z-axis (blue)
+    glBegin(GL_LINES);
+    glColor3f(0.0f, 0.0f, 1.0f);
+    glVertex3f(0.0f, 0.0f, 0.0f);
+    glVertex3f(0.0f, 0.0f, size);
+    glEnd();
+
+    glLineWidth(1.0f);
+}
+
+// Draw a slice plane with transparency (updated for vertical slicing along Z-axis)
+void drawSlicePlane(float z, float modelSize, bool highlight) {
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (highlight) {
+        glColor4f(0.0f, 0.8f, 0.8f, 0.5f); // Cyan highlight
+    }
+    else {
+        glColor4f(0.5f, 0.5f, 0.7f, 0.2f); // Normal color
+    }
+
+    const float halfSize = modelSize;  // Full model coverage
+
+    // Draw a vertical plane perpendicular to the Z-axis at position z
+    glBegin(GL_QUADS);
+    glVertex3f(-halfSize, -halfSize, z);
+    glVertex3f(halfSize, -halfSize, z);
+    glVertex3f(halfSize, halfSize, z);
+    glVertex3f(-halfSize, halfSize, z);
+    glEnd();
+
+    // Border
+    glColor4f(0.7f, 0.7f, 0.9f, 0.8f);
+    glBegin(GL_LINE_LOOP);
+    glVertex3f(-halfSize, -halfSize, z);
+    glVertex3f(halfSize, -halfSize, z);
+    glVertex3f(halfSize, halfSize, z);
+    glVertex3f(-halfSize, halfSize, z);
+    glEnd();
+
+    glDisable(GL_BLEND);
+}
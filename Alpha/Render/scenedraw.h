@@ -0,0 +1,28 @@
+#ifndef SCENEDRAW_H
+#define SCENEDRAW_H
+
+#include <vector>
+#include "stlfileloader.h"
+#include "glheaders.h"
+
+// Scene drawing shared by Visu and the offscreen preview renderer. All
+// functions draw with the OpenGL context current on the calling thread.
+
+// Calculate model bounds and center point
+void calculateModelBounds(const std::vector<Facet>& facets, float& size, float center[3]);
+
+// Viewport, perspective projection and a camera at distance zoom, orbiting
+// the origin by rotX degrees about X and then rotY degrees about Y
+void setupCamera(int width, int height, float zoom, float rotX, float rotY);
+
+// Light for solid model drawing, placed relative to the camera distance,
+// and the model's material
+void setupModelLighting(float zoom);
+
+// Draw axis for orientation
+void drawAxis(float size);
+
+// Draw a slice plane with transparency (perpendicular to the Z-axis)
+void drawSlicePlane(float z, float modelSize, bool highlight = false);
+
+#endif // SCENEDRAW_H
@@ -0,0 +1,17 @@
+#include "geometry.h"
+
+bool parsePrecision(const std::string& name, Precision& precision) {
+    if (name == "float" || name == "single") {
+        precision = Precision::Single;
+        return true;
+    }
+    if (name == "double") {
+        precision = Precision::Double;
+        return true;
+    }
+    return false;
+}
+
+const char* precisionName(Precision precision) {
+    return precision == Precision::Double ? "double" : "float";
+}
@@ -0,0 +1,57 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <vector>
+#include <string>
+
+// Scalar type used for coordinates while slicing and planning a part.
+// Single is the default and the fastest; Double keeps large parts in
+// millimetres accurate where float rounding reaches the comparison epsilon.
+enum class Precision {
+    Single,
+    Double
+};
+
+bool parsePrecision(const std::string& name, Precision& precision);
+const char* precisionName(Precision precision);
+
+// Comparison tolerances that scale with the precision of the scalar type
+template <typename Scalar>
+struct GeometryTraits;
+
+template <>
+struct GeometryTraits<float> {
+    static constexpr float epsilon = 1.0e-6f;
+};
+
+template <>
+struct GeometryTraits<double> {
+    static constexpr double epsilon = 1.0e-9;
+};
+
+// Triangle of a mesh. STL files store float; meshes are converted to double
+// for planning in double precision.
+template <typename Scalar>
+struct FacetT {
+    Scalar normal[3];
+    Scalar vertices[3][3];
+};
+
+using Facet = FacetT<float>;
+using FacetD = FacetT<double>;
+
+template <typename To, typename From>
+std::vector<FacetT<To>> convertFacets(const std::vector<FacetT<From>>& facets) {
+    std::vector<FacetT<To>> converted(facets.size());
+    for (size_t f = 0; f < facets.size(); ++f) {
+        for (int i = 0; i < 3; ++i) {
+            converted[f].normal[i] = static_cast<To>(facets[f].normal[i]);
+            for (int k = 0; k < 3; ++k) {
+                converted[f].vertices[i][k] = static_cast<To>(facets[f].vertices[i][k]);
+            }
+        }
+    }
+    return converted;
+}
+
+#endif // GEOMETRY_H
@@ -0,0 +1,66 @@
+#include "stlfacetreader.h"
+#include "stlformat.h"
+#include <algorithm>
+#include <cstring>
+
+STLFacetReader::STLFacetReader() : facetCount_(0), facetsRead_(0) {}
+
+bool STLFacetReader::open(const std::string& filename) {
+    close();
+    file_.open(filename, std::ios::binary);
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    file_.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(file_.tellg());
+    file_.seekg(80, std::ios::beg);
+    uint32_t numFacets = 0;
+    file_.read(reinterpret_cast<char*>(&numFacets), 4);
+    if (!file_ || size < STL_HEADER_SIZE + STL_FACET_SIZE * numFacets) {
+        close();
+        return false;
+    }
+
+    facetCount_ = numFacets;
+    return true;
+}
+
+void STLFacetReader::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.clear();
+    facetCount_ = 0;
+    facetsRead_ = 0;
+}
+
+size_t STLFacetReader::readFacets(std::vector<Facet>& block, size_t maxFacets) {
+    size_t count = std::min<size_t>(maxFacets, facetCount_ - facetsRead_);
+    block.resize(count);
+    if (count == 0) {
+        return 0;
+    }
+
+    buffer_.resize(count * STL_FACET_SIZE);
+    file_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    if (!file_) {
+        block.clear();
+        return 0;
+    }
+
+    // Normal and three vertices, then a 2-byte attribute count that is skipped
+    const char* record = buffer_.data();
+    for (size_t i = 0; i < count; ++i, record += STL_FACET_SIZE) {
+        std::memcpy(block[i].normal, record, sizeof(block[i].normal));
+        std::memcpy(block[i].vertices, record + sizeof(block[i].normal), sizeof(block[i].vertices));
+    }
+    facetsRead_ += static_cast<uint32_t>(count);
+    return count;
+}
+
+void STLFacetReader::rewind() {
+    file_.clear();
+    file_.seekg(STL_HEADER_SIZE, std::ios::beg);
+    facetsRead_ = 0;
+}
@@ -0,0 +1,36 @@
+#ifndef STLFACETREADER_H
+#define STLFACETREADER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "geometry.h"
+
+// Reads a binary STL file a block of facets at a time, so callers can work
+// through a part without holding all of it
+class STLFacetReader {
+public:
+    STLFacetReader();
+
+    // Open the file and check that it holds every facet its header announces
+    bool open(const std::string& filename);
+    void close();
+
+    uint32_t getFacetCount() const { return facetCount_; }
+
+    // Replace block with up to maxFacets of the next facets; returns how many
+    // were read, 0 at the end of the file
+    size_t readFacets(std::vector<Facet>& block, size_t maxFacets);
+
+    // Start again at the first facet
+    void rewind();
+
+private:
+    std::ifstream file_;
+    uint32_t facetCount_;
+    uint32_t facetsRead_;
+    std::vector<char> buffer_;
+};
+
+#endif // STLFACETREADER_H
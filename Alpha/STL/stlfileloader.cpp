@@ -1,29 +1,50 @@
 #include "stlfileloader.h"
+#include "stlformat.h"
+#include "trace.h"
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <vector>
 
+// Size of an open file in bytes; leaves the read position at the start
+static uint64_t fileSize(std::ifstream& file) {
+    file.seekg(0, std::ios::end);
+    uint64_t size = static_cast<uint64_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    return size;
+}
+
 STLFileLoader::STLFileLoader(const std::string& filename) : filename_(filename) {}
 
 STLFileLoader::~STLFileLoader() {}
 
 bool STLFileLoader::loadSTLFile() {
+    TRACE_SCOPE("STLFileLoader::loadSTLFile");
     std::ifstream file(filename_, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Failed to open file: " << filename_ << std::endl;
         return false;
     }
 
+    uint64_t size = fileSize(file);
+
     // Read STL file header (80 bytes)
     char header[80];
     file.read(header, 80);
 
     // Read number of facets (4 bytes)
-    uint32_t numFacets;
+    uint32_t numFacets = 0;
     file.read(reinterpret_cast<char*>(&numFacets), 4);
 
-    // Read facets
+    // The file must hold every facet it announces
     facets_.clear();
+    if (!file || size < STL_HEADER_SIZE + STL_FACET_SIZE * numFacets) {
+        std::cerr << "Not a binary STL file: " << filename_ << std::endl;
+        return false;
+    }
+
+    // Read facets
+    facets_.reserve(numFacets);
     for (uint32_t i = 0; i < numFacets; ++i) {
         Facet facet;
 
@@ -41,6 +62,9 @@ bool STLFileLoader::loadSTLFile() {
         facets_.push_back(facet);
     }
 
+    TRACE_COUNTER("facets", facets_.size());
+    facetsTally_.set(facets_.capacity() * sizeof(Facet));
+
     file.close();
     return true;
 }
@@ -55,17 +79,20 @@ bool isValidSTLFile(const std::string& filename) {
         return false; // File does not exist or cannot be opened
     }
 
+    uint64_t size = fileSize(file);
+
     // Read STL file header (80 bytes)
     char header[80];
     file.read(header, 80);
 
     // Read number of facets (4 bytes)
-    uint32_t numFacets;
+    uint32_t numFacets = 0;
     file.read(reinterpret_cast<char*>(&numFacets), 4);
 
-    // Simple validation: Ensure numFacets is reasonable
-    if (numFacets < 1 || numFacets > 5000000) {
-        return false; // Unlikely number of facets
+    // Validation: the facet count must match the file size, which rejects
+    // ASCII and truncated files without capping the model size
+    if (!file || numFacets < 1 || size < STL_HEADER_SIZE + STL_FACET_SIZE * numFacets) {
+        return false;
     }
 
     file.close();
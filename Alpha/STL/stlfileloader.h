@@ -3,11 +3,8 @@
 
 #include <vector>
 #include <string>
-
-struct Facet {
-    float normal[3];
-    float vertices[3][3];
-};
+#include "memstats.h"
+#include "geometry.h"
 
 class STLFileLoader {
 public:
@@ -23,6 +20,7 @@ public:
 private:
     std::string filename_;
     std::vector<Facet> facets_;
+    MemoryTally facetsTally_{"STLFileLoader facets"};
 };
 
 bool isValidSTLFile(const std::string& filename);
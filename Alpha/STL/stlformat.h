@@ -0,0 +1,10 @@
+#ifndef STLFORMAT_H
+#define STLFORMAT_H
+
+#include <cstdint>
+
+// Binary STL layout: 80-byte header, 4-byte facet count, 50 bytes per facet
+constexpr uint64_t STL_HEADER_SIZE = 84;
+constexpr uint64_t STL_FACET_SIZE = 50;
+
+#endif // STLFORMAT_H
@@ -1,18 +1,28 @@
 #include "uniformslicingalg.h"
+#include "trace.h"
 #include <algorithm>
+#include <limits>
 
-UniformSlicingAlgorithm::UniformSlicingAlgorithm(const std::vector<Facet>& facets) : facets_(facets) {}
+template <typename Scalar>
+UniformSlicingAlgorithmT<Scalar>::UniformSlicingAlgorithmT(const std::vector<FacetT<Scalar>>& facets) : facets_(facets) {
+    facetsTally_.set(facets_.capacity() * sizeof(FacetT<Scalar>));
+}
 
-UniformSlicingAlgorithm::~UniformSlicingAlgorithm() {}
+template <typename Scalar>
+UniformSlicingAlgorithmT<Scalar>::~UniformSlicingAlgorithmT() {}
 
-void UniformSlicingAlgorithm::setToolLength(float toolLength) {
+template <typename Scalar>
+void UniformSlicingAlgorithmT<Scalar>::setToolLength(Scalar toolLength) {
     toolLength_ = toolLength;
 }
 
-std::vector<float> UniformSlicingAlgorithm::generateSlices() {
+template <typename Scalar>
+std::vector<Scalar> UniformSlicingAlgorithmT<Scalar>::generateSlices() {
+    TRACE_SCOPE("UniformSlicingAlgorithm::generateSlices");
+
     // Find min and max Z values (for vertical slicing along Z-axis)
-    float minZ = std::numeric_limits<float>::max();
-    float maxZ = std::numeric_limits<float>::min();
+    Scalar minZ = std::numeric_limits<Scalar>::max();
+    Scalar maxZ = std::numeric_limits<Scalar>::lowest();
 
     for (const auto& facet : facets_) {
         for (int i = 0; i < 3; ++i) {
@@ -21,22 +31,30 @@ std::vector<float> UniformSlicingAlgorithm::generateSlices() {
         }
     }
 
+    return uniformSlicePlanes(minZ, maxZ, toolLength_);
+}
+
+template <typename Scalar>
+std::vector<Scalar> uniformSlicePlanes(Scalar minZ, Scalar maxZ, Scalar toolLength) {
     // Calculate number of slices (front-to-back)
-    float sliceThickness = toolLength_ * 0.75f;
+    Scalar sliceThickness = toolLength * Scalar(0.75);
     int numSlices = static_cast<int>((maxZ - minZ) / sliceThickness) + 1;
 
     // Generate slice planes from front to back
-    std::vector<float> slices;
+    std::vector<Scalar> slices;
     for (int i = 0; i < numSlices; ++i) {
-        float z = minZ + i * sliceThickness; // Generate slices from min to max Z
+        Scalar z = minZ + i * sliceThickness; // Generate slices from min to max Z
         slices.push_back(z);
     }
 
     return slices;
 }
 
-std::vector<ContourPoint> UniformSlicingAlgorithm::generateContour(float z) {
-    std::vector<ContourPoint> contourPoints;
+template <typename Scalar>
+std::vector<ContourPointT<Scalar>> UniformSlicingAlgorithmT<Scalar>::generateContour(Scalar z) {
+    TRACE_SCOPE("UniformSlicingAlgorithm::generateContour");
+
+    std::vector<ContourPointT<Scalar>> contourPoints;
 
     for (const auto& facet : facets_) {
         // Check if facet intersects with the slice plane at z
@@ -44,13 +62,13 @@ std::vector<ContourPoint> UniformSlicingAlgorithm::generateContour(float z) {
             int j = (i + 1) % 3; // Next vertex index
             if ((facet.vertices[i][2] - z) * (facet.vertices[j][2] - z) < 0) {
                 // Intersection occurs; calculate intersection point
-                float t = (z - facet.vertices[i][2]) / (facet.vertices[j][2] - facet.vertices[i][2]);
-                float x = facet.vertices[i][0] + t * (facet.vertices[j][0] - facet.vertices[i][0]);
-                float y = facet.vertices[i][1] + t * (facet.vertices[j][1] - facet.vertices[i][1]);
+                Scalar t = (z - facet.vertices[i][2]) / (facet.vertices[j][2] - facet.vertices[i][2]);
+                Scalar x = facet.vertices[i][0] + t * (facet.vertices[j][0] - facet.vertices[i][0]);
+                Scalar y = facet.vertices[i][1] + t * (facet.vertices[j][1] - facet.vertices[i][1]);
 
                 // Calculate normal at intersection point
                 // For simplicity, use the facet's normal
-                ContourPoint point;
+                ContourPointT<Scalar> point;
                 point.point[0] = x;
                 point.point[1] = y;
                 point.point[2] = z;
@@ -64,4 +82,9 @@ std::vector<ContourPoint> UniformSlicingAlgorithm::generateContour(float z) {
     }
 
     return contourPoints;
-}
\ No newline at end of file
+}
+
+template class UniformSlicingAlgorithmT<float>;
+template class UniformSlicingAlgorithmT<double>;
+template std::vector<float> uniformSlicePlanes(float, float, float);
+template std::vector<double> uniformSlicePlanes(double, double, double);
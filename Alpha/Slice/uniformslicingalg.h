@@ -4,24 +4,38 @@
 #include <vector>
 #include "stlfileloader.h"
 
-struct ContourPoint {
-    float point[3]; // x, y, z coordinates
-    float normal[3]; // Normal vector at the point
+template <typename Scalar>
+struct ContourPointT {
+    Scalar point[3]; // x, y, z coordinates
+    Scalar normal[3]; // Normal vector at the point
 };
 
-class UniformSlicingAlgorithm {
+using ContourPoint = ContourPointT<float>;
+
+// Instantiated for float and double (see geometry.h)
+template <typename Scalar>
+class UniformSlicingAlgorithmT {
 public:
-    UniformSlicingAlgorithm(const std::vector<Facet>& facets);
-    ~UniformSlicingAlgorithm();
+    UniformSlicingAlgorithmT(const std::vector<FacetT<Scalar>>& facets);
+    ~UniformSlicingAlgorithmT();
 
-    void setToolLength(float toolLength);
-    std::vector<float> generateSlices();
-    std::vector<ContourPoint> generateContour(float z);  
+    void setToolLength(Scalar toolLength);
+    std::vector<Scalar> generateSlices();
+    std::vector<ContourPointT<Scalar>> generateContour(Scalar z);  
 
 
 private:
-    std::vector<Facet> facets_;
-    float toolLength_;
+    std::vector<FacetT<Scalar>> facets_;
+    MemoryTally facetsTally_{"UniformSlicingAlgorithm facets"};
+    Scalar toolLength_;
 };
 
+using UniformSlicingAlgorithm = UniformSlicingAlgorithmT<float>;
+using UniformSlicingAlgorithmD = UniformSlicingAlgorithmT<double>;
+
+// Slice planes from minZ up to maxZ, 0.75 tool lengths apart; what
+// generateSlices returns for a part with these Z bounds
+template <typename Scalar>
+std::vector<Scalar> uniformSlicePlanes(Scalar minZ, Scalar maxZ, Scalar toolLength);
+
 #endif // UNIFORMSLICINGALG_H
@@ -0,0 +1,503 @@
+#include "stocksimulator.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+// Columns per tile side. Tiles are the unit of parallel work.
+constexpr int TILE_SIZE = 32;
+
+// Tool positions are sampled at this fraction of the smaller of the cell
+// size and the tool radius, so consecutive capsules overlap
+constexpr float SAMPLE_FRACTION = 0.5f;
+
+using Interval = StockSimulator::Interval;
+using Column = StockSimulator::Column;
+
+// Tool placed at one position: a capsule from the tip sphere center along
+// the tool axis, with the columns it can reach
+struct StockSimulator::ToolSample {
+    float tip[3];
+    float axis[3];  // Unit length
+    float length;
+    float radius;
+    int minColumnX, minColumnY, maxColumnX, maxColumnY;
+    size_t slice;
+};
+
+// Heights where the vertical line through (x, y) is inside the capsule. The
+// capsule is convex, so the spans of its two end spheres and its cylinder
+// join into one interval.
+bool StockSimulator::capsuleSpan(const ToolSample& tool, float x, float y, float& bottom, float& top) {
+    bottom = std::numeric_limits<float>::max();
+    top = -std::numeric_limits<float>::max();
+    float r2 = tool.radius * tool.radius;
+
+    // End spheres
+    for (float s : {0.0f, tool.length}) {
+        float cx = tool.tip[0] + s * tool.axis[0];
+        float cy = tool.tip[1] + s * tool.axis[1];
+        float cz = tool.tip[2] + s * tool.axis[2];
+        float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        if (d2 <= r2) {
+            float h = std::sqrt(r2 - d2);
+            bottom = std::min(bottom, cz - h);
+            top = std::max(top, cz + h);
+        }
+    }
+
+    // Cylinder: points at height tip.z + t whose distance to the axis is at
+    // most the radius and whose projection onto the axis is in [0, length]
+    float qx = x - tool.tip[0];
+    float qy = y - tool.tip[1];
+    float uz = tool.axis[2];
+    float qu = qx * tool.axis[0] + qy * tool.axis[1];  // Projection at t = 0
+    float a = 1.0f - uz * uz;
+    float b = -2.0f * qu * uz;
+    float c = qx * qx + qy * qy - qu * qu - r2;
+
+    float t0 = -std::numeric_limits<float>::max();
+    float t1 = std::numeric_limits<float>::max();
+    if (a < 1.0e-6f) {
+        if (c > 0.0f) {
+            return bottom <= top;  // Vertical axis out of reach
+        }
+    }
+    else {
+        float discriminant = b * b - 4.0f * a * c;
+        if (discriminant < 0.0f) {
+            return bottom <= top;
+        }
+        float root = std::sqrt(discriminant);
+        t0 = (-b - root) / (2.0f * a);
+        t1 = (-b + root) / (2.0f * a);
+    }
+
+    // Projection onto the axis is qu + t * uz
+    if (std::abs(uz) > 1.0e-6f) {
+        float s0 = -qu / uz;
+        float s1 = (tool.length - qu) / uz;
+        t0 = std::max(t0, std::min(s0, s1));
+        t1 = std::min(t1, std::max(s0, s1));
+    }
+    else if (qu < 0.0f || qu > tool.length) {
+        return bottom <= top;
+    }
+
+    if (t0 <= t1) {
+        bottom = std::min(bottom, tool.tip[2] + t0);
+        top = std::max(top, tool.tip[2] + t1);
+    }
+    return bottom <= top;
+}
+
+// Remove [bottom, top] from a column and return the removed length
+static float subtractSpan(Column& column, float bottom, float top) {
+    bool overlaps = false;
+    for (const auto& interval : column) {
+        if (interval.top > bottom && interval.bottom < top) {
+            overlaps = true;
+            break;
+        }
+    }
+    if (!overlaps) {
+        return 0.0f;
+    }
+
+    float removed = 0.0f;
+    Column remaining;
+    remaining.reserve(column.size() + 1);
+    for (const auto& interval : column) {
+        if (interval.top <= bottom || interval.bottom >= top) {
+            remaining.push_back(interval);
+            continue;
+        }
+        removed += std::min(interval.top, top) - std::max(interval.bottom, bottom);
+        if (interval.bottom < bottom) {
+            remaining.push_back({interval.bottom, bottom});
+        }
+        if (interval.top > top) {
+            remaining.push_back({top, interval.top});
+        }
+    }
+    column.swap(remaining);
+    return removed;
+}
+
+static float columnLength(const Column& column) {
+    float length = 0.0f;
+    for (const auto& interval : column) {
+        length += interval.top - interval.bottom;
+    }
+    return length;
+}
+
+StockSimulator::StockSimulator(const std::vector<Facet>& part, const StockOptions& options)
+    : options_(options), originX_(0.0f), originY_(0.0f), columnsX_(0), columnsY_(0) {
+    TRACE_SCOPE("StockSimulator::StockSimulator");
+    if (part.empty() || options_.cellSize <= 0.0f) {
+        return;
+    }
+
+    float minBound[3], maxBound[3];
+    for (int k = 0; k < 3; ++k) {
+        minBound[k] = maxBound[k] = part[0].vertices[0][k];
+    }
+    for (const auto& facet : part) {
+        for (int i = 0; i < 3; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                minBound[k] = std::min(minBound[k], facet.vertices[i][k]);
+                maxBound[k] = std::max(maxBound[k], facet.vertices[i][k]);
+            }
+        }
+    }
+
+    float margin = std::max(0.0f, options_.margin);
+    originX_ = minBound[0] - margin;
+    originY_ = minBound[1] - margin;
+    columnsX_ = std::max(1, static_cast<int>(std::ceil((maxBound[0] - minBound[0] + 2.0f * margin) / options_.cellSize)));
+    columnsY_ = std::max(1, static_cast<int>(std::ceil((maxBound[1] - minBound[1] + 2.0f * margin) / options_.cellSize)));
+
+    size_t numColumns = static_cast<size_t>(columnsX_) * columnsY_;
+    stock_.assign(numColumns, Column{{minBound[2] - margin, maxBound[2] + margin}});
+    part_.resize(numColumns);
+    rasterizePart(part);
+}
+
+// Cast a ray up each column through the part. Facets facing down enter the
+// part and facets facing up leave it. A column through an edge is reported
+// by both facets sharing it; the repeat is dropped.
+void StockSimulator::rasterizePart(const std::vector<Facet>& part) {
+    TRACE_SCOPE("StockSimulator::rasterizePart");
+    struct Hit {
+        float z;
+        int winding;
+    };
+    std::vector<std::vector<Hit>> hits(part_.size());
+    float cell = options_.cellSize;
+
+    for (const auto& facet : part) {
+        const float* v0 = facet.vertices[0];
+        const float* v1 = facet.vertices[1];
+        const float* v2 = facet.vertices[2];
+        float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+        if (std::abs(area) < 1.0e-12f) {
+            continue;  // Vertical facets are never crossed by a column
+        }
+        int winding = area > 0.0f ? -1 : 1;
+
+        float minX = std::min({v0[0], v1[0], v2[0]});
+        float maxX = std::max({v0[0], v1[0], v2[0]});
+        float minY = std::min({v0[1], v1[1], v2[1]});
+        float maxY = std::max({v0[1], v1[1], v2[1]});
+        int i0 = std::max(0, static_cast<int>(std::ceil((minX - originX_) / cell - 0.5f)));
+        int i1 = std::min(columnsX_ - 1, static_cast<int>(std::floor((maxX - originX_) / cell - 0.5f)));
+        int j0 = std::max(0, static_cast<int>(std::ceil((minY - originY_) / cell - 0.5f)));
+        int j1 = std::min(columnsY_ - 1, static_cast<int>(std::floor((maxY - originY_) / cell - 0.5f)));
+
+        for (int j = j0; j <= j1; ++j) {
+            float y = originY_ + (j + 0.5f) * cell;
+            for (int i = i0; i <= i1; ++i) {
+                float x = originX_ + (i + 0.5f) * cell;
+
+                // Barycentric coordinates, edges included
+                float w1 = ((x - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (y - v0[1])) / area;
+                float w2 = ((v1[0] - v0[0]) * (y - v0[1]) - (x - v0[0]) * (v1[1] - v0[1])) / area;
+                float w0 = 1.0f - w1 - w2;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                    continue;
+                }
+                float z = w0 * v0[2] + w1 * v1[2] + w2 * v2[2];
+                hits[static_cast<size_t>(j) * columnsX_ + i].push_back({z, winding});
+            }
+        }
+    }
+
+    for (size_t c = 0; c < hits.size(); ++c) {
+        auto& columnHits = hits[c];
+        std::sort(columnHits.begin(), columnHits.end(), [](const Hit& a, const Hit& b) { return a.z < b.z; });
+        int inside = 0;
+        float bottom = 0.0f;
+        for (size_t h = 0; h < columnHits.size(); ++h) {
+            const Hit& hit = columnHits[h];
+            const float tolerance = 1.0e-5f * (1.0f + std::abs(hit.z));
+            if (h > 0 && columnHits[h - 1].winding == hit.winding && hit.z - columnHits[h - 1].z < tolerance) {
+                continue;  // Same crossing reported by two facets sharing an edge
+            }
+            int before = inside;
+            inside = std::max(0, inside + hit.winding);
+            if (before == 0 && inside > 0) {
+                bottom = hit.z;
+            }
+            else if (before > 0 && inside == 0 && hit.z > bottom) {
+                part_[c].push_back({bottom, hit.z});
+            }
+        }
+    }
+}
+
+std::vector<StockSimulator::ToolSample> StockSimulator::sampleTool(const std::vector<std::vector<PathPoint>>& slicePaths,
+                                                                   const ToolModel& tool) const {
+    TRACE_SCOPE("StockSimulator::sampleTool");
+    std::vector<ToolSample> samples;
+    if (columnsX_ == 0 || tool.radius <= 0.0f) {
+        return samples;
+    }
+    float spacing = SAMPLE_FRACTION * std::min(options_.cellSize, tool.radius);
+    float cell = options_.cellSize;
+
+    auto addSample = [&](size_t slice, const float p[3], const float n[3]) {
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length < 1.0e-6f) {
+            return;  // No tool axis at this point
+        }
+        ToolSample sample;
+        for (int k = 0; k < 3; ++k) {
+            sample.axis[k] = n[k] / length;
+            sample.tip[k] = p[k] + sample.axis[k] * tool.radius;
+        }
+        sample.length = tool.length;
+        sample.radius = tool.radius;
+        sample.slice = slice;
+
+        float endX = sample.tip[0] + sample.axis[0] * tool.length;
+        float endY = sample.tip[1] + sample.axis[1] * tool.length;
+        float minX = std::min(sample.tip[0], endX) - tool.radius;
+        float maxX = std::max(sample.tip[0], endX) + tool.radius;
+        float minY = std::min(sample.tip[1], endY) - tool.radius;
+        float maxY = std::max(sample.tip[1], endY) + tool.radius;
+        sample.minColumnX = std::max(0, static_cast<int>(std::floor((minX - originX_) / cell)));
+        sample.maxColumnX = std::min(columnsX_ - 1, static_cast<int>(std::floor((maxX - originX_) / cell)));
+        sample.minColumnY = std::max(0, static_cast<int>(std::floor((minY - originY_) / cell)));
+        sample.maxColumnY = std::min(columnsY_ - 1, static_cast<int>(std::floor((maxY - originY_) / cell)));
+        samples.push_back(sample);
+    };
+
+    for (size_t slice = 0; slice < slicePaths.size(); ++slice) {
+        const auto& path = slicePaths[slice];
+        for (size_t i = 0; i < path.size(); ++i) {
+            const PathPoint& a = path[i];
+            float pa[3] = {a.x, a.y, a.z};
+            float na[3] = {a.nx, a.ny, a.nz};
+            if (i + 1 == path.size()) {
+                addSample(slice, pa, na);
+                break;
+            }
+
+            // Interpolate between this point and the next
+            const PathPoint& b = path[i + 1];
+            float dx = b.x - a.x, dy = b.y - a.y, dz = b.z - a.z;
+            int steps = std::max(1, static_cast<int>(std::ceil(std::sqrt(dx * dx + dy * dy + dz * dz) / spacing)));
+            for (int s = 0; s < steps; ++s) {
+                float t = static_cast<float>(s) / steps;
+                float p[3] = {a.x + t * dx, a.y + t * dy, a.z + t * dz};
+                float n[3] = {a.nx + t * (b.nx - a.nx), a.ny + t * (b.ny - a.ny), a.nz + t * (b.nz - a.nz)};
+                addSample(slice, p, n);
+            }
+        }
+    }
+    return samples;
+}
+
+std::vector<SliceRemoval> StockSimulator::sweep(const std::vector<std::vector<PathPoint>>& slicePaths,
+                                                const ToolModel& tool, std::vector<Column>* target) const {
+    TRACE_SCOPE("StockSimulator::sweep");
+    std::vector<SliceRemoval> removals(slicePaths.size(), SliceRemoval{0.0, 0, 0});
+    std::vector<ToolSample> samples = sampleTool(slicePaths, tool);
+    for (const auto& sample : samples) {
+        removals[sample.slice].toolPositions++;
+    }
+    if (samples.empty()) {
+        return removals;
+    }
+
+    // Hand every sample to the tiles it reaches, keeping path order
+    int tilesX = (columnsX_ + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (columnsY_ + TILE_SIZE - 1) / TILE_SIZE;
+    std::vector<std::vector<uint32_t>> tileSamples(static_cast<size_t>(tilesX) * tilesY);
+    for (size_t s = 0; s < samples.size(); ++s) {
+        const ToolSample& sample = samples[s];
+        for (int ty = sample.minColumnY / TILE_SIZE; ty <= sample.maxColumnY / TILE_SIZE; ++ty) {
+            for (int tx = sample.minColumnX / TILE_SIZE; tx <= sample.maxColumnX / TILE_SIZE; ++tx) {
+                tileSamples[static_cast<size_t>(ty) * tilesX + tx].push_back(static_cast<uint32_t>(s));
+            }
+        }
+    }
+
+    // Each tile runs the whole sweep over its own columns. Results go to
+    // per-tile lists and are merged afterwards.
+    struct TileResult {
+        std::vector<std::pair<size_t, double>> sliceVolumes;
+        std::vector<uint32_t> cuttingSamples;
+    };
+    std::vector<TileResult> tileResults(tileSamples.size());
+    float cell = options_.cellSize;
+    double cellArea = static_cast<double>(cell) * cell;
+
+    parallelFor(tileSamples.size(), options_.numThreads, [&](size_t tile) {
+        const auto& tileList = tileSamples[tile];
+        if (tileList.empty()) {
+            return;
+        }
+        int tileX = static_cast<int>(tile % tilesX) * TILE_SIZE;
+        int tileY = static_cast<int>(tile / tilesX) * TILE_SIZE;
+        TileResult& result = tileResults[tile];
+        std::unordered_map<size_t, Column> scratch;  // Columns changed by a dry run
+
+        for (uint32_t s : tileList) {
+            const ToolSample& sample = samples[s];
+            int i0 = std::max(sample.minColumnX, tileX);
+            int i1 = std::min(sample.maxColumnX, tileX + TILE_SIZE - 1);
+            int j0 = std::max(sample.minColumnY, tileY);
+            int j1 = std::min(sample.maxColumnY, tileY + TILE_SIZE - 1);
+
+            float removed = 0.0f;
+            for (int j = j0; j <= j1; ++j) {
+                float y = originY_ + (j + 0.5f) * cell;
+                for (int i = i0; i <= i1; ++i) {
+                    float bottom, top;
+                    if (!capsuleSpan(sample, originX_ + (i + 0.5f) * cell, y, bottom, top)) {
+                        continue;
+                    }
+                    size_t c = static_cast<size_t>(j) * columnsX_ + i;
+                    if (target) {
+                        removed += subtractSpan((*target)[c], bottom, top);
+                    }
+                    else {
+                        auto it = scratch.find(c);
+                        if (it == scratch.end()) {
+                            it = scratch.emplace(c, stock_[c]).first;
+                        }
+                        removed += subtractSpan(it->second, bottom, top);
+                    }
+                }
+            }
+
+            if (removed > 0.0f) {
+                if (result.sliceVolumes.empty() || result.sliceVolumes.back().first != sample.slice) {
+                    result.sliceVolumes.emplace_back(sample.slice, 0.0);
+                }
+                result.sliceVolumes.back().second += removed * cellArea;
+                result.cuttingSamples.push_back(s);
+            }
+        }
+    });
+
+    // A sample can cut in several tiles; count it once
+    std::vector<char> cutting(samples.size(), 0);
+    for (const auto& result : tileResults) {
+        for (const auto& sliceVolume : result.sliceVolumes) {
+            removals[sliceVolume.first].removedVolume += sliceVolume.second;
+        }
+        for (uint32_t s : result.cuttingSamples) {
+            cutting[s] = 1;
+        }
+    }
+    for (size_t s = 0; s < samples.size(); ++s) {
+        removals[samples[s].slice].cuttingPositions += cutting[s];
+    }
+    return removals;
+}
+
+std::vector<SliceRemoval> StockSimulator::cut(const std::vector<std::vector<PathPoint>>& slicePaths, const ToolModel& tool) {
+    return sweep(slicePaths, tool, &stock_);
+}
+
+std::vector<SliceRemoval> StockSimulator::measure(const std::vector<std::vector<PathPoint>>& slicePaths,
+                                                  const ToolModel& tool) const {
+    return sweep(slicePaths, tool, nullptr);
+}
+
+double StockSimulator::getStockVolume() const {
+    double length = 0.0;
+    for (const auto& column : stock_) {
+        length += columnLength(column);
+    }
+    return length * options_.cellSize * options_.cellSize;
+}
+
+double StockSimulator::getPartVolume() const {
+    double length = 0.0;
+    for (const auto& column : part_) {
+        length += columnLength(column);
+    }
+    return length * options_.cellSize * options_.cellSize;
+}
+
+// Material of a column that lies outside the part
+Column StockSimulator::restOf(size_t column) const {
+    Column rest = stock_[column];
+    for (const auto& interval : part_[column]) {
+        subtractSpan(rest, interval.bottom, interval.top);
+    }
+    return rest;
+}
+
+double StockSimulator::getRestVolume() const {
+    double length = 0.0;
+    for (size_t c = 0; c < stock_.size(); ++c) {
+        length += columnLength(restOf(c));
+    }
+    return length * options_.cellSize * options_.cellSize;
+}
+
+std::vector<StockRegion> StockSimulator::findRestMaterial(float minThickness) const {
+    TRACE_SCOPE("StockSimulator::findRestMaterial");
+    std::vector<Column> rest(stock_.size());
+    std::vector<char> filled(stock_.size(), 0);
+    for (size_t c = 0; c < stock_.size(); ++c) {
+        rest[c] = restOf(c);
+        filled[c] = columnLength(rest[c]) > minThickness ? 1 : 0;
+    }
+
+    // Flood fill over 4-connected columns
+    std::vector<StockRegion> regions;
+    std::vector<size_t> stack;
+    float cell = options_.cellSize;
+    for (size_t seed = 0; seed < filled.size(); ++seed) {
+        if (!filled[seed]) {
+            continue;
+        }
+        StockRegion region = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                              std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(),
+                              -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), 0.0, 0};
+        filled[seed] = 0;
+        stack.push_back(seed);
+        while (!stack.empty()) {
+            size_t c = stack.back();
+            stack.pop_back();
+            int i = static_cast<int>(c % columnsX_);
+            int j = static_cast<int>(c / columnsX_);
+            region.minX = std::min(region.minX, originX_ + i * cell);
+            region.maxX = std::max(region.maxX, originX_ + (i + 1) * cell);
+            region.minY = std::min(region.minY, originY_ + j * cell);
+            region.maxY = std::max(region.maxY, originY_ + (j + 1) * cell);
+            region.minZ = std::min(region.minZ, rest[c].front().bottom);
+            region.maxZ = std::max(region.maxZ, rest[c].back().top);
+            region.volume += static_cast<double>(columnLength(rest[c])) * cell * cell;
+            region.columns++;
+
+            const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (const auto& offset : offsets) {
+                int ni = i + offset[0];
+                int nj = j + offset[1];
+                if (ni < 0 || nj < 0 || ni >= columnsX_ || nj >= columnsY_) {
+                    continue;
+                }
+                size_t n = static_cast<size_t>(nj) * columnsX_ + ni;
+                if (filled[n]) {
+                    filled[n] = 0;
+                    stack.push_back(n);
+                }
+            }
+        }
+        regions.push_back(region);
+    }
+
+    std::sort(regions.begin(), regions.end(),
+              [](const StockRegion& a, const StockRegion& b) { return a.volume > b.volume; });
+    return regions;
+}
@@ -0,0 +1,84 @@
+#ifndef STOCKSIMULATOR_H
+#define STOCKSIMULATOR_H
+
+#include <vector>
+#include <cstddef>
+#include "stlfileloader.h"
+#include "pathplanner.h"
+#include "gougecheck.h"
+
+struct StockOptions {
+    float cellSize;       // Dexel spacing in X and Y
+    float margin;         // Stock allowance added around the part's bounds
+    unsigned numThreads;  // Threads for tile updates (0 = hardware concurrency)
+};
+
+// Material removed by one slice pass
+struct SliceRemoval {
+    double removedVolume;
+    size_t toolPositions;     // Tool positions sampled along the pass
+    size_t cuttingPositions;  // Positions that removed material; the rest cut air
+};
+
+// Connected patch of material left outside the part
+struct StockRegion {
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+    double volume;
+    size_t columns;
+};
+
+// Dexel model of the stock: a grid of columns along Z, each holding the
+// intervals still filled with material. Starts as the part's bounding box
+// plus a margin and is cut by sweeping the ball-end tool (ToolModel, a
+// capsule along the point normal) along the planned passes. The part is
+// rasterized into the same columns so the material left outside it can be
+// reported.
+class StockSimulator {
+public:
+    StockSimulator(const std::vector<Facet>& part, const StockOptions& options);
+
+    // Sweep the tool along each slice pass in order and remove what it
+    // reaches. Grid tiles are updated in parallel; each tile runs through
+    // every pass, so the per-pass volumes are independent of the thread count.
+    std::vector<SliceRemoval> cut(const std::vector<std::vector<PathPoint>>& slicePaths, const ToolModel& tool);
+
+    // What cut() would remove, leaving the stock unchanged. Passes with no
+    // removed volume only cut air and can be skipped.
+    std::vector<SliceRemoval> measure(const std::vector<std::vector<PathPoint>>& slicePaths, const ToolModel& tool) const;
+
+    double getStockVolume() const;  // Material left, part included
+    double getPartVolume() const;
+    double getRestVolume() const;   // Material left outside the part
+
+    // Patches of rest material, joining neighbouring columns with more than
+    // minThickness of material outside the part
+    std::vector<StockRegion> findRestMaterial(float minThickness) const;
+
+    int getColumnsX() const { return columnsX_; }
+    int getColumnsY() const { return columnsY_; }
+
+    struct Interval {
+        float bottom, top;
+    };
+    using Column = std::vector<Interval>;
+
+private:
+    struct ToolSample;
+    static bool capsuleSpan(const ToolSample& tool, float x, float y, float& bottom, float& top);
+
+    std::vector<ToolSample> sampleTool(const std::vector<std::vector<PathPoint>>& slicePaths,
+                                       const ToolModel& tool) const;
+    std::vector<SliceRemoval> sweep(const std::vector<std::vector<PathPoint>>& slicePaths,
+                                    const ToolModel& tool, std::vector<Column>* target) const;
+    void rasterizePart(const std::vector<Facet>& part);
+    Column restOf(size_t column) const;
+
+    StockOptions options_;
+    float originX_, originY_;  // Corner of the grid; column (i, j) is centered at origin + (i + 0.5) * cellSize
+    int columnsX_, columnsY_;
+    std::vector<Column> stock_;
+    std::vector<Column> part_;
+};
+
+#endif // STOCKSIMULATOR_H
@@ -0,0 +1,23 @@
+#include "meshgenerator.h"
+#include <iostream>
+#include <cstdlib>
+
+// Write a synthetic test mesh as binary STL
+// Usage: meshgen <sphere|torus|terrain|vase|lattice> <facets> <output.stl>
+int main(int argc, char* argv[]) {
+    MeshShape shape;
+    if (argc < 4 || !parseMeshShape(argv[1], shape)) {
+        std::cout << "Usage: meshgen <sphere|torus|terrain|vase|lattice> <facets> <output.stl>" << std::endl;
+        return 1;
+    }
+
+    size_t numFacets = static_cast<size_t>(std::strtoull(argv[2], nullptr, 10));
+    std::vector<Facet> facets = generateMesh(shape, numFacets);
+    if (!writeBinarySTL(argv[3], facets)) {
+        std::cerr << "Failed to write " << argv[3] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << facets.size() << " facet " << meshShapeName(shape) << " to " << argv[3] << std::endl;
+    return 0;
+}
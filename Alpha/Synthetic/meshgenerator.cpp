@@ -0,0 +1,347 @@
+#include "meshgenerator.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+constexpr float PI = 3.14159265f;
+
+// Indexed vertices and the facets built from them. Every vertex is computed
+// once, so facets sharing it get exactly the same coordinates.
+struct MeshBuilder {
+    std::vector<std::array<float, 3>> points;
+    std::vector<Facet> facets;
+
+    int addVertex(float x, float y, float z) {
+        points.push_back({x, y, z});
+        return static_cast<int>(points.size()) - 1;
+    }
+
+    // Counter-clockwise seen from outside
+    void addTriangle(int a, int b, int c) {
+        Facet facet;
+        const int index[3] = {a, b, c};
+        for (int i = 0; i < 3; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                facet.vertices[i][k] = points[index[i]][k];
+            }
+        }
+        float e1[3], e2[3];
+        for (int k = 0; k < 3; ++k) {
+            e1[k] = facet.vertices[1][k] - facet.vertices[0][k];
+            e2[k] = facet.vertices[2][k] - facet.vertices[0][k];
+        }
+        float n[3] = {
+            e1[1] * e2[2] - e1[2] * e2[1],
+            e1[2] * e2[0] - e1[0] * e2[2],
+            e1[0] * e2[1] - e1[1] * e2[0]
+        };
+        float length = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        for (int k = 0; k < 3; ++k) {
+            facet.normal[k] = (length > 0.0f) ? n[k] / length : 0.0f;
+        }
+        facets.push_back(facet);
+    }
+
+    // Quad a-b-c-d, counter-clockwise seen from outside
+    void addQuad(int a, int b, int c, int d) {
+        addTriangle(a, b, c);
+        addTriangle(a, c, d);
+    }
+
+    // Band between two rings of equal size running counter-clockwise seen from
+    // above; the outside is to the right of the ring direction when the upper
+    // ring is above the lower one
+    void addBand(const std::vector<int>& lower, const std::vector<int>& upper) {
+        size_t n = lower.size();
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = (i + 1) % n;
+            addQuad(lower[i], lower[j], upper[j], upper[i]);
+        }
+    }
+
+    // Fan from a center vertex to a closed ring; faces up if the ring runs
+    // counter-clockwise seen from above, down otherwise
+    void addFan(int center, const std::vector<int>& ring, bool up) {
+        size_t n = ring.size();
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = (i + 1) % n;
+            if (up) {
+                addTriangle(center, ring[i], ring[j]);
+            }
+            else {
+                addTriangle(center, ring[j], ring[i]);
+            }
+        }
+    }
+};
+
+// Resolution n with a * n * n + b * n closest to numFacets
+static int resolution(size_t numFacets, double a, double b, int minimum) {
+    double n = (-b + std::sqrt(b * b + 4.0 * a * static_cast<double>(numFacets))) / (2.0 * a);
+    return std::max(minimum, static_cast<int>(std::lround(n)));
+}
+
+std::vector<Facet> generateSphere(size_t numFacets, float radius) {
+    // (2 * rings - 2) * segments facets with segments close to 2 * rings
+    int rings = resolution(numFacets, 4.0, -4.0, 2);
+    int segments = std::max(3, static_cast<int>(std::lround(numFacets / (2.0 * rings - 2.0))));
+
+    MeshBuilder mesh;
+    mesh.points.reserve(static_cast<size_t>(rings - 1) * segments + 2);
+    mesh.facets.reserve(static_cast<size_t>(2 * rings - 2) * segments);
+
+    int bottom = mesh.addVertex(0.0f, 0.0f, -radius);
+    std::vector<std::vector<int>> ringVertices(rings - 1, std::vector<int>(segments));
+    for (int r = 1; r < rings; ++r) {
+        float theta = PI * r / rings;
+        for (int s = 0; s < segments; ++s) {
+            float phi = 2.0f * PI * s / segments;
+            ringVertices[r - 1][s] = mesh.addVertex(radius * std::sin(theta) * std::cos(phi),
+                                                    radius * std::sin(theta) * std::sin(phi),
+                                                    -radius * std::cos(theta));
+        }
+    }
+    int top = mesh.addVertex(0.0f, 0.0f, radius);
+
+    mesh.addFan(bottom, ringVertices.front(), false);
+    for (int r = 0; r + 1 < rings - 1; ++r) {
+        mesh.addBand(ringVertices[r], ringVertices[r + 1]);
+    }
+    mesh.addFan(top, ringVertices.back(), true);
+
+    return mesh.facets;
+}
+
+std::vector<Facet> generateTorus(size_t numFacets, float majorRadius, float minorRadius) {
+    // 2 * rings * segments facets with segments around the Z axis close to 3 * rings
+    int rings = resolution(numFacets, 6.0, 0.0, 3);
+    int segments = std::max(3, static_cast<int>(std::lround(numFacets / (2.0 * rings))));
+
+    MeshBuilder mesh;
+    mesh.points.reserve(static_cast<size_t>(rings) * segments);
+    mesh.facets.reserve(static_cast<size_t>(2) * rings * segments);
+
+    // Ring r is the circle at angle v around the tube, rising with r on the outside
+    std::vector<std::vector<int>> ringVertices(rings, std::vector<int>(segments));
+    for (int r = 0; r < rings; ++r) {
+        float v = 2.0f * PI * r / rings;
+        float distance = majorRadius + minorRadius * std::cos(v);
+        for (int s = 0; s < segments; ++s) {
+            float u = 2.0f * PI * s / segments;
+            ringVertices[r][s] = mesh.addVertex(distance * std::cos(u), distance * std::sin(u),
+                                                minorRadius * std::sin(v));
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        mesh.addBand(ringVertices[r], ringVertices[(r + 1) % rings]);
+    }
+
+    return mesh.facets;
+}
+
+std::vector<Facet> generateTerrain(size_t numFacets, float size, float height, unsigned seed) {
+    // 2 * grid^2 top facets, 8 * grid wall facets and 4 * grid base facets
+    int grid = resolution(numFacets, 2.0, 12.0, 1);
+    float cell = size / grid;
+
+    // Height field: a few random sine waves plus per-vertex jitter
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    struct Wave { float fx, fy, phase, amplitude; };
+    std::vector<Wave> waves;
+    for (int i = 0; i < 6; ++i) {
+        float frequency = 2.0f * PI * (1 << i) / size;
+        float angle = 2.0f * PI * uniform(random);
+        waves.push_back({frequency * std::cos(angle), frequency * std::sin(angle),
+                         2.0f * PI * uniform(random), 0.25f / (1 << i)});
+    }
+
+    MeshBuilder mesh;
+    mesh.points.reserve(static_cast<size_t>(grid + 1) * (grid + 1) + 4 * grid + 1);
+    mesh.facets.reserve(static_cast<size_t>(2) * grid * grid + 12 * grid);
+
+    std::vector<int> surface(static_cast<size_t>(grid + 1) * (grid + 1));
+    auto surfaceAt = [&](int i, int j) -> int& { return surface[static_cast<size_t>(j) * (grid + 1) + i]; };
+    for (int j = 0; j <= grid; ++j) {
+        for (int i = 0; i <= grid; ++i) {
+            float x = i * cell;
+            float y = j * cell;
+            float h = 0.5f + 0.1f * (uniform(random) - 0.5f);
+            for (const auto& wave : waves) {
+                h += wave.amplitude * std::sin(wave.fx * x + wave.fy * y + wave.phase);
+            }
+            surfaceAt(i, j) = mesh.addVertex(x, y, height * std::max(0.05f, h));
+        }
+    }
+    for (int j = 0; j < grid; ++j) {
+        for (int i = 0; i < grid; ++i) {
+            mesh.addQuad(surfaceAt(i, j), surfaceAt(i + 1, j), surfaceAt(i + 1, j + 1), surfaceAt(i, j + 1));
+        }
+    }
+
+    // Boundary of the surface counter-clockwise seen from above, walls down to z = 0
+    std::vector<int> edge;
+    for (int i = 0; i < grid; ++i) edge.push_back(surfaceAt(i, 0));
+    for (int j = 0; j < grid; ++j) edge.push_back(surfaceAt(grid, j));
+    for (int i = grid; i > 0; --i) edge.push_back(surfaceAt(i, grid));
+    for (int j = grid; j > 0; --j) edge.push_back(surfaceAt(0, j));
+
+    std::vector<int> base;
+    for (int index : edge) {
+        const auto& p = mesh.points[index];
+        base.push_back(mesh.addVertex(p[0], p[1], 0.0f));
+    }
+    mesh.addBand(base, edge);
+    mesh.addFan(mesh.addVertex(0.5f * size, 0.5f * size, 0.0f), base, false);
+
+    return mesh.facets;
+}
+
+std::vector<Facet> generateVase(size_t numFacets, float height, float radius, float wallThickness) {
+    // Outer and inner walls of 2 * rings * segments facets each, plus the
+    // rim and the two bottom fans; segments close to 2 * rings
+    int rings = resolution(numFacets, 8.0, 8.0, 2);
+    int segments = std::max(3, static_cast<int>(std::lround(numFacets / (4.0 * rings + 4.0))));
+    float floorHeight = wallThickness;
+
+    // Bulging profile, never thinner than half the radius
+    auto profile = [&](float z) {
+        return radius * (0.75f + 0.25f * std::sin(1.5f * PI * z / height));
+    };
+
+    MeshBuilder mesh;
+    mesh.points.reserve(static_cast<size_t>(2) * (rings + 1) * segments + 2);
+    mesh.facets.reserve(static_cast<size_t>(4) * (rings + 1) * segments);
+
+    auto addRing = [&](float z, float ringRadius) {
+        std::vector<int> ring(segments);
+        for (int s = 0; s < segments; ++s) {
+            float phi = 2.0f * PI * s / segments;
+            ring[s] = mesh.addVertex(ringRadius * std::cos(phi), ringRadius * std::sin(phi), z);
+        }
+        return ring;
+    };
+
+    std::vector<std::vector<int>> outer, inner;
+    for (int r = 0; r <= rings; ++r) {
+        float z = height * r / rings;
+        outer.push_back(addRing(z, profile(z)));
+        float zInner = floorHeight + (height - floorHeight) * r / rings;
+        inner.push_back(addRing(zInner, profile(zInner) - wallThickness));
+    }
+
+    for (int r = 0; r < rings; ++r) {
+        mesh.addBand(outer[r], outer[r + 1]);
+        mesh.addBand(inner[r + 1], inner[r]);  // Faces the axis
+    }
+    mesh.addBand(outer[rings], inner[rings]);  // Rim, faces up
+    mesh.addFan(mesh.addVertex(0.0f, 0.0f, 0.0f), outer[0], false);
+    mesh.addFan(mesh.addVertex(0.0f, 0.0f, floorHeight), inner[0], true);
+
+    return mesh.facets;
+}
+
+std::vector<Facet> generateLattice(size_t numFacets, float size, unsigned seed) {
+    // 12 facets per pillar, count x count pillars
+    int count = resolution(numFacets, 12.0, 0.0, 1);
+    float pitch = size / count;
+    float width = 0.6f * pitch;
+
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0.5f, 1.0f);
+
+    MeshBuilder mesh;
+    mesh.points.reserve(static_cast<size_t>(8) * count * count);
+    mesh.facets.reserve(static_cast<size_t>(12) * count * count);
+
+    for (int j = 0; j < count; ++j) {
+        for (int i = 0; i < count; ++i) {
+            float x = i * pitch + 0.2f * pitch;
+            float y = j * pitch + 0.2f * pitch;
+            float top = size * uniform(random);
+            std::vector<int> lower = {
+                mesh.addVertex(x, y, 0.0f), mesh.addVertex(x + width, y, 0.0f),
+                mesh.addVertex(x + width, y + width, 0.0f), mesh.addVertex(x, y + width, 0.0f)
+            };
+            std::vector<int> upper;
+            for (int index : lower) {
+                const auto& p = mesh.points[index];
+                upper.push_back(mesh.addVertex(p[0], p[1], top));
+            }
+            mesh.addBand(lower, upper);
+            mesh.addQuad(lower[0], lower[3], lower[2], lower[1]);
+            mesh.addQuad(upper[0], upper[1], upper[2], upper[3]);
+        }
+    }
+
+    return mesh.facets;
+}
+
+std::vector<Facet> generateMesh(MeshShape shape, size_t numFacets) {
+    switch (shape) {
+    case MeshShape::Sphere:  return generateSphere(numFacets);
+    case MeshShape::Torus:   return generateTorus(numFacets);
+    case MeshShape::Terrain: return generateTerrain(numFacets);
+    case MeshShape::Vase:    return generateVase(numFacets);
+    case MeshShape::Lattice: return generateLattice(numFacets);
+    }
+    return std::vector<Facet>();
+}
+
+static const MeshShape ALL_SHAPES[] = {
+    MeshShape::Sphere, MeshShape::Torus, MeshShape::Terrain, MeshShape::Vase, MeshShape::Lattice
+};
+
+const char* meshShapeName(MeshShape shape) {
+    switch (shape) {
+    case MeshShape::Sphere:  return "sphere";
+    case MeshShape::Torus:   return "torus";
+    case MeshShape::Terrain: return "terrain";
+    case MeshShape::Vase:    return "vase";
+    case MeshShape::Lattice: return "lattice";
+    }
+    return "";
+}
+
+bool parseMeshShape(const std::string& name, MeshShape& shape) {
+    for (MeshShape candidate : ALL_SHAPES) {
+        if (name == meshShapeName(candidate)) {
+            shape = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool writeBinarySTL(const std::string& filename, const std::vector<Facet>& facets) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    char header[80] = "Synthetic mesh";
+    file.write(header, 80);
+    uint32_t numFacets = static_cast<uint32_t>(facets.size());
+    file.write(reinterpret_cast<const char*>(&numFacets), 4);
+
+    // Facets go out in large chunks of 50-byte records
+    constexpr size_t RECORD_SIZE = 50;
+    constexpr size_t CHUNK_FACETS = 1 << 14;
+    std::vector<char> buffer(CHUNK_FACETS * RECORD_SIZE, 0);
+    for (size_t start = 0; start < facets.size(); start += CHUNK_FACETS) {
+        size_t count = std::min(CHUNK_FACETS, facets.size() - start);
+        for (size_t i = 0; i < count; ++i) {
+            char* record = &buffer[i * RECORD_SIZE];
+            const Facet& facet = facets[start + i];
+            std::memcpy(record, facet.normal, 12);
+            std::memcpy(record + 12, facet.vertices, 36);
+        }
+        file.write(buffer.data(), count * RECORD_SIZE);
+    }
+
+    return static_cast<bool>(file);
+}
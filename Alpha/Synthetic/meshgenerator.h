@@ -0,0 +1,37 @@
+#ifndef MESHGENERATOR_H
+#define MESHGENERATOR_H
+
+#include <vector>
+#include <string>
+#include "stlfileloader.h"
+
+// Closed synthetic test meshes with outward facet normals. Each generator
+// picks its resolution so the facet count comes close to numFacets (within
+// a few percent above about 1000 facets); every shared edge uses bit-identical
+// vertices so slices weld into closed contours.
+
+enum class MeshShape {
+    Sphere,    // UV sphere
+    Torus,     // Ring around the Z axis; two contours per slice through the middle
+    Terrain,   // Noisy height field on a square base
+    Vase,      // Thin-walled surface of revolution, open at the top
+    Lattice    // Grid of separate pillars of varying height; many islands per slice
+};
+
+std::vector<Facet> generateSphere(size_t numFacets, float radius = 1.0f);
+std::vector<Facet> generateTorus(size_t numFacets, float majorRadius = 1.0f, float minorRadius = 0.3f);
+std::vector<Facet> generateTerrain(size_t numFacets, float size = 2.0f, float height = 0.5f, unsigned seed = 1);
+std::vector<Facet> generateVase(size_t numFacets, float height = 2.0f, float radius = 0.5f, float wallThickness = 0.02f);
+std::vector<Facet> generateLattice(size_t numFacets, float size = 2.0f, unsigned seed = 1);
+
+// Shape with its default dimensions
+std::vector<Facet> generateMesh(MeshShape shape, size_t numFacets);
+
+// Shape from its lower-case name ("sphere", "torus", ...)
+bool parseMeshShape(const std::string& name, MeshShape& shape);
+const char* meshShapeName(MeshShape shape);
+
+// Write facets as a binary STL file readable by STLFileLoader
+bool writeBinarySTL(const std::string& filename, const std::vector<Facet>& facets);
+
+#endif // MESHGENERATOR_H
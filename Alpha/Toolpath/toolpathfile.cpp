@@ -0,0 +1,371 @@
+#include "toolpathfile.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char TOOLPATH_MAGIC[4] = {'T', 'P', 'T', 'H'};
+constexpr uint32_t TOOLPATH_VERSION = 1;
+constexpr size_t HEADER_SIZE = 40;
+constexpr size_t INDEX_ENTRY_SIZE = 16;
+constexpr size_t MIN_POINT_SIZE = 7;  // Three one-byte varints and a packed normal
+
+// Little-endian helpers
+template <typename T>
+static void putValue(std::vector<uint8_t>& out, T value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static T getValue(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// Largest quantized coordinate written, so deltas between points stay in range
+constexpr double MAX_QUANTIZED = 4611686018427387904.0;  // 2^62
+
+static void putVarint(std::vector<uint8_t>& out, int64_t value) {
+    // Zig-zag so small negative deltas stay short
+    uint64_t v = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, int64_t& value) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        if (p >= end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            value = static_cast<int64_t>((v >> 1) ^ (0ull - (v & 1)));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Octahedral mapping of a unit vector onto two 16-bit values
+static void packNormal(float nx, float ny, float nz, int16_t out[2]) {
+    float sum = std::abs(nx) + std::abs(ny) + std::abs(nz);
+    if (sum < 1.0e-12f) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    float u = nx / sum;
+    float v = ny / sum;
+    if (nz < 0.0f) {
+        float pu = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float pv = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = pu;
+        v = pv;
+    }
+    out[0] = static_cast<int16_t>(std::lround(u * 32767.0f));
+    out[1] = static_cast<int16_t>(std::lround(v * 32767.0f));
+}
+
+static void unpackNormal(const int16_t in[2], float& nx, float& ny, float& nz) {
+    float u = in[0] / 32767.0f;
+    float v = in[1] / 32767.0f;
+    float z = 1.0f - std::abs(u) - std::abs(v);
+    if (z < 0.0f) {
+        float pu = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+        float pv = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+        u = pu;
+        v = pv;
+    }
+    float length = std::sqrt(u * u + v * v + z * z);
+    if (length < 1.0e-12f) {
+        nx = ny = nz = 0.0f;
+        return;
+    }
+    nx = u / length;
+    ny = v / length;
+    nz = z / length;
+}
+
+ToolpathWriter::ToolpathWriter(float quantum) : quantum_(quantum), offset_(0), pointCount_(0), failed_(false) {}
+
+ToolpathWriter::~ToolpathWriter() {
+    if (file_.is_open()) {
+        close();
+    }
+}
+
+bool ToolpathWriter::open(const std::string& filename) {
+    file_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open toolpath file: " << filename << std::endl;
+        return false;
+    }
+
+    // Placeholder header, completed by close()
+    char header[HEADER_SIZE] = {};
+    file_.write(header, HEADER_SIZE);
+    offset_ = HEADER_SIZE;
+    pointCount_ = 0;
+    failed_ = false;
+    index_.clear();
+    return true;
+}
+
+bool ToolpathWriter::writeSlice(const std::vector<PathPoint>& points) {
+    if (points.empty()) {
+        return !failed_;
+    }
+
+    // Positions first, as deltas from the previous quantized point
+    std::vector<uint8_t> positions;
+    positions.reserve(points.size() * 4);
+    int64_t previous[3] = {0, 0, 0};
+    for (const auto& p : points) {
+        float coords[3] = {p.x, p.y, p.z};
+        for (int k = 0; k < 3; ++k) {
+            double scaled = static_cast<double>(coords[k]) / quantum_;
+            if (!(std::abs(scaled) <= MAX_QUANTIZED)) {
+                std::cerr << "Toolpath coordinate out of range: " << coords[k] << std::endl;
+                failed_ = true;
+                return false;
+            }
+            int64_t q = std::llround(scaled);
+            putVarint(positions, q - previous[k]);
+            previous[k] = q;
+        }
+    }
+
+    block_.clear();
+    putValue<uint32_t>(block_, static_cast<uint32_t>(points.size()));
+    putValue<uint32_t>(block_, static_cast<uint32_t>(positions.size()));
+    block_.insert(block_.end(), positions.begin(), positions.end());
+    for (const auto& p : points) {
+        int16_t packed[2];
+        packNormal(p.nx, p.ny, p.nz, packed);
+        putValue<int16_t>(block_, packed[0]);
+        putValue<int16_t>(block_, packed[1]);
+    }
+
+    file_.write(reinterpret_cast<const char*>(block_.data()), block_.size());
+    if (!file_) {
+        failed_ = true;
+        return false;
+    }
+
+    index_.push_back({offset_, points[0].z, static_cast<uint32_t>(points.size())});
+    offset_ += block_.size();
+    pointCount_ += points.size();
+    return !failed_;
+}
+
+bool ToolpathWriter::close() {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    // Slice index at the end of the file
+    std::vector<uint8_t> index;
+    for (const auto& entry : index_) {
+        putValue<uint64_t>(index, entry.offset);
+        putValue<float>(index, entry.z);
+        putValue<uint32_t>(index, entry.count);
+    }
+    file_.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+    std::vector<uint8_t> header(TOOLPATH_MAGIC, TOOLPATH_MAGIC + 4);
+    putValue<uint32_t>(header, TOOLPATH_VERSION);
+    putValue<float>(header, quantum_);
+    putValue<uint32_t>(header, 0);  // Reserved
+    putValue<uint64_t>(header, index_.size());
+    putValue<uint64_t>(header, pointCount_);
+    putValue<uint64_t>(header, offset_);
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    file_.close();
+    return !failed_ && !file_.fail();
+}
+
+ToolpathReader::ToolpathReader()
+    : data_(nullptr), size_(0), quantum_(0.0f), sliceCount_(0), pointCount_(0), index_(nullptr) {
+#ifdef _WIN32
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+#endif
+}
+
+ToolpathReader::~ToolpathReader() {
+    close();
+}
+
+bool ToolpathReader::open(const std::string& filename) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open toolpath file: " << filename << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mapping = (size_ > 0) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open toolpath file: " << filename << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid after the descriptor is closed
+    if (mapped == MAP_FAILED) {
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapped);
+#endif
+
+    if (data_ == nullptr || size_ < HEADER_SIZE || std::memcmp(data_, TOOLPATH_MAGIC, 4) != 0 ||
+        getValue<uint32_t>(data_ + 4) != TOOLPATH_VERSION) {
+        std::cerr << "Not a toolpath file: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    quantum_ = getValue<float>(data_ + 8);
+    uint64_t sliceCount = getValue<uint64_t>(data_ + 16);
+    pointCount_ = static_cast<size_t>(getValue<uint64_t>(data_ + 24));
+    uint64_t indexOffset = getValue<uint64_t>(data_ + 32);
+    if (indexOffset > size_ || sliceCount > (size_ - indexOffset) / INDEX_ENTRY_SIZE ||
+        pointCount_ > (size_ - HEADER_SIZE) / MIN_POINT_SIZE) {
+        std::cerr << "Corrupt toolpath index: " << filename << std::endl;
+        close();
+        return false;
+    }
+    sliceCount_ = static_cast<size_t>(sliceCount);
+    index_ = data_ + indexOffset;
+    return true;
+}
+
+void ToolpathReader::close() {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(fileHandle_);
+    }
+    fileHandle_ = nullptr;
+    mappingHandle_ = nullptr;
+#else
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    sliceCount_ = 0;
+    pointCount_ = 0;
+    index_ = nullptr;
+}
+
+ToolpathSliceInfo ToolpathReader::getSliceInfo(size_t slice) const {
+    if (slice >= sliceCount_) {
+        return {0, 0.0f, 0};
+    }
+    const uint8_t* entry = index_ + slice * INDEX_ENTRY_SIZE;
+    return {getValue<uint64_t>(entry), getValue<float>(entry + 8), getValue<uint32_t>(entry + 12)};
+}
+
+bool ToolpathReader::readSlice(size_t slice, std::vector<PathPoint>& points) const {
+    points.clear();
+    if (slice >= sliceCount_) {
+        return false;
+    }
+
+    ToolpathSliceInfo info = getSliceInfo(slice);
+    if (info.offset + 8 > size_) {
+        return false;
+    }
+    const uint8_t* block = data_ + info.offset;
+    uint32_t count = getValue<uint32_t>(block);
+    uint32_t positionBytes = getValue<uint32_t>(block + 4);
+    const uint8_t* p = block + 8;
+    const uint8_t* positionsEnd = p + positionBytes;
+    const uint8_t* normals = positionsEnd;
+    if (count != info.count || info.offset + 8 + positionBytes + 4ull * count > size_) {
+        return false;
+    }
+
+    points.resize(count);
+    int64_t q[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            int64_t delta;
+            if (!getVarint(p, positionsEnd, delta)) {
+                points.clear();
+                return false;
+            }
+            // Wrap rather than overflow on corrupt deltas
+            q[k] = static_cast<int64_t>(static_cast<uint64_t>(q[k]) + static_cast<uint64_t>(delta));
+        }
+
+        PathPoint& point = points[i];
+        point.x = static_cast<float>(static_cast<double>(q[0]) * quantum_);
+        point.y = static_cast<float>(static_cast<double>(q[1]) * quantum_);
+        point.z = static_cast<float>(static_cast<double>(q[2]) * quantum_);
+
+        int16_t packed[2] = {getValue<int16_t>(normals + 4 * i), getValue<int16_t>(normals + 4 * i + 2)};
+        unpackNormal(packed, point.nx, point.ny, point.nz);
+    }
+
+    return true;
+}
+
+std::vector<PathPoint> ToolpathReader::readPath() const {
+    std::vector<PathPoint> path;
+    path.reserve(pointCount_);
+
+    std::vector<PathPoint> slicePoints;
+    for (size_t i = 0; i < sliceCount_; ++i) {
+        if (readSlice(i, slicePoints)) {
+            path.insert(path.end(), slicePoints.begin(), slicePoints.end());
+        }
+    }
+
+    return path;
+}
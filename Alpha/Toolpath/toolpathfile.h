@@ -0,0 +1,80 @@
+#ifndef TOOLPATHFILE_H
+#define TOOLPATHFILE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include "pathplanner.h"
+
+// Compact binary toolpath file (.tpath), little-endian:
+//   header     magic "TPTH", version, quantum, slice count, point count, index offset
+//   blocks     one per slice: positions quantized to the quantum and stored as
+//              zig-zag varint (up to 64-bit) deltas from the previous point, then normals
+//              packed into two 16-bit octahedral coordinates
+//   index      per slice: block offset, z of the first point, point count
+struct ToolpathSliceInfo {
+    uint64_t offset;   // Byte offset of the slice block
+    float z;           // Z of the first point in the slice
+    uint32_t count;    // Number of points
+};
+
+// Writes slices as they are planned (pass writeSlice to PathPlanner::streamPath)
+class ToolpathWriter {
+public:
+    // Positions are rounded to multiples of quantum (model units)
+    ToolpathWriter(float quantum = 1.0e-4f);
+    ~ToolpathWriter();
+
+    bool open(const std::string& filename);
+
+    // False if a coordinate is beyond 2^62 quanta or the write failed; the
+    // slice is left out and close() reports the failure too
+    bool writeSlice(const std::vector<PathPoint>& points);
+    bool close();
+
+private:
+    std::ofstream file_;
+    float quantum_;
+    uint64_t offset_;
+    uint64_t pointCount_;
+    std::vector<ToolpathSliceInfo> index_;
+    std::vector<uint8_t> block_;
+    bool failed_;
+};
+
+// Memory-maps a toolpath file; slices are decoded on demand through the index
+class ToolpathReader {
+public:
+    ToolpathReader();
+    ~ToolpathReader();
+
+    // Owns the mapping, so it cannot be copied
+    ToolpathReader(const ToolpathReader&) = delete;
+    ToolpathReader& operator=(const ToolpathReader&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    size_t getSliceCount() const { return sliceCount_; }
+    size_t getPointCount() const { return pointCount_; }
+    ToolpathSliceInfo getSliceInfo(size_t slice) const;  // All zero past the last slice
+
+    // Decode one slice; returns false if the block is corrupt
+    bool readSlice(size_t slice, std::vector<PathPoint>& points) const;
+    std::vector<PathPoint> readPath() const;
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    float quantum_;
+    size_t sliceCount_;
+    size_t pointCount_;
+    const uint8_t* index_;
+#ifdef _WIN32
+    void* fileHandle_;
+    void* mappingHandle_;
+#endif
+};
+
+#endif // TOOLPATHFILE_H
@@ -0,0 +1,195 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> tracingEnabled(false);
+
+using Clock = std::chrono::steady_clock;
+
+static const Clock::time_point traceEpoch = Clock::now();
+
+struct TraceEvent {
+    const char* name;
+    int64_t start;      // Nanoseconds
+    int64_t duration;   // Nanoseconds; unused for counters
+    double value;       // Counter value
+    bool counter;
+};
+
+// Events of one thread. Only the owning thread appends; the mutex is there
+// for export and clear, so it is never contended while tracing.
+struct ThreadBuffer {
+    int threadId;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+static std::mutex registryMutex;
+static std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+// Buffers stay in the registry after their thread exits so its events can
+// still be exported
+static ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->threadId = static_cast<int>(registry.size()) + 1;
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+static void record(const TraceEvent& event) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back(event);
+}
+
+// Copy of all events with their thread ids
+static std::vector<std::pair<int, TraceEvent>> collectEvents() {
+    std::vector<std::pair<int, TraceEvent>> events;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        for (const auto& event : buffer->events) {
+            events.emplace_back(buffer->threadId, event);
+        }
+    }
+    return events;
+}
+
+void setTracingEnabled(bool enabled) {
+    tracingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - traceEpoch).count();
+}
+
+void traceScope(const char* name, int64_t start, int64_t end) {
+    record({name, start, end - start, 0.0, false});
+}
+
+void traceCounter(const char* name, double value) {
+    record({name, traceNow(), 0, value, true});
+}
+
+void clearTrace() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+size_t getTraceEventCount() {
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        count += buffer->events.size();
+    }
+    return count;
+}
+
+// Names are literals from the code, but escape them anyway
+static void writeJsonString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+
+bool writeChromeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Chrome trace timestamps are microseconds
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& entry : collectEvents()) {
+        const TraceEvent& event = entry.second;
+        file << (first ? "\n" : ",\n");
+        first = false;
+        file << "{\"name\":";
+        writeJsonString(file, event.name);
+        if (event.counter) {
+            file << ",\"ph\":\"C\",\"ts\":" << event.start / 1000.0
+                 << ",\"pid\":1,\"tid\":" << entry.first
+                 << ",\"args\":{\"value\":" << event.value << "}}";
+        }
+        else {
+            file << ",\"ph\":\"X\",\"ts\":" << event.start / 1000.0
+                 << ",\"dur\":" << event.duration / 1000.0
+                 << ",\"pid\":1,\"tid\":" << entry.first << "}";
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return static_cast<bool>(file);
+}
+
+void printTraceSummary(std::ostream& out) {
+    struct Stats {
+        size_t count = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+    std::map<std::string, Stats> scopes;
+    std::map<std::string, Stats> counters;
+    for (const auto& entry : collectEvents()) {
+        const TraceEvent& event = entry.second;
+        Stats& stats = event.counter ? counters[event.name] : scopes[event.name];
+        double value = event.counter ? event.value : event.duration / 1.0e6;  // Scopes in ms
+        stats.count++;
+        stats.total += value;
+        stats.max = (stats.count == 1) ? value : std::max(stats.max, value);
+    }
+
+    // Scopes by total time, longest first
+    std::vector<std::pair<std::string, Stats>> sorted(scopes.begin(), scopes.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.total > b.second.total;
+    });
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << std::left << std::setw(40) << "Scope" << std::right << std::setw(10) << "Calls"
+        << std::setw(14) << "Total ms" << std::setw(12) << "Mean ms" << std::setw(12) << "Max ms" << std::endl;
+    for (const auto& scope : sorted) {
+        const Stats& stats = scope.second;
+        out << std::left << std::setw(40) << scope.first << std::right << std::setw(10) << stats.count
+            << std::setw(14) << stats.total << std::setw(12) << stats.total / stats.count
+            << std::setw(12) << stats.max << std::endl;
+    }
+
+    if (!counters.empty()) {
+        out << std::left << std::setw(40) << "Counter" << std::right << std::setw(10) << "Samples"
+            << std::setw(14) << "Sum" << std::setw(12) << "Mean" << std::setw(12) << "Max" << std::endl;
+        for (const auto& counter : counters) {
+            const Stats& stats = counter.second;
+            out << std::left << std::setw(40) << counter.first << std::right << std::setw(10) << stats.count
+                << std::setw(14) << stats.total << std::setw(12) << stats.total / stats.count
+                << std::setw(12) << stats.max << std::endl;
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
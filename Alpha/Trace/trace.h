@@ -0,0 +1,79 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Lightweight tracing of scoped timers and counters.
+//
+// Scopes and counters are recorded per thread into thread-local buffers, so
+// worker threads trace without contention. Recording is off until
+// setTracingEnabled(true); while off a scope costs one relaxed atomic load.
+// Building without ALPHA_TRACING removes the TRACE_* macros completely.
+//
+// Names must be string literals (or otherwise outlive the trace).
+
+extern std::atomic<bool> tracingEnabled;
+
+void setTracingEnabled(bool enabled);
+
+inline bool isTracingEnabled() {
+    return tracingEnabled.load(std::memory_order_relaxed);
+}
+
+// Nanoseconds since the trace clock started
+int64_t traceNow();
+
+// Record a finished scope; TraceScope calls this
+void traceScope(const char* name, int64_t start, int64_t end);
+
+// Drop all recorded events
+void clearTrace();
+
+// Number of events recorded so far, over all threads
+size_t getTraceEventCount();
+
+// Write the recorded events as Chrome trace JSON (chrome://tracing, Perfetto).
+// Call once the traced work has finished.
+bool writeChromeTrace(const std::string& filename);
+
+// Print calls, total, mean and max time per scope name, and count, sum and
+// max per counter name
+void printTraceSummary(std::ostream& out);
+
+// Times the enclosing scope
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name_(name), start_(isTracingEnabled() ? traceNow() : -1) {}
+
+    ~TraceScope() {
+        if (start_ >= 0) {
+            traceScope(name_, start_, traceNow());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    int64_t start_;  // Nanoseconds, or -1 if tracing was off at entry
+};
+
+// Record a counter value at the current time
+void traceCounter(const char* name, double value);
+
+#ifdef ALPHA_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_COUNTER(name, value) \
+    do { if (isTracingEnabled()) traceCounter(name, static_cast<double>(value)); } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#endif
+
+#endif // TRACE_H
@@ -3,6 +3,15 @@
 #include "stlfileloader.h"
 #include "uniformslicingalg.h"
 #include "pathplanner.h"
+#include "toolpathfile.h"
+#include "backgroundplanner.h"
+#include "trace.h"
+#include "meshbuffer.h"
+#include "pathbuffer.h"
+#include "scenedraw.h"
+#include "meshdecimator.h"
+#include "frustumculler.h"
+#include "renderscheduler.h"
 #include "fssimplewindow.h"
 #include <iostream>
 #include <vector>
@@ -10,6 +19,9 @@
 #include <string>
 #include <algorithm>
 #include <sstream>
+#include <cstdlib>
+#include <memory>
+#include <chrono>
 
 // OpenGL
 #ifdef __APPLE__
@@ -24,208 +36,48 @@
 
 //float M_PI = 3.14; 
 
-// Calculate model bounds and center point
-void calculateModelBounds(const std::vector<Facet>& facets, float& size, float center[3]) {
-    if (facets.empty()) {
-        size = 1.0f;
-        center[0] = center[1] = center[2] = 0.0f;
-        return;
-    }
-
-    // Initialize bounds
-    float minX = facets[0].vertices[0][0];
-    float maxX = minX;
-    float minY = facets[0].vertices[0][1];
-    float maxY = minY;
-    float minZ = facets[0].vertices[0][2];
-    float maxZ = minZ;
-
-    // Find min and max values for each dimension
-    for (const auto& facet : facets) {
-        for (int i = 0; i < 3; ++i) {
-            minX = std::min(minX, facet.vertices[i][0]);
-            maxX = std::max(maxX, facet.vertices[i][0]);
-            minY = std::min(minY, facet.vertices[i][1]);  // Track Y-axis
-            maxY = std::max(maxY, facet.vertices[i][1]);  // Track Y-axis
-            minZ = std::min(minZ, facet.vertices[i][2]);
-            maxZ = std::max(maxZ, facet.vertices[i][2]);
-        }
-    }
-
-    // Calculate center point
-    center[0] = (minX + maxX) / 2.0f;
-    center[1] = (minY + maxY) / 2.0f;  // Center along Y-axis
-    center[2] = (minZ + maxZ) / 2.0f;
-
-    // Calculate model size
-    float dx = maxX - minX;
-    float dy = maxY - minY;  // Size along Y-axis
-    float dz = maxZ - minZ;
-    size = std::max({ dx, dy, dz });
-
-    if (size < 0.001f) size = 1.0f;  // Prevent too small models
-}
-
-
-// Draw axis for orientation
-void drawAxis(float size) {
-    glLineWidth(2.0f);
-
-    // X-axis (red)
-    glBegin(GL_LINES);
-    glColor3f(1.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(size, 0.0f, 0.0f);
-    glEnd();
-
-    // Y-axis (green)
-    glBegin(GL_LINES);
-    glColor3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, size, 0.0f);
-    glEnd();
-
-    // Z-axis (blue)
-    glBegin(GL_LINES);
-    glColor3f(0.0f, 0.0f, 1.0f);
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(0.0f, 0.0f, size);
-    glEnd();
-
-    glLineWidth(1.0f);
-}
-
 // Draw end effector representation
-void drawEndEffector(const PathPoint& point, float size) {
-    glPushMatrix();
-
-    glTranslatef(point.x, point.y, point.z);
-
-    // Draw a sphere for the end effector
-    const int slices = 12;
-    const int stacks = 12;
-    const float radius = size * 0.02f;
-
-    glColor3f(1.0f, 0.2f, 0.2f); // Red color for end effector
-
-    // Draw a simple sphere approximation
-    for (int i = 0; i < stacks; ++i) {
-        float phi1 = (float)i / stacks * M_PI;
-        float phi2 = (float)(i + 1) / stacks * M_PI;
-
-        for (int j = 0; j < slices; ++j) {
-            float theta1 = (float)j / slices * 2.0f * M_PI;
-            float theta2 = (float)(j + 1) / slices * 2.0f * M_PI;
-
-            glBegin(GL_QUADS);
-
-            // Vertex 1
-            float x = radius * sin(phi1) * cos(theta1);
-            float y = radius * sin(phi1) * sin(theta1);
-            float z = radius * cos(phi1);
-            glVertex3f(x, y, z);
-
-            // Vertex 2
-            x = radius * sin(phi1) * cos(theta2);
-            y = radius * sin(phi1) * sin(theta2);
-            z = radius * cos(phi1);
-            glVertex3f(x, y, z);
-
-            // Vertex 3
-            x = radius * sin(phi2) * cos(theta2);
-            y = radius * sin(phi2) * sin(theta2);
-            z = radius * cos(phi2);
-            glVertex3f(x, y, z);
-
-            // Vertex 4
-            x = radius * sin(phi2) * cos(theta1);
-            y = radius * sin(phi2) * sin(theta1);
-            z = radius * cos(phi2);
-            glVertex3f(x, y, z);
-
-            glEnd();
-        }
-    }
-
-    // Draw a line showing the normal direction
-    float normalScale = size * 0.05f;
-    glBegin(GL_LINES);
-    glColor3f(1.0f, 1.0f, 0.0f); // Yellow for normal
-    glVertex3f(0.0f, 0.0f, 0.0f);
-    glVertex3f(point.nx * normalScale, point.ny * normalScale, point.nz * normalScale);
-    glEnd();
-
-    glPopMatrix();
+void drawEndEffector(const EndEffectorGlyph& glyph, const PathPoint& point, float size) {
+    glyph.draw(point, size * 0.02f, size * 0.05f);
 }
 
 
-// Draw a slice plane with transparency (updated for vertical slicing along Z-axis)
-void drawSlicePlane(float z, float modelSize, bool highlight = false) {
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    if (highlight) {
-        glColor4f(0.0f, 0.8f, 0.8f, 0.5f); // Cyan highlight
-    }
-    else {
-        glColor4f(0.5f, 0.5f, 0.7f, 0.2f); // Normal color
-    }
-
-    const float halfSize = modelSize;  // Full model coverage
-
-    // Draw a vertical plane perpendicular to the Z-axis at position z
-    glBegin(GL_QUADS);
-    glVertex3f(-halfSize, -halfSize, z);
-    glVertex3f(halfSize, -halfSize, z);
-    glVertex3f(halfSize, halfSize, z);
-    glVertex3f(-halfSize, halfSize, z);
-    glEnd();
-
-    // Border
-    glColor4f(0.7f, 0.7f, 0.9f, 0.8f);
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(-halfSize, -halfSize, z);
-    glVertex3f(halfSize, -halfSize, z);
-    glVertex3f(halfSize, halfSize, z);
-    glVertex3f(-halfSize, halfSize, z);
-    glEnd();
-
-    glDisable(GL_BLEND);
+// Path steps per second for an animation speed of 1 to 10. Matches the old
+// frame-counted animation at 60 frames per second.
+double animationStepsPerSecond(int animationSpeed) {
+    return 60.0 / (11 - animationSpeed);
 }
 
+// One level of detail: facets in octree order and their copy on the GPU
+struct ModelLevel {
+    FacetOctree octree;
+    MeshBuffer buffer;
 
-// Draw path between points
-void drawPath(const std::vector<PathPoint>& path, size_t currentIndex) {
-    // Draw all path points
-    glPointSize(3.0f);
-    glBegin(GL_POINTS);
-    glColor3f(0.0f, 0.6f, 1.0f); // Light blue for all points
-    for (const auto& point : path) {
-        glVertex3f(point.x, point.y, point.z);
+    explicit ModelLevel(std::vector<Facet> facets) : octree(std::move(facets)) {
+        buffer.upload(octree.getFacets());
     }
-    glEnd();
-
-    // Draw path lines
-    glLineWidth(1.5f);
-    glBegin(GL_LINE_STRIP);
-    glColor3f(0.0f, 0.8f, 1.0f); // Slightly brighter blue for lines
-    for (const auto& point : path) {
-        glVertex3f(point.x, point.y, point.z);
+};
+
+// Draw the parts of the model inside the view frustum of the current
+// projection and modelview matrices, or all of it without culling
+CullStats drawModel(const ModelLevel& model, const Frustum* frustum) {
+    TRACE_SCOPE("Visu::drawModel");
+    CullStats stats = {model.octree.getFacets().size(), model.octree.getFacets().size(), 0};
+    if (!frustum) {
+        model.buffer.draw();
+        return stats;
     }
-    glEnd();
 
-    // Draw completed path segments with different color
-    if (currentIndex > 0) {
-        glLineWidth(2.5f);
-        glBegin(GL_LINE_STRIP);
-        glColor3f(0.0f, 1.0f, 0.5f); // Green for completed path
-        for (size_t i = 0; i < currentIndex && i < path.size(); ++i) {
-            glVertex3f(path[i].x, path[i].y, path[i].z);
-        }
-        glEnd();
-    }
+    std::vector<TriangleRange> visible;
+    stats = model.octree.cull(*frustum, visible);
+    model.buffer.draw(visible);
+    return stats;
+}
 
-    glLineWidth(1.0f);
+// Draw path between points, highlighting the completed part
+void drawPath(const PathBuffer& pathBuffer, size_t currentIndex) {
+    TRACE_SCOPE("Visu::drawPath");
+    pathBuffer.draw(currentIndex);
 }
 
 // Simple function to display text using OpenGL lines
@@ -267,7 +119,12 @@ void drawText(int x, int y, const std::string& text) {
 }
 
 // Main program
-int main() {
+// Usage: Visu [toolpath.tpath] - a saved toolpath is shown instead of planning again
+// Set ALPHA_TRACE=<file.json> to record a Chrome trace of loading, planning and frames
+int main(int argc, char* argv[]) {
+    const char* traceFile = std::getenv("ALPHA_TRACE");
+    setTracingEnabled(traceFile != nullptr);
+
     // Initialize window
     int windowWidth = 1024, windowHeight = 768;
     FsOpenWindow(16, 16, windowWidth, windowHeight, 1, "STL and Basic Path Visualizer");
@@ -296,23 +153,54 @@ int main() {
 
     std::cout << "File loaded successfully with " << loader.getFacets().size() << " facets." << std::endl;
 
+    // Decimated levels of detail for distant views, each uploaded to the GPU
+    // once; frames only issue the draw call
+    std::vector<std::unique_ptr<ModelLevel>> modelLevels;
+    for (auto& levelFacets : buildLevelsOfDetail(loader.getFacets())) {
+        modelLevels.push_back(std::make_unique<ModelLevel>(std::move(levelFacets)));
+        const ModelLevel& level = *modelLevels.back();
+        std::cout << "Model level " << modelLevels.size() - 1 << ": "
+                  << level.buffer.getVertexCount() << " vertices, "
+                  << level.buffer.getTriangleCount() << " triangles in "
+                  << level.octree.getNodeCount() << " octree nodes"
+                  << (level.buffer.usesBufferObjects() ? "" : " (client arrays)") << std::endl;
+    }
+
     // Get tool length
     std::cout << "Enter tool length (in model units): ";
     float toolLength;
     std::cin >> toolLength;
 
-    // Generate slices
-    UniformSlicingAlgorithm slicer(loader.getFacets());
-    slicer.setToolLength(toolLength);
-    std::vector<float> slices = slicer.generateSlices();
-
-    std::cout << "Generated " << slices.size() << " slices." << std::endl;
-
-    // Calculate end effector path
-    PathPlanner planner(loader.getFacets());
-    std::vector<PathPoint> path = planner.calculatePath(slices);
+    // Slices and path are planned on a worker thread, so the window stays
+    // responsive while the tool length is changed. Every 8th slice is shown
+    // first and the rest fill in as they are planned.
+    BackgroundPlanner backgroundPlanner(loader.getFacets());
+    backgroundPlanner.setProgressiveStride(8);
+    std::vector<float> slices;
+    std::vector<PathPoint> path;
+
+    // Map a saved path, or plan one in the background
+    ToolpathReader toolpathReader;
+    if (argc > 1 && toolpathReader.open(argv[1])) {
+        UniformSlicingAlgorithm slicer(loader.getFacets());
+        slicer.setToolLength(toolLength);
+        slices = slicer.generateSlices();
+        std::cout << "Generated " << slices.size() << " slices." << std::endl;
+
+        path = toolpathReader.readPath();
+        std::cout << "Loaded path with " << path.size() << " points in "
+                  << toolpathReader.getSliceCount() << " slices from " << argv[1] << std::endl;
+    }
+    else {
+        backgroundPlanner.request(toolLength);
+        std::cout << "Planning path in the background..." << std::endl;
+    }
 
-    std::cout << "Generated path with " << path.size() << " points." << std::endl;
+    // Path and end effector geometry are uploaded once as well
+    PathBuffer pathBuffer;
+    pathBuffer.upload(path);
+    EndEffectorGlyph endEffectorGlyph;
+    endEffectorGlyph.upload();
 
     // Calculate model bounds for visualization
     float modelSize, modelCenter[3];
@@ -330,11 +218,21 @@ int main() {
     bool showEndEffector = true;
     bool showAxis = true;
     bool showHelp = true;
+    bool autoDetail = true;
+    bool cullModel = true;
+    CullStats cullStats = {0, 0, 0};
+    size_t submittedSlices = 0;
+    size_t modelLevel = 0;
     bool animatePath = false;
     int animationSpeed = 1;
     size_t currentPathIndex = 0;
     int activeSliceIndex = -1;  // No active slice initially
-    int animationTimer = 0;
+
+    // Frames are only drawn after input, animation steps or new data;
+    // animation runs on wall-clock time and position output is throttled
+    RenderScheduler scheduler;
+    AnimationClock animationClock(animationStepsPerSecond(animationSpeed));
+    RateLimiter positionLog(std::chrono::milliseconds(250));
 
     // Display controls
     std::cout << "\nControls:" << std::endl;
@@ -347,6 +245,9 @@ int main() {
     std::cout << "A: Toggle axis" << std::endl;
     std::cout << "Space: Start/Stop animation" << std::endl;
     std::cout << "+/-: Increase/Decrease animation speed" << std::endl;
+    std::cout << "L: Toggle level of detail by zoom" << std::endl;
+    std::cout << "C: Toggle frustum culling" << std::endl;
+    std::cout << "[/]: Decrease/Increase tool length and re-plan" << std::endl;
     std::cout << "H: Toggle help" << std::endl;
     std::cout << "Up/Down: Select active slice" << std::endl;
     std::cout << "ESC: Exit" << std::endl;
@@ -355,6 +256,10 @@ int main() {
     while (true) {
         FsPollDevice();
         int key = FsInkey();
+        SchedulerTime now = SchedulerClock::now();
+        if (key != FSKEY_NULL || FsCheckWindowExposure()) {
+            scheduler.requestRedraw();
+        }
 
         // Handle key inputs
         if (FSKEY_ESC == key) break;
@@ -387,15 +292,61 @@ int main() {
         // Toggle help
         if (FSKEY_H == key) showHelp = !showHelp;
 
+        // Toggle level of detail
+        if (FSKEY_L == key) autoDetail = !autoDetail;
+
+        // Toggle frustum culling
+        if (FSKEY_C == key) {
+            cullModel = !cullModel;
+            std::cout << "Frustum culling " << (cullModel ? "ON" : "OFF") << ", last frame submitted "
+                      << cullStats.submittedTriangles << " of " << cullStats.totalTriangles << " triangles and "
+                      << submittedSlices << " of " << (showSlices ? slices.size() : 0) << " slice planes" << std::endl;
+        }
+
+        // Tool length; the new plan replaces the shown one when it is done
+        if (FSKEY_LBRACKET == key || FSKEY_RBRACKET == key) {
+            toolLength *= (FSKEY_LBRACKET == key) ? 0.9f : 1.1f;
+            backgroundPlanner.request(toolLength);
+            std::cout << "Tool length: " << toolLength << ", re-planning..." << std::endl;
+        }
+
+        // Swap in a new plan between frames, slices and path together; coarse
+        // plans are replaced by finer ones until the complete plan arrives
+        if (std::unique_ptr<PlanResult> plan = backgroundPlanner.takeResult()) {
+            slices = std::move(plan->slices);
+            path = std::move(plan->path);
+            pathBuffer.upload(path);
+            if (currentPathIndex >= path.size()) {
+                currentPathIndex = 0;
+            }
+            if (activeSliceIndex >= (int)slices.size()) {
+                activeSliceIndex = -1;
+            }
+            std::cout << (plan->complete ? "Planned " : "Preview of ") << slices.size() << " slices and "
+                      << path.size() << " points for tool length " << plan->toolLength << " in " << plan->seconds
+                      << " s" << std::endl;
+            scheduler.requestRedraw();
+        }
+
         // Animation control
-        if (FSKEY_SPACE == key) animatePath = !animatePath;
+        if (FSKEY_SPACE == key) {
+            animatePath = !animatePath;
+            if (animatePath) {
+                animationClock.start(now);
+            }
+            else {
+                animationClock.stop();
+            }
+        }
 
         // Animation speed
         if (FSKEY_PLUS == key || key == '=') {  
             animationSpeed = std::min(10, animationSpeed + 1);
+            animationClock.setStepsPerSecond(animationStepsPerSecond(animationSpeed), now);
         }
         if (FSKEY_MINUS == key || key == '-') {  
             animationSpeed = std::max(1, animationSpeed - 1);
+            animationClock.setStepsPerSecond(animationStepsPerSecond(animationSpeed), now);
         }
 
         // Slice navigation
@@ -410,15 +361,24 @@ int main() {
             }
         }
 
-        // Update animation
+        // Update animation, skipping the steps a late frame missed
         if (animatePath && !path.empty()) {
-            animationTimer++;
-            if (animationTimer >= (11 - animationSpeed)) {
-                animationTimer = 0;
-                currentPathIndex = (currentPathIndex + 1) % path.size();
+            size_t steps = animationClock.advance(now);
+            if (steps > 0) {
+                currentPathIndex = (currentPathIndex + steps) % path.size();
+                scheduler.requestRedraw();
             }
+            scheduler.scheduleAt(animationClock.nextStepTime());
         }
 
+        // Nothing changed: wait for input without drawing
+        if (!scheduler.shouldDraw(now)) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(scheduler.timeUntilNextEvent(now));
+            FsSleep(std::max(1, static_cast<int>(wait.count())));
+            continue;
+        }
+        TRACE_SCOPE("Visu::frame");
+
         // Clear screen with dark background
         glClearColor(0.1f, 0.1f, 0.2f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -426,43 +386,8 @@ int main() {
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
 
-        // Set viewport
-        glViewport(0, 0, windowWidth, windowHeight);
-
-        
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        float aspect = (float)windowWidth / (float)windowHeight;
-
-        
-        float fovY = 45.0f;
-        float nearPlane = 0.1f;  // Changed from 'near'
-        float farPlane = zoom * 10.0f;  // Changed from 'far'
-
-
-        
-        float tanHalfFovy = tanf((fovY * 3.14159f / 180.0f) / 2.0f);
-        float f = 1.0f / tanHalfFovy;
-
-        
-        float perspective[16] = {
-            f / aspect, 0, 0, 0,
-            0, f, 0, 0,
-            0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
-            0, 0, (2 * farPlane * nearPlane) / (nearPlane - farPlane), 0
-        };  
-        glMultMatrixf(perspective);
-
-        // Set modelview
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-
-        // Position camera
-        glTranslatef(0, 0, -zoom);
-
-        // Apply rotation
-        glRotatef(rotX, 1, 0, 0);
-        glRotatef(rotY, 0, 1, 0);
+        // Set viewport, projection and camera
+        setupCamera(windowWidth, windowHeight, zoom, rotX, rotY);
 
         // Draw coordinate axis if enabled
         if (showAxis) {
@@ -479,49 +404,35 @@ int main() {
 
         // Enable lighting for solid mode
         if (!wireframeMode) {
-            glEnable(GL_LIGHTING);
-            glEnable(GL_LIGHT0);
-
-            // Set light position
-            GLfloat lightPos[] = { zoom * 2.0f, zoom * 2.0f, zoom * 2.0f, 1.0f };
-            glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
-
-            // Set ambient light
-            GLfloat ambientLight[] = { 0.3f, 0.3f, 0.3f, 1.0f };
-            glLightfv(GL_LIGHT0, GL_AMBIENT, ambientLight);
-
-            // Set diffuse light
-            GLfloat diffuseLight[] = { 0.7f, 0.7f, 0.7f, 1.0f };
-            glLightfv(GL_LIGHT0, GL_DIFFUSE, diffuseLight);
+            setupModelLighting(zoom);
         }
 
         // Center the model
         glTranslatef(-modelCenter[0], -modelCenter[1], -modelCenter[2]);
 
-        // Draw model facets
-        const std::vector<Facet>& facets = loader.getFacets();
-
-        if (!wireframeMode) {
-            // Material properties for solid mode
-            GLfloat modelColor[] = { 0.8f, 0.8f, 0.8f, 1.0f };
-            glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, modelColor);
-        }
-        else {
-            // Color for wireframe mode
+        // Color for wireframe mode
+        if (wireframeMode) {
             glColor3f(0.7f, 0.7f, 0.7f);
         }
 
-        glBegin(GL_TRIANGLES);
-        for (const auto& facet : facets) {
-            // Set normal for the facet
-            glNormal3fv(facet.normal);
-
-            // Draw vertices
-            for (int i = 0; i < 3; ++i) {
-                glVertex3fv(facet.vertices[i]);
-            }
+        // Coarser levels as the camera moves away
+        size_t level = autoDetail ? selectLevelOfDetail(zoom, modelSize, modelLevels.size()) : 0;
+        if (level != modelLevel) {
+            modelLevel = level;
+            std::cout << "Model level " << modelLevel << " (" << modelLevels[modelLevel]->buffer.getTriangleCount()
+                      << " triangles)" << std::endl;
         }
-        glEnd();
+        // One frustum per frame for the model and the slice planes
+        Frustum frustum = {};
+        if (cullModel) {
+            float projection[16], modelview[16];
+            glGetFloatv(GL_PROJECTION_MATRIX, projection);
+            glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+            frustum = frustumFromMatrices(projection, modelview);
+        }
+        cullStats = drawModel(*modelLevels[modelLevel], cullModel ? &frustum : nullptr);
+        TRACE_COUNTER("Visu::submittedTriangles", static_cast<double>(cullStats.submittedTriangles));
+        TRACE_COUNTER("Visu::totalTriangles", static_cast<double>(cullStats.totalTriangles));
 
         // Disable lighting after drawing the model
         glDisable(GL_LIGHTING);
@@ -529,23 +440,33 @@ int main() {
         // Reset polygon mode to fill for other elements
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-        // Draw slice planes if enabled
+        // Draw slice planes if enabled, skipping those outside the view
+        submittedSlices = 0;
         if (showSlices) {
+            TRACE_SCOPE("Visu::drawSlicePlanes");
             for (size_t i = 0; i < slices.size(); ++i) {
+                float quadMin[3] = {-modelSize, -modelSize, slices[i]};
+                float quadMax[3] = {modelSize, modelSize, slices[i]};
+                if (cullModel && !boxInFrustum(frustum, quadMin, quadMax)) {
+                    continue;
+                }
+                submittedSlices++;
+
                 // Highlight the active slice
                 bool isActive = (int)i == activeSliceIndex;
                 drawSlicePlane(slices[i], modelSize, isActive);
             }
+            TRACE_COUNTER("Visu::submittedSlices", static_cast<double>(submittedSlices));
         }
 
         // Draw path if enabled
         if (showPath && !path.empty()) {
-            drawPath(path, currentPathIndex);
+            drawPath(pathBuffer, currentPathIndex);
         }
 
         // Draw end effector if enabled
         if (showEndEffector && !path.empty() && currentPathIndex < path.size()) {
-            drawEndEffector(path[currentPathIndex], modelSize);
+            drawEndEffector(endEffectorGlyph, path[currentPathIndex], modelSize);
         }
 
         // Display control information in console (first run only)
@@ -616,19 +537,38 @@ int main() {
             lastActiveSliceIndex = activeSliceIndex;
         }
 
-        // Display current end effector position (only when position changes)
+        // Display current end effector position (only when position changes,
+        // at most a few times per second while animating)
         static int lastPathIndex = -1;
-        if (currentPathIndex < path.size() && lastPathIndex != (int)currentPathIndex) {
+        if (currentPathIndex < path.size() && lastPathIndex != (int)currentPathIndex &&
+            (!animatePath || positionLog.allow(now))) {
             const auto& point = path[currentPathIndex];
-            std::cout << "End effector position: (" << point.x << ", " << point.y << ", " << point.z << ")" << std::endl;
+            std::cout << "End effector position: (" << point.x << ", " << point.y << ", " << point.z << ")";
+            if (animatePath && positionLog.getSuppressedCount() > 0) {
+                std::cout << " (" << positionLog.getSuppressedCount() << " positions skipped)";
+            }
+            std::cout << std::endl;
             lastPathIndex = currentPathIndex;
         }
 
         // Swap buffers and sleep
-        FsSwapBuffers();
-        FsSleep(16);  // ~60 FPS
+        {
+            TRACE_SCOPE("Visu::swapBuffers");
+            FsSwapBuffers();
+        }
+        scheduler.frameDrawn(now);
     }
 
+    // Buffers belong to the window's context
+    modelLevels.clear();
+    pathBuffer.release();
+    endEffectorGlyph.release();
     FsCloseWindow();
+
+    if (traceFile != nullptr) {
+        setTracingEnabled(false);
+        printTraceSummary(std::cout);
+        writeChromeTrace(traceFile);
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include <benchmark/benchmark.h>
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include "pathresampler.h"
+#include "meshgenerator.h"
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+// Bundled models, loaded from STL_MODEL_DIR
+static const char* MODEL_FILES[] = {
+    "Part1.STL",
+    "Part2.STL",
+    "24783_project_part.STL",
+    "Target Body 1 fine.STL",
+    "surface4_solid.STL"
+};
+constexpr int NUM_MODELS = sizeof(MODEL_FILES) / sizeof(MODEL_FILES[0]);
+
+static std::string modelPath(int index) {
+    return std::string(STL_MODEL_DIR) + "/" + MODEL_FILES[index];
+}
+
+static const std::vector<Facet>& loadModel(int index) {
+    static std::vector<Facet> models[NUM_MODELS];
+    if (models[index].empty()) {
+        STLFileLoader loader(modelPath(index));
+        loader.loadSTLFile();
+        models[index] = loader.getFacets();
+    }
+    return models[index];
+}
+
+// Synthetic meshes, generated once per shape and size
+static const std::vector<Facet>& syntheticModel(MeshShape shape, size_t numFacets) {
+    static std::map<std::pair<MeshShape, size_t>, std::vector<Facet>> cache;
+    auto& facets = cache[{shape, numFacets}];
+    if (facets.empty()) {
+        facets = generateMesh(shape, numFacets);
+    }
+    return facets;
+}
+
+// Tool length giving about 50 slices over the model height
+static float toolLengthFor(const std::vector<Facet>& facets) {
+    float minZ = facets[0].vertices[0][2];
+    float maxZ = minZ;
+    for (const auto& facet : facets) {
+        for (int i = 0; i < 3; ++i) {
+            minZ = std::min(minZ, facet.vertices[i][2]);
+            maxZ = std::max(maxZ, facet.vertices[i][2]);
+        }
+    }
+    return (maxZ - minZ) / (50 * 0.75f);
+}
+
+static void setRate(benchmark::State& state, const char* name, size_t countPerIteration) {
+    state.counters[name] = benchmark::Counter(static_cast<double>(countPerIteration),
+                                              benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// Stage benchmarks, shared by the bundled and synthetic models
+
+static void runLoad(benchmark::State& state, const std::string& filename) {
+    size_t facets = 0;
+    for (auto _ : state) {
+        STLFileLoader loader(filename);
+        loader.loadSTLFile();
+        facets = loader.getFacets().size();
+        benchmark::DoNotOptimize(loader.getFacets().data());
+    }
+    setRate(state, "facets/s", facets);
+}
+
+static void runGenerateSlices(benchmark::State& state, const std::vector<Facet>& facets) {
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(toolLengthFor(facets));
+    size_t slices = 0;
+    for (auto _ : state) {
+        std::vector<float> result = slicer.generateSlices();
+        slices = result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    setRate(state, "facets/s", facets.size());
+    setRate(state, "slices/s", slices);
+}
+
+// The intersection stages run in either precision (Scalar = float or double).
+// Facets are converted before timing starts.
+
+template <typename Scalar>
+static void runGenerateContour(benchmark::State& state, const std::vector<Facet>& facets) {
+    UniformSlicingAlgorithmT<Scalar> slicer(convertFacets<Scalar>(facets));
+    slicer.setToolLength(toolLengthFor(facets));
+    std::vector<Scalar> slices = slicer.generateSlices();
+    size_t points = 0;
+    for (auto _ : state) {
+        points = 0;
+        for (Scalar z : slices) {
+            std::vector<ContourPointT<Scalar>> contour = slicer.generateContour(z);
+            points += contour.size();
+            benchmark::DoNotOptimize(contour.data());
+        }
+    }
+    setRate(state, "slices/s", slices.size());
+    setRate(state, "points/s", points);
+}
+
+template <typename Scalar>
+static void runCalculatePath(benchmark::State& state, const std::vector<Facet>& facets) {
+    std::vector<FacetT<Scalar>> converted = convertFacets<Scalar>(facets);
+    UniformSlicingAlgorithmT<Scalar> slicer(converted);
+    slicer.setToolLength(toolLengthFor(facets));
+    std::vector<Scalar> slices = slicer.generateSlices();
+    PathPlannerT<Scalar> planner(converted);
+    size_t points = 0;
+    for (auto _ : state) {
+        std::vector<PathPointT<Scalar>> path = planner.calculatePath(slices);
+        points = path.size();
+        benchmark::DoNotOptimize(path.data());
+    }
+    setRate(state, "slices/s", slices.size());
+    setRate(state, "points/s", points);
+}
+
+template <typename Scalar>
+static void runRasterPath(benchmark::State& state, const std::vector<Facet>& facets) {
+    Scalar toolLength = toolLengthFor(facets);
+    std::vector<FacetT<Scalar>> converted = convertFacets<Scalar>(facets);
+    UniformSlicingAlgorithmT<Scalar> slicer(converted);
+    slicer.setToolLength(toolLength);
+    std::vector<Scalar> slices = slicer.generateSlices();
+    PathPlannerT<Scalar> planner(converted);
+    size_t points = 0;
+    for (auto _ : state) {
+        std::vector<PathPointT<Scalar>> path = planner.calculateRasterPath(slices, toolLength);
+        points = path.size();
+        benchmark::DoNotOptimize(path.data());
+    }
+    setRate(state, "slices/s", slices.size());
+    setRate(state, "points/s", points);
+}
+
+static void runResamplePath(benchmark::State& state, const std::vector<Facet>& facets) {
+    float toolLength = toolLengthFor(facets);
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(toolLength);
+    std::vector<float> slices = slicer.generateSlices();
+    PathPlanner planner(facets);
+    std::vector<PathPoint> path = planner.calculatePath(slices);
+    ResampleOptions options = {toolLength * 0.1f, toolLength * 0.01f};
+    size_t points = 0;
+    for (auto _ : state) {
+        std::vector<PathPoint> resampled = resamplePath(path, options);
+        points = resampled.size();
+        benchmark::DoNotOptimize(resampled.data());
+    }
+    setRate(state, "points/s", points);
+}
+
+// Bundled models, one run per file (argument = model index)
+
+static void BM_Model_Load(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runLoad(state, modelPath(static_cast<int>(state.range(0))));
+}
+static void BM_Model_GenerateSlices(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runGenerateSlices(state, loadModel(static_cast<int>(state.range(0))));
+}
+static void BM_Model_GenerateContour(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runGenerateContour<float>(state, loadModel(static_cast<int>(state.range(0))));
+}
+static void BM_Model_CalculatePath(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runCalculatePath<float>(state, loadModel(static_cast<int>(state.range(0))));
+}
+static void BM_Model_RasterPath(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runRasterPath<float>(state, loadModel(static_cast<int>(state.range(0))));
+}
+static void BM_Model_ResamplePath(benchmark::State& state) {
+    state.SetLabel(MODEL_FILES[state.range(0)]);
+    runResamplePath(state, loadModel(static_cast<int>(state.range(0))));
+}
+
+BENCHMARK(BM_Model_Load)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Model_GenerateSlices)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Model_GenerateContour)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Model_CalculatePath)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Model_RasterPath)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Model_ResamplePath)->DenseRange(0, NUM_MODELS - 1)->Unit(benchmark::kMillisecond);
+
+// Synthetic meshes scaled by facet count (arguments = shape, facets)
+
+static const std::vector<Facet>& syntheticModel(benchmark::State& state) {
+    MeshShape shape = static_cast<MeshShape>(state.range(0));
+    state.SetLabel(meshShapeName(shape));
+    return syntheticModel(shape, static_cast<size_t>(state.range(1)));
+}
+
+static void BM_Synthetic_GenerateSlices(benchmark::State& state) {
+    runGenerateSlices(state, syntheticModel(state));
+}
+template <typename Scalar>
+static void BM_Synthetic_GenerateContour(benchmark::State& state) {
+    runGenerateContour<Scalar>(state, syntheticModel(state));
+}
+template <typename Scalar>
+static void BM_Synthetic_CalculatePath(benchmark::State& state) {
+    runCalculatePath<Scalar>(state, syntheticModel(state));
+}
+template <typename Scalar>
+static void BM_Synthetic_RasterPath(benchmark::State& state) {
+    runRasterPath<Scalar>(state, syntheticModel(state));
+}
+
+static void syntheticArgs(benchmark::internal::Benchmark* b) {
+    b->ArgsProduct({benchmark::CreateDenseRange(0, 4, 1), {1 << 10, 1 << 13, 1 << 16}});
+    b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_Synthetic_GenerateSlices)->Apply(syntheticArgs);
+// Float and double side by side show the cost of double precision planning
+BENCHMARK_TEMPLATE(BM_Synthetic_GenerateContour, float)->Apply(syntheticArgs);
+BENCHMARK_TEMPLATE(BM_Synthetic_GenerateContour, double)->Apply(syntheticArgs);
+BENCHMARK_TEMPLATE(BM_Synthetic_CalculatePath, float)->Apply(syntheticArgs);
+BENCHMARK_TEMPLATE(BM_Synthetic_CalculatePath, double)->Apply(syntheticArgs);
+BENCHMARK_TEMPLATE(BM_Synthetic_RasterPath, float)->Apply(syntheticArgs);
+BENCHMARK_TEMPLATE(BM_Synthetic_RasterPath, double)->Apply(syntheticArgs);
+
+BENCHMARK_MAIN();
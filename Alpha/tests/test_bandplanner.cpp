@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include "bandplanner.h"
+#include "pipelineplanner.h"
+#include "boundedqueue.h"
+#include "stlfacetreader.h"
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include "meshgenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Slice paths of the loaded part, indexed by slice
+static std::vector<std::vector<PathPoint>> planInCore(const std::vector<Facet>& facets, float toolLength,
+                                                      std::vector<float>& slices) {
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(toolLength);
+    slices = slicer.generateSlices();
+    PathPlanner planner(facets);
+    std::vector<std::vector<PathPoint>> slicePaths(slices.size());
+    for (size_t i = 0; i < slices.size(); ++i) {
+        slicePaths[i] = planner.calculateSlicePath(slices[i]);
+    }
+    return slicePaths;
+}
+
+static void expectSamePaths(const std::vector<std::vector<PathPoint>>& expected,
+                            const std::vector<std::vector<PathPoint>>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(expected[i].size(), actual[i].size()) << "slice " << i;
+        for (size_t j = 0; j < expected[i].size(); ++j) {
+            EXPECT_EQ(expected[i][j].x, actual[i][j].x);
+            EXPECT_EQ(expected[i][j].y, actual[i][j].y);
+            EXPECT_EQ(expected[i][j].z, actual[i][j].z);
+            EXPECT_EQ(expected[i][j].nx, actual[i][j].nx);
+            EXPECT_EQ(expected[i][j].ny, actual[i][j].ny);
+            EXPECT_EQ(expected[i][j].nz, actual[i][j].nz);
+        }
+    }
+}
+
+// Test 1: Verify the block reader returns the facets the loader does
+TEST(BandPlannerTest, FacetReaderMatchesLoader) {
+    std::vector<Facet> facets = generateSphere(5000);
+    ASSERT_TRUE(writeBinarySTL("test_band_reader.stl", facets));
+
+    STLFacetReader reader;
+    ASSERT_TRUE(reader.open("test_band_reader.stl"));
+    EXPECT_EQ(reader.getFacetCount(), facets.size());
+
+    // Read twice to check rewinding; blocks do not divide the facet count
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<Facet> read, block;
+        while (reader.readFacets(block, 999) > 0) {
+            read.insert(read.end(), block.begin(), block.end());
+        }
+        ASSERT_EQ(read.size(), facets.size());
+        for (size_t i = 0; i < facets.size(); ++i) {
+            for (int k = 0; k < 3; ++k) {
+                EXPECT_EQ(read[i].normal[k], facets[i].normal[k]);
+                EXPECT_EQ(read[i].vertices[0][k], facets[i].vertices[0][k]);
+                EXPECT_EQ(read[i].vertices[2][k], facets[i].vertices[2][k]);
+            }
+        }
+        reader.rewind();
+    }
+    reader.close();
+
+    EXPECT_FALSE(reader.open("test_band_missing.stl"));
+    std::remove("test_band_reader.stl");
+}
+
+// Test 2: Verify band planning gives the in-core slices and paths for any band count
+TEST(BandPlannerTest, BandsMatchInCore) {
+    std::vector<Facet> facets = generateTorus(20000);
+    ASSERT_TRUE(writeBinarySTL("test_band_torus.stl", facets));
+    std::vector<float> expectedSlices;
+    std::vector<std::vector<PathPoint>> expected = planInCore(facets, 0.02f, expectedSlices);
+
+    for (size_t bandCount : {1, 3, 7, 1000}) {
+        SCOPED_TRACE(bandCount);
+        BandPlanOptions options = {0.02f, 0, bandCount, 4};
+        std::vector<float> slices;
+        std::vector<std::vector<PathPoint>> slicePaths(expectedSlices.size());
+        BandPlanReport report;
+        ASSERT_TRUE(planInBands("test_band_torus.stl", options, slices,
+                                [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+            ASSERT_LT(sliceIndex, slicePaths.size());
+            EXPECT_TRUE(slicePaths[sliceIndex].empty());
+            slicePaths[sliceIndex] = points;
+        }, report));
+
+        EXPECT_EQ(slices, expectedSlices);
+        EXPECT_EQ(report.facets, facets.size());
+        EXPECT_EQ(report.bands, std::min(bandCount, slices.size()));  // At least one slice per band
+        EXPECT_GE(report.spilledFacets, bandCount == 1 ? facets.size() : 1u);
+        expectSamePaths(expected, slicePaths);
+    }
+    std::remove("test_band_torus.stl");
+}
+
+// Test 3: Verify a memory budget splits the part and bounds the facets held at once
+TEST(BandPlannerTest, BudgetBoundsResidentFacets) {
+    std::vector<Facet> facets = generateSphere(20000);
+    ASSERT_TRUE(writeBinarySTL("test_band_sphere.stl", facets));
+    std::vector<float> expectedSlices;
+    std::vector<std::vector<PathPoint>> expected = planInCore(facets, 0.02f, expectedSlices);
+
+    // About a quarter of the part's facets, with their planner copies
+    size_t budget = facets.size() * sizeof(Facet) / 2;
+    BandPlanOptions options = {0.02f, budget, 0, 2};
+    std::vector<float> slices;
+    std::vector<std::vector<PathPoint>> slicePaths(expectedSlices.size());
+    BandPlanReport report;
+    ASSERT_TRUE(planInBands("test_band_sphere.stl", options, slices,
+                            [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+        slicePaths[sliceIndex] = points;
+    }, report));
+
+    EXPECT_GE(report.bands, 8u);
+    EXPECT_GT(report.peakResidentBytes, 0u);
+    EXPECT_LE(report.peakResidentBytes, budget);
+    expectSamePaths(expected, slicePaths);
+    std::remove("test_band_sphere.stl");
+}
+
+// Test 4: Verify the lock-free queue hands every item to exactly one consumer
+TEST(BandPlannerTest, BoundedQueueDeliversEverything) {
+    BoundedQueue<int> queue(8);
+    const int perProducer = 20000;
+    std::atomic<long long> sum(0);
+    std::atomic<int> count(0);
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 3; ++c) {
+        consumers.emplace_back([&]() {
+            int value;
+            while (queue.pop(value)) {
+                sum += value;
+                count++;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 1; i <= perProducer; ++i) {
+                queue.push(p * perProducer + i);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.close();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    long long n = 3LL * perProducer;
+    EXPECT_EQ(count, n);
+    EXPECT_EQ(sum, n * (n + 1) / 2);
+
+    int value;
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+// Test 5: Verify pipelined planning matches in-core planning, overlapping the
+// load only when the facets arrive in Z order, even if a single late facet
+// breaks the order
+TEST(BandPlannerTest, PipelineMatchesInCore) {
+    std::vector<Facet> sorted = generateSphere(20000);
+    auto lowestZ = [](const Facet& facet) {
+        return std::min({facet.vertices[0][2], facet.vertices[1][2], facet.vertices[2][2]});
+    };
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&](const Facet& a, const Facet& b) { return lowestZ(a) < lowestZ(b); });
+    std::vector<Facet> shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+    // Sorted apart from one of the lowest facets arriving last
+    std::vector<Facet> lateFacet = sorted;
+    std::rotate(lateFacet.begin(), lateFacet.begin() + 1, lateFacet.end());
+
+    const std::vector<Facet>* orders[] = {&sorted, &shuffled, &lateFacet};
+    const char* names[] = {"sorted", "shuffled", "late facet"};
+    for (int order = 0; order < 3; ++order) {
+        SCOPED_TRACE(names[order]);
+        const std::vector<Facet>& facets = *orders[order];
+        bool inOrder = order == 0;
+        ASSERT_TRUE(writeBinarySTL("test_band_pipeline.stl", facets));
+        std::vector<float> expectedSlices;
+        std::vector<std::vector<PathPoint>> expected = planInCore(facets, 0.02f, expectedSlices);
+
+        PipelineOptions options = {0.02f, 3, 4};
+        std::vector<float> slices;
+        std::vector<std::vector<PathPoint>> slicePaths(expectedSlices.size());
+        size_t lastSlice = 0;
+        PipelineReport report;
+        ASSERT_TRUE(planPipelined("test_band_pipeline.stl", options, slices,
+                                  [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+            ASSERT_LT(sliceIndex, slicePaths.size());
+            EXPECT_GE(sliceIndex, lastSlice);  // Handed over in slice order
+            lastSlice = sliceIndex;
+            slicePaths[sliceIndex] = points;
+        }, report));
+
+        EXPECT_EQ(slices, expectedSlices);
+        EXPECT_EQ(report.facets, facets.size());
+        EXPECT_EQ(report.sortedInput, inOrder);
+        EXPECT_EQ(report.bands, (slices.size() + 3) / 4);
+        if (inOrder) {
+            EXPECT_GT(report.bandsDuringLoad, 0u);
+        }
+        else {
+            EXPECT_EQ(report.bandsDuringLoad, 0u);
+        }
+        expectSamePaths(expected, slicePaths);
+    }
+    std::remove("test_band_pipeline.stl");
+}
+
+// Test 6: Verify band and pipelined planning match in-core planning for a part entirely below Z = 0
+TEST(BandPlannerTest, PartBelowZeroMatchesInCore) {
+    std::vector<Facet> facets = generateTorus(10000);
+    for (auto& facet : facets) {
+        for (auto& vertex : facet.vertices) {
+            vertex[2] -= 5.0f;
+        }
+    }
+    ASSERT_TRUE(writeBinarySTL("test_band_below.stl", facets));
+    std::vector<float> expectedSlices;
+    std::vector<std::vector<PathPoint>> expected = planInCore(facets, 0.02f, expectedSlices);
+    ASSERT_FALSE(expectedSlices.empty());
+    EXPECT_LT(expectedSlices.back(), -4.0f);  // Slicing stops at the top of the part, not at Z = 0
+
+    BandPlanOptions bandOptions = {0.02f, 0, 5, 2};
+    std::vector<float> slices;
+    std::vector<std::vector<PathPoint>> slicePaths(expectedSlices.size());
+    BandPlanReport bandReport;
+    ASSERT_TRUE(planInBands("test_band_below.stl", bandOptions, slices,
+                            [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+        ASSERT_LT(sliceIndex, slicePaths.size());
+        slicePaths[sliceIndex] = points;
+    }, bandReport));
+    EXPECT_EQ(slices, expectedSlices);
+    expectSamePaths(expected, slicePaths);
+
+    PipelineOptions pipelineOptions = {0.02f, 2, 4};
+    slicePaths.assign(expectedSlices.size(), {});
+    PipelineReport pipelineReport;
+    ASSERT_TRUE(planPipelined("test_band_below.stl", pipelineOptions, slices,
+                              [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+        ASSERT_LT(sliceIndex, slicePaths.size());
+        slicePaths[sliceIndex] = points;
+    }, pipelineReport));
+    EXPECT_EQ(slices, expectedSlices);
+    expectSamePaths(expected, slicePaths);
+    std::remove("test_band_below.stl");
+}
@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+#include "batchplanner.h"
+#include "backgroundplanner.h"
+#include "meshgenerator.h"
+#include "toolpathfile.h"
+#include "stlfileloader.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <thread>
+
+// Write a closed box as a binary STL file
+std::string createBoxSTLFile(const std::string& filePath, float size) {
+    float v[8][3];
+    for (int i = 0; i < 8; ++i) {
+        v[i][0] = (i & 1) ? size : 0.0f;
+        v[i][1] = (i & 2) ? size : 0.0f;
+        v[i][2] = (i & 4) ? size : 0.0f;
+    }
+    // Two triangles per face, outward winding
+    int tris[12][3] = {
+        {0, 2, 3}, {0, 3, 1}, {4, 5, 7}, {4, 7, 6},
+        {0, 1, 5}, {0, 5, 4}, {2, 6, 7}, {2, 7, 3},
+        {0, 4, 6}, {0, 6, 2}, {1, 3, 7}, {1, 7, 5}
+    };
+    
+    std::ofstream file(filePath, std::ios::binary);
+    char header[80] = "Box for batch testing";
+    file.write(header, 80);
+    uint32_t numTriangles = 12;
+    file.write(reinterpret_cast<char*>(&numTriangles), 4);
+    for (auto& t : tris) {
+        float normal[3] = {0.0f, 0.0f, 0.0f};
+        file.write(reinterpret_cast<char*>(normal), 12);
+        for (int j = 0; j < 3; ++j) {
+            file.write(reinterpret_cast<char*>(v[t[j]]), 12);
+        }
+        uint16_t attribCount = 0;
+        file.write(reinterpret_cast<char*>(&attribCount), 2);
+    }
+    file.close();
+    return filePath;
+}
+
+// Test 1: Verify the pool runs every task, including tasks submitted by tasks
+TEST(BatchPlannerTest, ThreadPoolNestedTasks) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4);
+    
+    std::atomic<int> counter(0);
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&pool, &counter]() {
+            for (int j = 0; j < 20; ++j) {
+                pool.submit([&counter]() { counter.fetch_add(1); });
+            }
+            counter.fetch_add(1);
+        });
+    }
+    pool.wait();
+    EXPECT_EQ(counter.load(), 50 * 21);
+    
+    // The pool can be reused after waiting
+    pool.submit([&counter]() { counter.fetch_add(1); });
+    pool.wait();
+    EXPECT_EQ(counter.load(), 50 * 21 + 1);
+}
+
+// Test 2: Verify batch results match planning each part on its own
+TEST(BatchPlannerTest, BatchMatchesSequential) {
+    std::vector<BatchJob> jobs = {
+        {createBoxSTLFile("test_batch_a.stl", 1.0f), 0.1f, "test_batch_a.tpath"},
+        {createBoxSTLFile("test_batch_b.stl", 2.0f), 0.2f, "test_batch_b.nc"},
+        {"this_file_does_not_exist.stl", 0.1f, ""}
+    };
+    
+    ThreadPool pool(3);
+    BatchReport report = runBatch(jobs, pool);
+    ASSERT_EQ(report.jobs.size(), 3);
+    EXPECT_GT(report.wallSeconds, 0.0);
+    
+    for (size_t i = 0; i < 2; ++i) {
+        STLFileLoader loader(jobs[i].stlFile);
+        ASSERT_TRUE(loader.loadSTLFile());
+        UniformSlicingAlgorithm slicer(loader.getFacets());
+        slicer.setToolLength(jobs[i].toolLength);
+        auto slices = slicer.generateSlices();
+        PathPlanner planner(loader.getFacets());
+        auto path = planner.calculatePath(slices);
+        
+        const BatchJobResult& r = report.jobs[i];
+        EXPECT_TRUE(r.success) << r.message;
+        EXPECT_EQ(r.facets, 12);
+        EXPECT_EQ(r.slices, slices.size());
+        EXPECT_EQ(r.points, path.size());
+        EXPECT_GE(r.totalSeconds, r.planSeconds);
+    }
+    EXPECT_FALSE(report.jobs[2].success);
+    
+    // The toolpath output holds the planned points
+    ToolpathReader reader;
+    ASSERT_TRUE(reader.open("test_batch_a.tpath"));
+    EXPECT_EQ(reader.getPointCount(), report.jobs[0].points);
+    reader.close();
+    
+    std::ifstream gcode("test_batch_b.nc");
+    EXPECT_TRUE(gcode.is_open());
+    gcode.close();
+    
+    for (const char* file : {"test_batch_a.stl", "test_batch_b.stl", "test_batch_a.tpath", "test_batch_b.nc"}) {
+        std::remove(file);
+    }
+}
+
+// Test 3: Verify a background plan matches slicing and planning directly
+TEST(BatchPlannerTest, BackgroundPlanMatchesSequential) {
+    std::vector<Facet> facets = generateSphere(2000);
+    BackgroundPlanner background(facets);
+    
+    uint64_t request = background.request(0.1f);
+    background.wait();
+    EXPECT_FALSE(background.isBusy());
+    std::unique_ptr<PlanResult> result = background.takeResult();
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->request, request);
+    EXPECT_FLOAT_EQ(result->toolLength, 0.1f);
+    
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(0.1f);
+    auto slices = slicer.generateSlices();
+    PathPlanner planner(facets);
+    auto path = planner.calculatePath(slices);
+    
+    EXPECT_EQ(result->slices, slices);
+    EXPECT_FALSE(path.empty());
+    ASSERT_EQ(result->path.size(), path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        EXPECT_EQ(result->path[i].x, path[i].x);
+        EXPECT_EQ(result->path[i].y, path[i].y);
+        EXPECT_EQ(result->path[i].z, path[i].z);
+    }
+    
+    // A result is handed out only once
+    EXPECT_EQ(background.takeResult(), nullptr);
+}
+
+// Test 4: Verify only the newest of several quick requests is delivered
+TEST(BatchPlannerTest, BackgroundPlanNewestRequestWins) {
+    BackgroundPlanner background(generateSphere(5000));
+    
+    for (float toolLength : {0.01f, 0.02f, 0.05f, 0.2f}) {
+        background.request(toolLength);
+    }
+    uint64_t last = background.request(0.25f);
+    background.wait();
+    
+    std::unique_ptr<PlanResult> result = background.takeResult();
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->request, last);
+    EXPECT_FLOAT_EQ(result->toolLength, 0.25f);
+    EXPECT_FALSE(result->path.empty());
+    
+    // Destroying the planner while it works stops it promptly
+    background.request(0.001f);
+}
+
+// Test 5: Verify jobs can be planned in double precision and say so in the job list
+TEST(BatchPlannerTest, DoublePrecisionJobs) {
+    std::ofstream list("test_batch_precision.txt");
+    list << "test_batch_c.stl 0.1 double\n";
+    list << "test_batch_c.stl 0.1 test_batch_c.tpath float\n";
+    list << "test_batch_c.stl 0.1 test_batch_c.nc double\n";
+    list.close();
+    
+    std::vector<BatchJob> jobs;
+    ASSERT_TRUE(readJobList("test_batch_precision.txt", jobs));
+    ASSERT_EQ(jobs.size(), 3);
+    EXPECT_EQ(jobs[0].precision, Precision::Double);
+    EXPECT_TRUE(jobs[0].outputFile.empty());
+    EXPECT_EQ(jobs[1].precision, Precision::Single);
+    EXPECT_EQ(jobs[1].outputFile, "test_batch_c.tpath");
+    EXPECT_EQ(jobs[2].precision, Precision::Double);
+    EXPECT_EQ(jobs[2].outputFile, "test_batch_c.nc");
+    
+    createBoxSTLFile("test_batch_c.stl", 1.0f);
+    ThreadPool pool(2);
+    BatchReport report = runBatch(jobs, pool);
+    for (const auto& r : report.jobs) {
+        EXPECT_TRUE(r.success) << r.message;
+        EXPECT_EQ(r.slices, report.jobs[1].slices);
+        EXPECT_EQ(r.points, report.jobs[1].points);
+    }
+    
+    for (const char* file : {"test_batch_precision.txt", "test_batch_c.stl", "test_batch_c.tpath", "test_batch_c.nc"}) {
+        std::remove(file);
+    }
+}
+
+// Test 6: Verify progressive planning hands out coarse plans before the complete one
+TEST(BatchPlannerTest, ProgressivePlanRefinesToSequential) {
+    std::vector<Facet> facets = generateSphere(20000);
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(0.02f);
+    auto slices = slicer.generateSlices();
+    PathPlanner planner(facets);
+    auto path = planner.calculatePath(slices);
+    
+    BackgroundPlanner background(facets);
+    background.setProgressiveStride(8);
+    uint64_t request = background.request(0.02f);
+    
+    // Poll like a viewer would; each plan seen holds more slices than the last
+    std::unique_ptr<PlanResult> result;
+    size_t lastSlices = 0;
+    while (!result || !result->complete) {
+        std::unique_ptr<PlanResult> next = background.takeResult();
+        if (!next) {
+            std::this_thread::yield();
+            continue;
+        }
+        EXPECT_EQ(next->request, request);
+        EXPECT_GT(next->slices.size(), lastSlices);
+        lastSlices = next->slices.size();
+        if (!next->complete) {
+            // Coarse plans keep the first slice and leave some out
+            ASSERT_FALSE(next->slices.empty());
+            EXPECT_EQ(next->slices.front(), slices.front());
+            EXPECT_LT(next->slices.size(), slices.size());
+        }
+        result = std::move(next);
+    }
+    
+    EXPECT_EQ(result->slices, slices);
+    ASSERT_EQ(result->path.size(), path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        EXPECT_EQ(result->path[i].x, path[i].x);
+        EXPECT_EQ(result->path[i].y, path[i].y);
+        EXPECT_EQ(result->path[i].z, path[i].z);
+    }
+    background.wait();
+    EXPECT_EQ(background.takeResult(), nullptr);
+}
+
+// Test 7: Verify job lists and jobs without a positive tool length are rejected
+TEST(BatchPlannerTest, RejectNonPositiveToolLength) {
+    for (const char* line : {"test_batch_d.stl 0 test_batch_d.nc\n", "test_batch_d.stl -2 test_batch_d.nc\n"}) {
+        std::ofstream list("test_batch_length.txt");
+        list << "test_batch_d.stl 0.1\n" << line;
+        list.close();
+        std::vector<BatchJob> jobs;
+        EXPECT_FALSE(readJobList("test_batch_length.txt", jobs)) << line;
+    }
+    
+    createBoxSTLFile("test_batch_d.stl", 1.0f);
+    std::vector<BatchJob> jobs = {{"test_batch_d.stl", 0.0f, ""}, {"test_batch_d.stl", -2.0f, ""}};
+    ThreadPool pool(2);
+    BatchReport report = runBatch(jobs, pool);
+    ASSERT_EQ(report.jobs.size(), 2);
+    for (const auto& r : report.jobs) {
+        EXPECT_FALSE(r.success);
+        EXPECT_EQ(r.slices, 0u);
+    }
+    
+    for (const char* file : {"test_batch_length.txt", "test_batch_d.stl", "test_batch_d.nc"}) {
+        std::remove(file);
+    }
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "facetbvh.h"
+#include "gougecheck.h"
+#include <vector>
+#include <cstdint>
+
+// Deterministic pseudo random numbers in [0, 1)
+float nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return (state >> 8) / 16777216.0f;
+}
+
+// Axis-aligned quad split into two facets
+void addQuad(std::vector<Facet>& facets, const float a[3], const float b[3], const float c[3], const float d[3], const float n[3]) {
+    const float* corners[2][3] = {{a, b, c}, {a, c, d}};
+    for (auto& tri : corners) {
+        Facet f;
+        for (int k = 0; k < 3; ++k) {
+            f.normal[k] = n[k];
+            for (int v = 0; v < 3; ++v) {
+                f.vertices[v][k] = tri[v][k];
+            }
+        }
+        facets.push_back(f);
+    }
+}
+
+// Floor at z = 0 spanning [-5, 5] in X and Y, facing up
+std::vector<Facet> createFloor() {
+    std::vector<Facet> facets;
+    float a[3] = {-5, -5, 0}, b[3] = {5, -5, 0}, c[3] = {5, 5, 0}, d[3] = {-5, 5, 0}, n[3] = {0, 0, 1};
+    addQuad(facets, a, b, c, d, n);
+    return facets;
+}
+
+// Test 1: Verify BVH distance queries match a brute force search
+TEST(CollisionTest, BVHMatchesBruteForce) {
+    uint32_t state = 12345;
+    std::vector<Facet> facets(2000);
+    for (auto& f : facets) {
+        float center[3] = {nextRandom(state) * 20, nextRandom(state) * 20, nextRandom(state) * 20};
+        for (int v = 0; v < 3; ++v) {
+            for (int k = 0; k < 3; ++k) {
+                f.vertices[v][k] = center[k] + nextRandom(state) - 0.5f;
+            }
+        }
+        f.normal[0] = f.normal[1] = 0.0f;
+        f.normal[2] = 1.0f;
+    }
+    
+    FacetBVH bvh(facets);
+    EXPECT_EQ(bvh.getTriangleCount(), facets.size());
+    EXPECT_GT(bvh.getNodeCount(), 1);
+    
+    for (int query = 0; query < 200; ++query) {
+        float a[3], b[3];
+        for (int k = 0; k < 3; ++k) {
+            a[k] = nextRandom(state) * 20;
+            b[k] = a[k] + nextRandom(state) * 2 - 1;
+        }
+        
+        float expected = 1.5f;
+        for (const auto& f : facets) {
+            expected = std::min(expected, segmentTriangleDistance(a, b, f.vertices[0], f.vertices[1], f.vertices[2]));
+        }
+        EXPECT_NEAR(bvh.segmentDistance(a, b, 1.5f), expected, 1.0e-5f);
+
+        // Point queries agree with a zero-length segment
+        float expectedPoint = 1.5f;
+        for (const auto& f : facets) {
+            expectedPoint = std::min(expectedPoint, segmentTriangleDistance(a, a, f.vertices[0], f.vertices[1], f.vertices[2]));
+        }
+        EXPECT_NEAR(bvh.pointDistance(a, 1.5f), expectedPoint, 1.0e-5f);
+    }
+}
+
+// Test 2: Verify gouging is flagged against nearby geometry only
+TEST(CollisionTest, FlagGouging) {
+    std::vector<Facet> facets = createFloor();
+    
+    // Overhang at z = 1 over x > 2
+    float a[3] = {2, -5, 1}, b[3] = {5, -5, 1}, c[3] = {5, 5, 1}, d[3] = {2, 5, 1}, n[3] = {0, 0, -1};
+    addQuad(facets, a, b, c, d, n);
+    
+    FacetBVH bvh(facets);
+    ToolModel tool = {0.25f, 3.0f, 1.0e-4f};
+    
+    std::vector<PathPoint> path = {
+        {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f},   // On the floor, clear
+        {3.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f},   // Shank passes through the overhang
+        {1.9f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f},   // Shank grazes the overhang edge
+        {0.0f, 0.0f, -0.1f, 0.0f, 0.0f, 1.0f}   // Tip below the floor
+    };
+    
+    auto results = checkGouging(bvh, path, tool, 2);
+    ASSERT_EQ(results.size(), path.size());
+    EXPECT_FALSE(results[0].gouging);
+    EXPECT_TRUE(results[1].gouging);
+    EXPECT_NEAR(results[1].penetration, tool.radius, 1.0e-5f);
+    EXPECT_TRUE(results[2].gouging);
+    EXPECT_NEAR(results[2].penetration, 0.15f, 1.0e-4f);
+    EXPECT_TRUE(results[3].gouging);
+    EXPECT_NEAR(results[3].penetration, 0.1f, 1.0e-4f);
+}
+
+// Test 3: Verify retraction along the normal clears fixable points
+TEST(CollisionTest, CorrectGouging) {
+    FacetBVH bvh(createFloor());
+    ToolModel tool = {0.25f, 3.0f, 1.0e-4f};
+    
+    std::vector<PathPoint> path;
+    for (int i = 0; i < 1000; ++i) {
+        path.push_back({-4.0f + i * 0.008f, 0.0f, -0.05f, 0.0f, 0.0f, 1.0f});
+    }
+    
+    size_t remaining = correctGouging(bvh, path, tool, 4, 2);
+    EXPECT_EQ(remaining, 0);
+    for (const auto& p : path) {
+        EXPECT_NEAR(p.z, 0.0f, 1.0e-3f);
+    }
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "frustumculler.h"
+#include "meshgenerator.h"
+#include <cmath>
+
+// Column-major matrices as gluPerspective and glTranslatef would build them
+static void perspectiveMatrix(float fovyDegrees, float aspect, float zNear, float zFar, float out[16]) {
+    float f = 1.0f / std::tan(fovyDegrees * 3.14159265f / 360.0f);
+    std::fill(out, out + 16, 0.0f);
+    out[0] = f / aspect;
+    out[5] = f;
+    out[10] = (zFar + zNear) / (zNear - zFar);
+    out[11] = -1.0f;
+    out[14] = 2.0f * zFar * zNear / (zNear - zFar);
+}
+
+static void translationMatrix(float x, float y, float z, float out[16]) {
+    std::fill(out, out + 16, 0.0f);
+    out[0] = out[5] = out[10] = out[15] = 1.0f;
+    out[12] = x;
+    out[13] = y;
+    out[14] = z;
+}
+
+static bool insideFrustum(const Frustum& frustum, const float p[3]) {
+    for (const auto& plane : frustum.planes) {
+        if (plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2] + plane[3] < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test 1: Verify a model entirely in view is submitted as one range
+TEST(FrustumCullerTest, WholeModelInView) {
+    FacetOctree octree(generateMesh(MeshShape::Lattice, 20000), 256);
+    EXPECT_GT(octree.getNodeCount(), 8u);
+
+    float projection[16], modelview[16];
+    perspectiveMatrix(45.0f, 1.0f, 0.1f, 100.0f, projection);
+    translationMatrix(0.0f, 0.0f, -10.0f, modelview);
+
+    std::vector<TriangleRange> visible;
+    CullStats stats = octree.cull(frustumFromMatrices(projection, modelview), visible);
+    EXPECT_EQ(stats.totalTriangles, octree.getFacets().size());
+    EXPECT_EQ(stats.submittedTriangles, stats.totalTriangles);
+    ASSERT_EQ(visible.size(), 1u);
+    EXPECT_EQ(visible[0].first, 0u);
+    EXPECT_EQ(visible[0].count, octree.getFacets().size());
+    EXPECT_EQ(stats.visitedNodes, 1u);  // Root is fully inside
+}
+
+// Test 2: Verify a model behind the camera submits nothing
+TEST(FrustumCullerTest, ModelBehindCamera) {
+    FacetOctree octree(generateMesh(MeshShape::Sphere, 5000), 256);
+
+    float projection[16], modelview[16];
+    perspectiveMatrix(45.0f, 1.0f, 0.1f, 100.0f, projection);
+    translationMatrix(0.0f, 0.0f, 10.0f, modelview);
+
+    std::vector<TriangleRange> visible;
+    CullStats stats = octree.cull(frustumFromMatrices(projection, modelview), visible);
+    EXPECT_EQ(stats.submittedTriangles, 0u);
+    EXPECT_TRUE(visible.empty());
+}
+
+// Test 3: Verify a partial view culls most facets but keeps every visible one
+TEST(FrustumCullerTest, PartialViewKeepsVisibleFacets) {
+    FacetOctree octree(generateMesh(MeshShape::Terrain, 50000), 256);
+    const std::vector<Facet>& facets = octree.getFacets();
+
+    // Close up of one corner of the terrain
+    float projection[16], modelview[16];
+    perspectiveMatrix(30.0f, 1.0f, 0.1f, 100.0f, projection);
+    translationMatrix(-0.6f, -0.6f, -1.5f, modelview);
+    Frustum frustum = frustumFromMatrices(projection, modelview);
+
+    std::vector<TriangleRange> visible;
+    CullStats stats = octree.cull(frustum, visible);
+    EXPECT_GT(stats.submittedTriangles, 0u);
+    EXPECT_LT(stats.submittedTriangles, facets.size() / 2);
+
+    // Ranges are sorted, disjoint and add up to the submitted count
+    std::vector<bool> submitted(facets.size(), false);
+    size_t total = 0;
+    for (size_t i = 0; i < visible.size(); ++i) {
+        if (i > 0) {
+            EXPECT_GT(visible[i].first, visible[i - 1].first + visible[i - 1].count);
+        }
+        for (size_t f = visible[i].first; f < visible[i].first + visible[i].count; ++f) {
+            submitted[f] = true;
+        }
+        total += visible[i].count;
+    }
+    EXPECT_EQ(total, stats.submittedTriangles);
+
+    // No facet with a corner in view may be culled
+    for (size_t f = 0; f < facets.size(); ++f) {
+        for (int i = 0; i < 3; ++i) {
+            if (insideFrustum(frustum, facets[f].vertices[i])) {
+                ASSERT_TRUE(submitted[f]) << "Visible facet " << f << " was culled";
+            }
+        }
+    }
+}
+
+// Test 4: Verify slice plane quads are kept in view and dropped behind the camera or past the far plane
+TEST(FrustumCullerTest, SlicePlaneQuads) {
+    float projection[16], modelview[16];
+    perspectiveMatrix(45.0f, 1.0f, 0.1f, 100.0f, projection);
+    translationMatrix(0.0f, 0.0f, -10.0f, modelview);
+    Frustum frustum = frustumFromMatrices(projection, modelview);
+
+    auto quadInView = [&](float z, float halfSize) {
+        float quadMin[3] = {-halfSize, -halfSize, z};
+        float quadMax[3] = {halfSize, halfSize, z};
+        return boxInFrustum(frustum, quadMin, quadMax);
+    };
+    EXPECT_TRUE(quadInView(0.0f, 1.0f));
+    EXPECT_TRUE(quadInView(-50.0f, 1.0f));
+    EXPECT_FALSE(quadInView(15.0f, 1.0f));    // Behind the camera
+    EXPECT_FALSE(quadInView(-200.0f, 1.0f));  // Past the far plane
+
+    // A quad larger than the view still counts when only its middle is visible
+    EXPECT_TRUE(quadInView(5.0f, 100.0f));
+}
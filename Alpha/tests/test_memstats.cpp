@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "memstats.h"
+#include "meshgenerator.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include <memory>
+#include <sstream>
+#include <vector>
+
+static size_t tallyBytes(const std::string& name) {
+    for (const auto& tally : getMemoryTallies()) {
+        if (tally.name == name) {
+            return tally.liveBytes;
+        }
+    }
+    return 0;
+}
+
+// Test 1: Verify the hooks count allocations only while accounting is on
+TEST(MemStatsTest, CountsAllocations) {
+    ASSERT_TRUE(memoryHooksInstalled());
+
+    setMemoryAccountingEnabled(false);
+    MemoryCounters before = getMemoryCounters();
+    std::vector<char> ignored(1 << 20);
+    EXPECT_EQ(getMemoryCounters().allocations, before.allocations);
+
+    setMemoryAccountingEnabled(true);
+    before = getMemoryCounters();
+    {
+        auto block = std::make_unique<char[]>(1 << 20);
+        MemoryCounters during = getMemoryCounters();
+        EXPECT_EQ(during.allocations, before.allocations + 1);
+        EXPECT_EQ(during.liveBytes, before.liveBytes + (1 << 20));
+        EXPECT_GE(during.peakBytes, during.liveBytes);
+    }
+    MemoryCounters after = getMemoryCounters();
+    EXPECT_EQ(after.deallocations, before.deallocations + 1);
+    EXPECT_EQ(after.liveBytes, before.liveBytes);
+    setMemoryAccountingEnabled(false);
+}
+
+// Test 2: Verify stages report their own peak, even after freeing the memory
+TEST(MemStatsTest, StagePeak) {
+    setMemoryAccountingEnabled(true);
+    clearMemoryStats();
+    {
+        MemoryStage outer("outer");
+        {
+            MemoryStage inner("inner");
+            std::vector<double> temporary(1 << 18);  // 2 MB, freed at the end of the stage
+        }
+        std::vector<char> kept(1 << 10);
+    }
+    setMemoryAccountingEnabled(false);
+
+    std::vector<MemoryStageStats> stages = getMemoryStages();
+    ASSERT_EQ(stages.size(), 2);
+    EXPECT_EQ(stages[0].name, "inner");
+    EXPECT_EQ(stages[0].allocations, 1);
+    EXPECT_EQ(stages[0].netBytes, 0);
+    EXPECT_EQ(stages[1].name, "outer");
+    EXPECT_GE(stages[1].allocations, 2);  // Also counts recording the inner stage
+    // The inner peak carries over into the outer stage
+    EXPECT_GE(stages[1].peakBytes, stages[0].peakBytes);
+    EXPECT_GE(stages[0].peakBytes, static_cast<size_t>(1 << 21));
+}
+
+// Test 3: Verify the facet copies of the slicer and planner are tallied
+TEST(MemStatsTest, ContainerTallies) {
+    std::vector<Facet> facets = generateSphere(10000);
+    size_t facetBytes = facets.size() * sizeof(Facet);
+
+    setMemoryAccountingEnabled(true);
+    {
+        UniformSlicingAlgorithm slicer(facets);
+        auto planner = std::make_unique<PathPlanner>(facets);
+        EXPECT_EQ(tallyBytes("UniformSlicingAlgorithm facets"), facetBytes);
+        EXPECT_EQ(tallyBytes("PathPlanner facets"), facetBytes);
+
+        // A copy counts as a second instance
+        PathPlanner copy(*planner);
+        EXPECT_EQ(tallyBytes("PathPlanner facets"), 2 * facetBytes);
+        planner.reset();
+        EXPECT_EQ(tallyBytes("PathPlanner facets"), facetBytes);
+
+        std::ostringstream report;
+        printMemoryReport(report);
+        EXPECT_NE(report.str().find("PathPlanner facets"), std::string::npos);
+    }
+    setMemoryAccountingEnabled(false);
+
+    EXPECT_EQ(tallyBytes("UniformSlicingAlgorithm facets"), 0);
+    EXPECT_EQ(tallyBytes("PathPlanner facets"), 0);
+}
+
+// Test 4: Verify blocks are given back only if they were counted when allocated
+TEST(MemStatsTest, FreesOnlyCountedBlocks) {
+    struct alignas(64) OverAligned {
+        char bytes[64];
+    };
+    setMemoryAccountingEnabled(false);
+    auto early = std::make_unique<char[]>(1 << 20);
+    auto earlyAligned = std::make_unique<OverAligned>();
+
+    setMemoryAccountingEnabled(true);
+    MemoryCounters before = getMemoryCounters();
+    early.reset();
+    earlyAligned.reset();
+    MemoryCounters after = getMemoryCounters();
+    EXPECT_EQ(after.deallocations, before.deallocations);
+    EXPECT_EQ(after.liveBytes, before.liveBytes);
+
+    auto late = std::make_unique<char[]>(1 << 20);
+    auto lateAligned = std::make_unique<OverAligned>();
+    setMemoryAccountingEnabled(false);
+    late.reset();
+    lateAligned.reset();
+    after = getMemoryCounters();
+    EXPECT_EQ(after.deallocations, before.deallocations + 2);
+    EXPECT_EQ(after.liveBytes, before.liveBytes);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "meshdecimator.h"
+#include "meshgenerator.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+// Every directed edge must appear once and its reverse once for a closed,
+// consistently oriented indexed mesh
+static bool isClosed(const IndexedMesh& mesh) {
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t t = 0; t < mesh.getTriangleCount(); ++t) {
+        for (int i = 0; i < 3; ++i) {
+            edges[{mesh.triangles[3 * t + i], mesh.triangles[3 * t + (i + 1) % 3]}]++;
+        }
+    }
+    for (const auto& edge : edges) {
+        auto reverse = edges.find({edge.first.second, edge.first.first});
+        if (edge.second != 1 || reverse == edges.end() || reverse->second != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Open square grid of n x n quads in the plane z = 0
+static std::vector<Facet> createGrid(int n) {
+    std::vector<Facet> facets;
+    auto corner = [n](int i, int j, float out[3]) {
+        out[0] = static_cast<float>(i) / n;
+        out[1] = static_cast<float>(j) / n;
+        out[2] = 0.0f;
+    };
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            Facet a, b;
+            corner(i, j, a.vertices[0]);
+            corner(i + 1, j, a.vertices[1]);
+            corner(i + 1, j + 1, a.vertices[2]);
+            corner(i, j, b.vertices[0]);
+            corner(i + 1, j + 1, b.vertices[1]);
+            corner(i, j + 1, b.vertices[2]);
+            for (Facet* f : {&a, &b}) {
+                f->normal[0] = 0.0f;
+                f->normal[1] = 0.0f;
+                f->normal[2] = 1.0f;
+                facets.push_back(*f);
+            }
+        }
+    }
+    return facets;
+}
+
+// Test 1: Verify indexing welds shared corners into a closed mesh of the same shape
+TEST(MeshDecimatorTest, IndexFacetsWeldsCorners) {
+    std::vector<Facet> facets = generateSphere(2000);
+    IndexedMesh mesh = indexFacets(facets);
+
+    EXPECT_EQ(mesh.getTriangleCount(), facets.size());
+    EXPECT_LT(mesh.getVertexCount(), facets.size());  // About half as many vertices as facets
+    EXPECT_TRUE(isClosed(mesh));
+    EXPECT_LT(hausdorffDistance(meshToFacets(mesh), facets), 1.0e-6f);
+}
+
+// Test 2: Verify decimation reaches the target triangle count and stays close to the sphere
+TEST(MeshDecimatorTest, DecimateSphereToTarget) {
+    std::vector<Facet> facets = generateSphere(20000);
+    IndexedMesh mesh = indexFacets(facets);
+
+    IndexedMesh decimated = decimateMesh(mesh, 2000);
+    EXPECT_LE(decimated.getTriangleCount(), 2000u);
+    EXPECT_GE(decimated.getTriangleCount(), 1990u);
+    EXPECT_TRUE(isClosed(decimated));
+
+    // A tenth of the facets still follows the unit sphere closely
+    EXPECT_LT(hausdorffDistance(meshToFacets(decimated), facets), 0.02f);
+}
+
+// Test 3: Verify a flat grid keeps its outline and normals when decimated
+TEST(MeshDecimatorTest, FlatGridKeepsItsBoundary) {
+    std::vector<Facet> facets = createGrid(20);
+    IndexedMesh decimated = decimateMesh(indexFacets(facets), 20);
+
+    EXPECT_LE(decimated.getTriangleCount(), 20u);
+    std::vector<Facet> coarse = meshToFacets(decimated);
+    EXPECT_LT(hausdorffDistance(coarse, facets), 1.0e-4f);
+    for (const auto& facet : coarse) {
+        EXPECT_GT(facet.normal[2], 0.99f);
+    }
+}
+
+// Test 4: Verify each level of detail has a quarter of the facets and a growing error
+TEST(MeshDecimatorTest, LevelsOfDetailShrink) {
+    std::vector<Facet> facets = generateMesh(MeshShape::Torus, 20000);
+    std::vector<std::vector<Facet>> levels = buildLevelsOfDetail(facets, 4, 0.25f, 256);
+
+    ASSERT_EQ(levels.size(), 4u);
+    EXPECT_EQ(levels[0].size(), facets.size());
+    float previousError = 0.0f;
+    for (size_t i = 1; i < levels.size(); ++i) {
+        EXPECT_LE(levels[i].size(), levels[i - 1].size() / 4);
+        EXPECT_GE(levels[i].size(), levels[i - 1].size() / 4 - 2);
+
+        float error = hausdorffDistance(levels[i], facets);
+        EXPECT_GE(error, previousError * 0.9f);
+        EXPECT_LT(error, 0.1f);
+        previousError = error;
+    }
+}
+
+// Test 5: Verify no level of detail is built below the minimum facet count
+TEST(MeshDecimatorTest, LevelsOfDetailStopAtMinimum) {
+    std::vector<Facet> facets = generateSphere(2000);
+    std::vector<std::vector<Facet>> levels = buildLevelsOfDetail(facets, 6, 0.25f, 256);
+    EXPECT_EQ(levels.size(), 2u);  // 2000 -> 500; 125 would fall below the minimum
+}
+
+// Test 6: Verify the level of detail is picked by viewing distance
+TEST(MeshDecimatorTest, SelectLevelByDistance) {
+    EXPECT_EQ(selectLevelOfDetail(1.0f, 1.0f, 4), 0u);
+    EXPECT_EQ(selectLevelOfDetail(2.0f, 1.0f, 4), 0u);
+    EXPECT_EQ(selectLevelOfDetail(3.0f, 1.0f, 4), 1u);
+    EXPECT_EQ(selectLevelOfDetail(4.0f, 1.0f, 4), 1u);
+    EXPECT_EQ(selectLevelOfDetail(8.0f, 1.0f, 4), 2u);
+    EXPECT_EQ(selectLevelOfDetail(100.0f, 1.0f, 4), 3u);
+    EXPECT_EQ(selectLevelOfDetail(100.0f, 1.0f, 1), 0u);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "meshgenerator.h"
+#include "stlfileloader.h"
+#include "pathplanner.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+using VertexKey = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+static VertexKey vertexKey(const float v[3]) {
+    uint32_t bits[3];
+    std::memcpy(bits, v, sizeof(bits));
+    return VertexKey(bits[0], bits[1], bits[2]);
+}
+
+// Every directed edge must appear once and its reverse once for a closed,
+// consistently oriented mesh
+static bool isClosed(const std::vector<Facet>& facets) {
+    std::map<std::pair<VertexKey, VertexKey>, int> edges;
+    for (const auto& facet : facets) {
+        for (int i = 0; i < 3; ++i) {
+            edges[{vertexKey(facet.vertices[i]), vertexKey(facet.vertices[(i + 1) % 3])}]++;
+        }
+    }
+    for (const auto& edge : edges) {
+        auto reverse = edges.find({edge.first.second, edge.first.first});
+        if (edge.second != 1 || reverse == edges.end() || reverse->second != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Signed volume; positive when the normals point outward
+static double meshVolume(const std::vector<Facet>& facets) {
+    double volume = 0.0;
+    for (const auto& facet : facets) {
+        const float* a = facet.vertices[0];
+        const float* b = facet.vertices[1];
+        const float* c = facet.vertices[2];
+        volume += (static_cast<double>(a[0]) * (b[1] * c[2] - b[2] * c[1]) -
+                   static_cast<double>(a[1]) * (b[0] * c[2] - b[2] * c[0]) +
+                   static_cast<double>(a[2]) * (b[0] * c[1] - b[1] * c[0])) / 6.0;
+    }
+    return volume;
+}
+
+// Test 1: Verify every shape is closed, outward facing and near the requested size
+TEST(MeshGeneratorTest, ShapesAreClosed) {
+    const MeshShape shapes[] = {
+        MeshShape::Sphere, MeshShape::Torus, MeshShape::Terrain, MeshShape::Vase, MeshShape::Lattice
+    };
+    for (MeshShape shape : shapes) {
+        for (size_t numFacets : {1000u, 20000u}) {
+            std::vector<Facet> facets = generateMesh(shape, numFacets);
+            SCOPED_TRACE(meshShapeName(shape));
+            EXPECT_NEAR(static_cast<double>(facets.size()), static_cast<double>(numFacets), 0.05 * numFacets);
+            EXPECT_TRUE(isClosed(facets));
+            EXPECT_GT(meshVolume(facets), 0.0);
+        }
+    }
+}
+
+// Test 2: Verify the sphere and torus volumes converge to the exact ones
+TEST(MeshGeneratorTest, Volumes) {
+    const double pi = 3.14159265358979;
+    EXPECT_NEAR(meshVolume(generateSphere(50000, 2.0f)), 4.0 / 3.0 * pi * 8.0, 0.01 * 4.0 / 3.0 * pi * 8.0);
+    EXPECT_NEAR(meshVolume(generateTorus(50000, 1.0f, 0.25f)), 2.0 * pi * pi * 0.0625, 0.01 * 2.0 * pi * pi * 0.0625);
+}
+
+// Test 3: Verify slices of the generated shapes give the expected contours
+TEST(MeshGeneratorTest, SliceContours) {
+    // A slice through the middle of the torus has an outer loop and a hole
+    PathPlanner torus(generateTorus(5000));
+    auto contours = torus.calculateContours({0.0f})[0].contours;
+    ASSERT_EQ(contours.size(), 2);
+    EXPECT_TRUE(contours[0].closed);
+    EXPECT_TRUE(contours[1].isHole());
+
+    // The vase wall is a thin ring
+    PathPlanner vase(generateVase(5000));
+    contours = vase.calculateContours({1.0f})[0].contours;
+    ASSERT_EQ(contours.size(), 2);
+    EXPECT_TRUE(contours[1].isHole());
+
+    // Every lattice pillar is its own island near the floor
+    std::vector<Facet> lattice = generateLattice(12 * 100);
+    PathPlanner pillars(lattice);
+    contours = pillars.calculateContours({0.1f})[0].contours;
+    EXPECT_EQ(contours.size(), 100);
+    for (const auto& contour : contours) {
+        EXPECT_TRUE(contour.closed);
+        EXPECT_EQ(contour.depth, 0);
+    }
+}
+
+// Test 4: Verify written STL files load back unchanged
+TEST(MeshGeneratorTest, WriteBinarySTL) {
+    std::vector<Facet> facets = generateTerrain(40000);
+    std::string filename = "test_terrain.stl";
+    ASSERT_TRUE(writeBinarySTL(filename, facets));
+    EXPECT_TRUE(isValidSTLFile(filename));
+
+    STLFileLoader loader(filename);
+    ASSERT_TRUE(loader.loadSTLFile());
+    const auto& loaded = loader.getFacets();
+    ASSERT_EQ(loaded.size(), facets.size());
+    EXPECT_EQ(std::memcmp(loaded.data(), facets.data(), facets.size() * sizeof(Facet)), 0);
+
+    std::remove(filename.c_str());
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 #include "pathplanner.h"
+#include "rasterfill.h"
+#include "pathresampler.h"
+#include "slicecontours.h"
+#include "meshgenerator.h"
 #include <vector>
 #include <cmath>
 
@@ -142,4 +146,390 @@ TEST(PathPlannerTest, NormalVectors) {
         float length = std::sqrt(point.nx * point.nx + point.ny * point.ny + point.nz * point.nz);
         EXPECT_NEAR(length, 1.0f, 0.001f);
     }
-}
\ No newline at end of file
+}
+
+// Axis-aligned square loop in the slice plane
+std::vector<PathPoint> createSquare(float minXY, float maxXY, float z) {
+    return {
+        {minXY, minXY, z, 0.0f, 0.0f, 1.0f},
+        {maxXY, minXY, z, 0.0f, 0.0f, 1.0f},
+        {maxXY, maxXY, z, 0.0f, 0.0f, 1.0f},
+        {minXY, maxXY, z, 0.0f, 0.0f, 1.0f}
+    };
+}
+
+// Test 4: Verify zig-zag raster passes cover a square
+TEST(PathPlannerTest, RasterFillZigZag) {
+    std::vector<std::vector<PathPoint>> polygons = {createSquare(0.0f, 1.0f, 0.5f)};
+    
+    auto fill = generateRasterFill(polygons, 0.5f, 0.25f, RasterMode::ZigZag);
+    
+    // Four passes, each one span (start and end point)
+    ASSERT_EQ(fill.size(), 8);
+    for (size_t pass = 0; pass < 4; ++pass) {
+        const PathPoint& start = fill[2 * pass];
+        const PathPoint& end = fill[2 * pass + 1];
+        EXPECT_NEAR(start.y, 0.125f + pass * 0.25f, 0.001f);
+        EXPECT_FLOAT_EQ(start.y, end.y);
+        EXPECT_FLOAT_EQ(start.z, 0.5f);
+        
+        // Passes alternate direction
+        float expectedStart = (pass % 2 == 0) ? 0.0f : 1.0f;
+        float expectedEnd = (pass % 2 == 0) ? 1.0f : 0.0f;
+        EXPECT_NEAR(start.x, expectedStart, 0.001f);
+        EXPECT_NEAR(end.x, expectedEnd, 0.001f);
+    }
+}
+
+// Test 5: Verify one-way passes skip a hole
+TEST(PathPlannerTest, RasterFillOneWayWithHole) {
+    std::vector<std::vector<PathPoint>> polygons = {
+        createSquare(0.0f, 1.0f, 0.0f),
+        createSquare(0.4f, 0.6f, 0.0f)
+    };
+    
+    auto fill = generateRasterFill(polygons, 0.0f, 0.1f, RasterMode::OneWay);
+    ASSERT_FALSE(fill.empty());
+    ASSERT_EQ(fill.size() % 2, 0);
+    
+    for (size_t i = 0; i < fill.size(); i += 2) {
+        // All spans run in +X
+        EXPECT_LT(fill[i].x, fill[i + 1].x);
+        
+        // No span passes through the hole
+        bool inHoleBand = fill[i].y > 0.4f && fill[i].y < 0.6f;
+        if (inHoleBand) {
+            bool leftOfHole = fill[i + 1].x <= 0.4f + 0.001f;
+            bool rightOfHole = fill[i].x >= 0.6f - 0.001f;
+            EXPECT_TRUE(leftOfHole || rightOfHole);
+        }
+    }
+}
+
+// Add the four vertical walls of a square prism (two facets per wall)
+void addSquareWalls(std::vector<Facet>& facets, float minXY, float maxXY, float offsetX, float z0, float z1) {
+    float corners[4][2] = {
+        {minXY + offsetX, minXY}, {maxXY + offsetX, minXY},
+        {maxXY + offsetX, maxXY}, {minXY + offsetX, maxXY}
+    };
+    for (int i = 0; i < 4; ++i) {
+        const float* a = corners[i];
+        const float* b = corners[(i + 1) % 4];
+        float nx = b[1] - a[1], ny = a[0] - b[0];
+        float len = std::sqrt(nx * nx + ny * ny);
+        
+        Facet lower, upper;
+        for (Facet* f : {&lower, &upper}) {
+            f->normal[0] = nx / len; f->normal[1] = ny / len; f->normal[2] = 0.0f;
+        }
+        lower.vertices[0][0] = a[0]; lower.vertices[0][1] = a[1]; lower.vertices[0][2] = z0;
+        lower.vertices[1][0] = b[0]; lower.vertices[1][1] = b[1]; lower.vertices[1][2] = z0;
+        lower.vertices[2][0] = b[0]; lower.vertices[2][1] = b[1]; lower.vertices[2][2] = z1;
+        upper.vertices[0][0] = a[0]; upper.vertices[0][1] = a[1]; upper.vertices[0][2] = z0;
+        upper.vertices[1][0] = b[0]; upper.vertices[1][1] = b[1]; upper.vertices[1][2] = z1;
+        upper.vertices[2][0] = a[0]; upper.vertices[2][1] = a[1]; upper.vertices[2][2] = z1;
+        facets.push_back(lower);
+        facets.push_back(upper);
+    }
+}
+
+// Test 6: Verify islands and holes are separated into a containment tree
+TEST(PathPlannerTest, ContourNesting) {
+    std::vector<Facet> facets;
+    addSquareWalls(facets, 0.0f, 4.0f, 0.0f, 0.0f, 1.0f);  // Outer boundary
+    addSquareWalls(facets, 1.0f, 3.0f, 0.0f, 0.0f, 1.0f);  // Hole
+    addSquareWalls(facets, 0.0f, 1.0f, 6.0f, 0.0f, 1.0f);  // Separate island
+    
+    PathPlanner planner(facets);
+    auto slices = planner.calculateContours({0.5f});
+    ASSERT_EQ(slices.size(), 1);
+    
+    const auto& contours = slices[0].contours;
+    ASSERT_EQ(contours.size(), 3);
+    
+    int roots = 0, holes = 0;
+    for (size_t i = 0; i < contours.size(); ++i) {
+        const Contour& c = contours[i];
+        EXPECT_TRUE(c.closed);
+        EXPECT_EQ(c.points.size(), 9);  // Corner and wall diagonal crossings plus closing point
+        if (c.parent < 0) {
+            roots++;
+            EXPECT_FALSE(c.isHole());
+        }
+        else {
+            holes++;
+            EXPECT_TRUE(c.isHole());
+            EXPECT_LT(c.parent, (int)i);  // Parents come first
+            EXPECT_EQ(contours[c.parent].children.size(), 1);
+            
+            // The hole sits inside the large outer boundary
+            for (const auto& p : c.points) {
+                EXPECT_GE(p.x, 1.0f - 0.001f);
+                EXPECT_LE(p.x, 3.0f + 0.001f);
+            }
+        }
+    }
+    EXPECT_EQ(roots, 2);
+    EXPECT_EQ(holes, 1);
+}
+
+// Test 7: Verify raster passes of a slice avoid holes found by the contour tree
+TEST(PathPlannerTest, RasterPathSkipsHole) {
+    std::vector<Facet> facets;
+    addSquareWalls(facets, 0.0f, 4.0f, 0.0f, 0.0f, 1.0f);
+    addSquareWalls(facets, 1.0f, 3.0f, 0.0f, 0.0f, 1.0f);
+    
+    PathPlanner planner(facets);
+    auto path = planner.calculateRasterPath({0.5f}, 0.4f);
+    ASSERT_FALSE(path.empty());
+    
+    for (size_t i = 0; i + 1 < path.size(); i += 2) {
+        float midX = 0.5f * (path[i].x + path[i + 1].x);
+        bool inHole = midX > 1.0f && midX < 3.0f && path[i].y > 1.0f && path[i].y < 3.0f;
+        EXPECT_FALSE(inHole);
+    }
+}
+
+// Test 8: Verify each point gets the normal of the facets it lies on
+TEST(PathPlannerTest, PerPointNormals) {
+    std::vector<Facet> facets;
+    addSquareWalls(facets, 0.0f, 2.0f, 0.0f, 0.0f, 1.0f);
+    
+    PathPlanner planner(facets);
+    auto path = planner.calculatePath({0.5f});
+    auto slices = planner.calculateContours({0.5f});
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(slices[0].contours.size(), 1);
+    
+    std::vector<PathPoint> points = path;
+    points.insert(points.end(), slices[0].contours[0].points.begin(), slices[0].contours[0].points.end());
+    
+    for (const auto& p : points) {
+        float length = std::sqrt(p.nx * p.nx + p.ny * p.ny + p.nz * p.nz);
+        EXPECT_NEAR(length, 1.0f, 0.001f);
+        EXPECT_NEAR(p.nz, 0.0f, 0.001f);
+        
+        // Normals point outward from the square center
+        EXPECT_GT((p.x - 1.0f) * p.nx + (p.y - 1.0f) * p.ny, 0.0f);
+        
+        // Points inside a wall (not at a corner) take that wall's normal exactly
+        bool onCorner = (std::abs(p.x - 1.0f) > 0.999f) && (std::abs(p.y - 1.0f) > 0.999f);
+        if (!onCorner) {
+            EXPECT_NEAR(std::abs(p.nx) + std::abs(p.ny), 1.0f, 0.001f);
+        }
+    }
+}
+
+// Test 9: Verify streamed slices match the full path
+TEST(PathPlannerTest, StreamedSlicesMatchPath) {
+    std::vector<Facet> facets;
+    addSquareWalls(facets, 0.0f, 2.0f, 0.0f, 0.0f, 1.0f);
+    
+    PathPlanner planner(facets);
+    std::vector<float> slices = {0.25f, 0.5f, 2.0f, 0.75f};  // 2.0 misses the part
+    auto path = planner.calculatePath(slices);
+    
+    std::vector<PathPoint> streamed;
+    std::vector<size_t> sliceIndices;
+    planner.streamPath(slices, [&](size_t sliceIndex, const std::vector<PathPoint>& points) {
+        sliceIndices.push_back(sliceIndex);
+        streamed.insert(streamed.end(), points.begin(), points.end());
+    });
+    
+    EXPECT_EQ(sliceIndices, (std::vector<size_t>{0, 1, 3}));
+    ASSERT_EQ(streamed.size(), path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        EXPECT_FLOAT_EQ(streamed[i].x, path[i].x);
+        EXPECT_FLOAT_EQ(streamed[i].y, path[i].y);
+        EXPECT_FLOAT_EQ(streamed[i].z, path[i].z);
+    }
+}
+
+// Test 10: Verify fixed-chord resampling gives uniform spacing
+TEST(PathPlannerTest, ResampleFixedChord) {
+    std::vector<PathPoint> loop = createSquare(0.0f, 1.0f, 0.5f);
+    loop.push_back(loop[0]);
+    
+    auto resampled = resampleContour(loop, {0.1f, 0.0f});
+    ASSERT_EQ(resampled.size(), 41);
+    EXPECT_FLOAT_EQ(resampled.front().x, resampled.back().x);
+    EXPECT_FLOAT_EQ(resampled.front().y, resampled.back().y);
+    
+    for (size_t i = 1; i < resampled.size(); ++i) {
+        float dx = resampled[i].x - resampled[i - 1].x;
+        float dy = resampled[i].y - resampled[i - 1].y;
+        EXPECT_NEAR(std::sqrt(dx * dx + dy * dy), 0.1f, 0.001f);
+        EXPECT_FLOAT_EQ(resampled[i].z, 0.5f);
+        EXPECT_NEAR(resampled[i].nz, 1.0f, 0.001f);
+    }
+}
+
+// Test 11: Verify chord tolerance limits the deviation on curves
+TEST(PathPlannerTest, ResampleChordTolerance) {
+    const float radius = 10.0f;
+    const float tolerance = 0.01f;
+    std::vector<PathPoint> circle;
+    for (int i = 0; i <= 720; ++i) {
+        float angle = 2.0f * 3.14159265f * i / 720;
+        circle.push_back({radius * std::cos(angle), radius * std::sin(angle), 0.0f,
+                          std::cos(angle), std::sin(angle), 0.0f});
+    }
+    
+    auto resampled = resampleContour(circle, {5.0f, tolerance});
+    
+    // Spacing follows s = sqrt(8 R e) rather than the 5.0 chord limit
+    float expectedSpacing = std::sqrt(8.0f * radius * tolerance);
+    for (size_t i = 1; i < resampled.size(); ++i) {
+        float mx = 0.5f * (resampled[i].x + resampled[i - 1].x);
+        float my = 0.5f * (resampled[i].y + resampled[i - 1].y);
+        EXPECT_GT(std::sqrt(mx * mx + my * my), radius - 1.5f * tolerance);
+        
+        float dx = resampled[i].x - resampled[i - 1].x;
+        float dy = resampled[i].y - resampled[i - 1].y;
+        EXPECT_NEAR(std::sqrt(dx * dx + dy * dy), expectedSpacing, 0.05f);
+        
+        // Interpolated normals stay radial
+        EXPECT_NEAR(resampled[i].nx * resampled[i].y - resampled[i].ny * resampled[i].x, 0.0f, 0.01f);
+    }
+}
+
+// Test 12: Verify each slice of a path is resampled separately
+TEST(PathPlannerTest, ResamplePathPerSlice) {
+    std::vector<PathPoint> path = createSquare(0.0f, 1.0f, 0.0f);
+    path.push_back(path[0]);
+    std::vector<PathPoint> upper = createSquare(0.0f, 2.0f, 1.0f);
+    upper.push_back(upper[0]);
+    path.insert(path.end(), upper.begin(), upper.end());
+    
+    auto resampled = resamplePath(path, {0.5f, 0.0f});
+    
+    // 4 / 0.5 + 1 points on the first slice, 8 / 0.5 + 1 on the second
+    ASSERT_EQ(resampled.size(), 9 + 17);
+    EXPECT_FLOAT_EQ(resampled[8].z, 0.0f);
+    EXPECT_FLOAT_EQ(resampled[9].z, 1.0f);
+}
+
+// Box of unit size at x offset x0, sheared so the top is shifted by +1 in X.
+// Every cross-section point off the y = 0 and y = 1 faces has to be
+// interpolated at the large x offset.
+template <typename Scalar>
+std::vector<FacetT<Scalar>> createShearedBox(Scalar x0) {
+    Scalar v[8][3];
+    for (int i = 0; i < 8; ++i) {
+        Scalar z = (i & 4) ? 1 : 0;
+        v[i][0] = x0 + ((i & 1) ? 1 : 0) + z;
+        v[i][1] = (i & 2) ? 1 : 0;
+        v[i][2] = z;
+    }
+    int tris[12][3] = {
+        {0, 2, 3}, {0, 3, 1}, {4, 5, 7}, {4, 7, 6},
+        {0, 1, 5}, {0, 5, 4}, {2, 6, 7}, {2, 7, 3},
+        {0, 4, 6}, {0, 6, 2}, {1, 3, 7}, {1, 7, 5}
+    };
+    std::vector<FacetT<Scalar>> facets;
+    for (auto& t : tris) {
+        FacetT<Scalar> facet = {};
+        for (int j = 0; j < 3; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                facet.vertices[j][k] = v[t[j]][k];
+            }
+        }
+        facets.push_back(facet);
+    }
+    return facets;
+}
+
+// Largest distance of a slice path at z = 0.3 from the sheared box outline
+template <typename Scalar>
+double shearedBoxError(const std::vector<PathPointT<Scalar>>& path, double x0) {
+    double error = 0.0;
+    for (const auto& p : path) {
+        double toSides = std::min(std::abs(p.x - (x0 + 0.3)), std::abs(p.x - (x0 + 1.3)));
+        double toFaces = std::min(std::abs(static_cast<double>(p.y)), std::abs(p.y - 1.0));
+        error = std::max(error, std::min(toSides, toFaces));
+    }
+    return error;
+}
+
+// Test 13: Verify double precision planning matches float on a small part
+TEST(PathPlannerTest, DoublePrecisionMatchesFloat) {
+    std::vector<Facet> facets = generateMesh(MeshShape::Torus, 4000);
+    std::vector<FacetD> facetsD = convertFacets<double>(facets);
+    
+    // Heights away from the vertex rings, where both precisions see the same crossings
+    for (float z : {-0.2f, 0.07f, 0.15f}) {
+        SCOPED_TRACE(z);
+        std::vector<Contour> contours = buildSliceContours(facets, z);
+        std::vector<ContourT<double>> contoursD = buildSliceContours(facetsD, static_cast<double>(z));
+        ASSERT_EQ(contours.size(), contoursD.size());
+        for (size_t c = 0; c < contours.size(); ++c) {
+            EXPECT_EQ(contours[c].depth, contoursD[c].depth);
+            ASSERT_EQ(contours[c].points.size(), contoursD[c].points.size());
+            for (size_t i = 0; i < contours[c].points.size(); ++i) {
+                EXPECT_NEAR(contours[c].points[i].x, contoursD[c].points[i].x, 1.0e-5);
+                EXPECT_NEAR(contours[c].points[i].y, contoursD[c].points[i].y, 1.0e-5);
+            }
+        }
+    }
+    
+    PathPlanner planner(facets);
+    PathPlannerD plannerD(facetsD);
+    std::vector<float> slices = {-0.2f, 0.07f, 0.15f};
+    std::vector<double> slicesD(slices.begin(), slices.end());
+    EXPECT_EQ(planner.calculatePath(slices).size(), plannerD.calculatePath(slicesD).size());
+    EXPECT_EQ(planner.calculateRasterPath(slices, 0.05f).size(), plannerD.calculateRasterPath(slicesD, 0.05).size());
+}
+
+// Test 14: Verify double precision keeps a part far from the origin accurate
+TEST(PathPlannerTest, DoublePrecisionLargeCoordinates) {
+    const double x0 = 100000.0;  // 100 m in millimetres
+    PathPlanner planner(createShearedBox<float>(static_cast<float>(x0)));
+    PathPlannerD plannerD(createShearedBox<double>(x0));
+    
+    std::vector<PathPoint> path = planner.calculateSlicePath(0.3f);
+    std::vector<PathPointD> pathD = plannerD.calculateSlicePath(0.3);
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(path.size(), pathD.size());
+    
+    // Float rounds to 1/128 mm out there, double stays exact to well below a micron
+    EXPECT_GT(shearedBoxError(path, x0), 1.0e-4);
+    EXPECT_LT(shearedBoxError(pathD, x0), 1.0e-6);
+    
+    // Converted back to float for writing, the error is just the final rounding
+    std::vector<PathPoint> converted = convertPath<float>(pathD);
+    EXPECT_LE(shearedBoxError(converted, x0), 0.5 / 128.0);
+}
+
+// Test 15: Verify points on a zero-thickness sheet keep a unit facet normal
+// when the normals of its two back-to-back sides cancel out
+TEST(PathPlannerTest, BackToBackFacetNormals) {
+    float a[3] = {0.0f, 0.0f, 0.0f}, b[3] = {1.0f, 0.0f, 0.0f};
+    float c[3] = {1.0f, 0.0f, 1.0f}, d[3] = {0.0f, 0.0f, 1.0f};
+    const float* triangles[4][3] = {{a, b, c}, {a, c, d}, {a, c, b}, {a, d, c}};
+    std::vector<Facet> facets;
+    for (int t = 0; t < 4; ++t) {
+        Facet facet = {};
+        facet.normal[1] = t < 2 ? -1.0f : 1.0f;
+        for (int j = 0; j < 3; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                facet.vertices[j][k] = triangles[t][j][k];
+            }
+        }
+        facets.push_back(facet);
+    }
+    
+    PathPlanner planner(facets);
+    std::vector<PathPoint> points = planner.calculatePath({0.5f});
+    auto slices = planner.calculateContours({0.5f});
+    ASSERT_FALSE(points.empty());
+    ASSERT_FALSE(slices[0].contours.empty());
+    for (const auto& contour : slices[0].contours) {
+        points.insert(points.end(), contour.points.begin(), contour.points.end());
+    }
+    
+    for (const auto& p : points) {
+        EXPECT_NEAR(std::abs(p.ny), 1.0f, 1.0e-6f);
+        EXPECT_NEAR(p.nx, 0.0f, 1.0e-6f);
+        EXPECT_NEAR(p.nz, 0.0f, 1.0e-6f);
+    }
+}
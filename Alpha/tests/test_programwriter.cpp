@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "programwriter.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <limits>
+
+// Read a whole text file into lines
+std::vector<std::string> readLines(const std::string& filePath) {
+    std::ifstream file(filePath);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Create a square slice loop
+std::vector<PathPoint> createSliceLoop(float z) {
+    return {
+        {0.0f, 0.0f, z, 0.0f, -1.0f, 0.0f},
+        {1.0f, 0.0f, z, 1.0f, 0.0f, 0.0f},
+        {1.0f, 1.0f, z, 0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, z, 0.0f, -1.0f, 0.0f}
+    };
+}
+
+// Test 1: Verify G-code layout and number formatting
+TEST(ProgramWriterTest, GCodeOutput) {
+    std::string filePath = "test_program.nc";
+    
+    ProgramWriter writer(gcodeDialect());
+    ASSERT_TRUE(writer.open(filePath));
+    writer.writeSlice(0, createSliceLoop(0.25f));
+    writer.writeSlice(1, createSliceLoop(-0.00001f));
+    ASSERT_TRUE(writer.close());
+    EXPECT_EQ(writer.getPointsWritten(), 8);
+    
+    auto lines = readLines(filePath);
+    ASSERT_EQ(lines.size(), 14);
+    EXPECT_EQ(lines[0], "%");
+    EXPECT_EQ(lines[2], "(Slice 0)");
+    EXPECT_EQ(lines[3], "G0 X0.0000 Y0.0000 Z0.2500");
+    EXPECT_EQ(lines[4], "G1 X1.0000 Y0.0000 Z0.2500");
+    EXPECT_EQ(lines[7], "(Slice 1)");
+    EXPECT_EQ(lines[8], "G0 X0.0000 Y0.0000 Z0.0000");  // No negative zero
+    EXPECT_EQ(lines[12], "M30");
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 2: Verify a custom dialect with a tiny buffer (forces many flushes)
+TEST(ProgramWriterTest, CustomDialectSmallBuffer) {
+    std::string filePath = "test_program.src";
+    
+    ProgramDialect dialect = robotDialect();
+    dialect.header = "";
+    dialect.sliceHeader = "";
+    dialect.footer = "";
+    dialect.rapid = "%N;%X;%Y;%Z;%I;%J;%K;100%%\n";
+    dialect.move = dialect.rapid;
+    dialect.precision = 2;
+    
+    ProgramWriter writer(dialect, 16);
+    ASSERT_TRUE(writer.open(filePath));
+    for (size_t slice = 0; slice < 100; ++slice) {
+        writer.writeSlice(slice, createSliceLoop(slice * 0.5f));
+    }
+    ASSERT_TRUE(writer.close());
+    
+    auto lines = readLines(filePath);
+    ASSERT_EQ(lines.size(), 400);
+    EXPECT_EQ(lines[0], "0;0.00;0.00;0.00;0.00;-1.00;0.00;100%");
+    EXPECT_EQ(lines[399], "399;0.00;0.00;49.50;0.00;-1.00;0.00;100%");
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 3: Handle an output path that cannot be opened
+TEST(ProgramWriterTest, OpenFailure) {
+    ProgramWriter writer(gcodeDialect());
+    EXPECT_FALSE(writer.open("this_directory_does_not_exist/program.nc"));
+}
+
+// Test 4: Verify the largest floats are written in full at a high precision
+TEST(ProgramWriterTest, LongNumbers) {
+    std::string filePath = "test_program_long.nc";
+    
+    ProgramDialect dialect = gcodeDialect();
+    dialect.header = "";
+    dialect.sliceHeader = "";
+    dialect.footer = "";
+    dialect.rapid = "%X %Y\n";
+    dialect.move = dialect.rapid;
+    dialect.precision = 300;
+    
+    float largest = std::numeric_limits<float>::max();
+    ProgramWriter writer(dialect, 16);
+    ASSERT_TRUE(writer.open(filePath));
+    writer.writeSlice(0, {{-largest, largest, 0.0f, 0.0f, 0.0f, 1.0f}});
+    ASSERT_TRUE(writer.close());
+    
+    auto lines = readLines(filePath);
+    ASSERT_EQ(lines.size(), 1);
+    std::string number = "340282346638528859811704183484516925440." + std::string(300, '0');
+    EXPECT_EQ(lines[0], "-" + number + " " + number);
+    
+    std::remove(filePath.c_str());
+}
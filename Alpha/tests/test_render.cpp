@@ -0,0 +1,297 @@
+#include <gtest/gtest.h>
+#include "meshbuffer.h"
+#include "pathbuffer.h"
+#include "offscreencontext.h"
+#include "previewrenderer.h"
+#include "pngwriter.h"
+#include "meshgenerator.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+static Facet makeFacet(const float a[3], const float b[3], const float c[3], const float normal[3]) {
+    Facet facet;
+    for (int k = 0; k < 3; ++k) {
+        facet.normal[k] = normal[k];
+        facet.vertices[0][k] = a[k];
+        facet.vertices[1][k] = b[k];
+        facet.vertices[2][k] = c[k];
+    }
+    return facet;
+}
+
+// Test 1: Verify corners shared with the same normal become one vertex
+TEST(RenderTest, IndexedMeshSharesCorners) {
+    const float up[3] = {0.0f, 0.0f, 1.0f};
+    const float down[3] = {0.0f, 0.0f, -1.0f};
+    const float p0[3] = {0.0f, 0.0f, 0.0f};
+    const float p1[3] = {1.0f, 0.0f, 0.0f};
+    const float p2[3] = {1.0f, 1.0f, 0.0f};
+    const float p3[3] = {0.0f, 1.0f, 0.0f};
+
+    // A quad as two triangles shares two corners; the same corners with
+    // another normal are separate vertices
+    std::vector<Facet> facets = {
+        makeFacet(p0, p1, p2, up),
+        makeFacet(p0, p2, p3, up),
+        makeFacet(p0, p2, p1, down)
+    };
+
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    buildIndexedMesh(facets, vertices, indices);
+    EXPECT_EQ(vertices.size(), 7u);
+    ASSERT_EQ(indices.size(), 9u);
+    EXPECT_EQ(indices[0], indices[3]);
+    EXPECT_EQ(indices[2], indices[4]);
+}
+
+// Test 2: Verify the indexed mesh gives back every facet corner and normal
+TEST(RenderTest, IndexedMeshReproducesFacets) {
+    std::vector<Facet> facets = generateMesh(MeshShape::Lattice, 2000);
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    buildIndexedMesh(facets, vertices, indices);
+
+    ASSERT_EQ(indices.size(), facets.size() * 3);
+    EXPECT_LT(vertices.size(), indices.size());
+    for (size_t f = 0; f < facets.size(); ++f) {
+        for (int i = 0; i < 3; ++i) {
+            const MeshVertex& vertex = vertices[indices[3 * f + i]];
+            for (int k = 0; k < 3; ++k) {
+                ASSERT_EQ(vertex.position[k], facets[f].vertices[i][k]);
+                ASSERT_EQ(vertex.normal[k], facets[f].normal[k]);
+            }
+        }
+    }
+}
+
+static void setUpScene(int width, int height) {
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+    glEnable(GL_COLOR_MATERIAL);
+    glEnable(GL_NORMALIZE);
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluPerspective(45.0, static_cast<double>(width) / height, 0.1, 100.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    gluLookAt(2.0, 2.0, 3.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0);
+    glColor3f(0.7f, 0.7f, 0.9f);
+}
+
+// Test 3: Verify drawing from buffers gives the same image as immediate mode
+TEST(RenderTest, BufferDrawMatchesImmediateMode) {
+    const int width = 96;
+    const int height = 96;
+    OffscreenContext context;
+    if (!context.create(width, height)) {
+        GTEST_SKIP() << "No offscreen OpenGL context available";
+    }
+
+    std::vector<Facet> facets = generateMesh(MeshShape::Torus, 4000);
+
+    // Reference image drawn one facet at a time
+    setUpScene(width, height);
+    glBegin(GL_TRIANGLES);
+    for (const auto& facet : facets) {
+        glNormal3fv(facet.normal);
+        for (int i = 0; i < 3; ++i) {
+            glVertex3fv(facet.vertices[i]);
+        }
+    }
+    glEnd();
+    std::vector<uint8_t> immediate;
+    context.readPixels(immediate);
+
+    MeshBuffer buffer;
+    buffer.upload(facets);
+    EXPECT_TRUE(buffer.usesBufferObjects());
+    EXPECT_EQ(buffer.getTriangleCount(), facets.size());
+
+    setUpScene(width, height);
+    buffer.draw();
+    std::vector<uint8_t> buffered;
+    context.readPixels(buffered);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+    // Something was drawn, and both paths rasterize the same triangles
+    size_t litPixels = 0;
+    size_t differentPixels = 0;
+    for (size_t i = 0; i < buffered.size(); i += 3) {
+        litPixels += (buffered[i] | buffered[i + 1] | buffered[i + 2]) != 0 ? 1 : 0;
+        for (int c = 0; c < 3; ++c) {
+            if (std::abs(buffered[i + c] - immediate[i + c]) > 2) {
+                ++differentPixels;
+                break;
+            }
+        }
+    }
+    EXPECT_GT(litPixels, static_cast<size_t>(width * height / 10));
+    EXPECT_EQ(differentPixels, 0u);
+}
+
+// Test 4: Verify the end effector glyph is uploaded once and draws without GL errors
+TEST(RenderTest, EndEffectorGlyphIsUploadedOnce) {
+    OffscreenContext context;
+    if (!context.create(16, 16)) {
+        GTEST_SKIP() << "No offscreen OpenGL context available";
+    }
+
+    EndEffectorGlyph glyph;
+    glyph.upload();
+    EXPECT_EQ(glyph.getVertexCount(), 12u * 12u * 4u);
+    glyph.draw(PathPoint{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}, 0.5f, 1.0f);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+}
+
+// Test 5: Verify drawing the path from buffers gives the same image as immediate mode
+TEST(RenderTest, PathBufferMatchesImmediateMode) {
+    const int width = 96;
+    const int height = 96;
+    OffscreenContext context;
+    if (!context.create(width, height)) {
+        GTEST_SKIP() << "No offscreen OpenGL context available";
+    }
+
+    std::vector<PathPoint> path;
+    for (int i = 0; i < 200; ++i) {
+        float angle = i * 0.1f;
+        path.push_back(PathPoint{std::cos(angle), std::sin(angle), i * 0.005f - 0.5f, 1.0f, 0.0f, 0.0f});
+    }
+    const size_t completed = 80;
+
+    auto setUpLines = [&]() {
+        setUpScene(width, height);
+        glDisable(GL_LIGHTING);
+    };
+
+    // Reference drawn vertex by vertex, as Visu did before
+    setUpLines();
+    glPointSize(3.0f);
+    glColor3f(0.0f, 0.6f, 1.0f);
+    glBegin(GL_POINTS);
+    for (const auto& point : path) {
+        glVertex3f(point.x, point.y, point.z);
+    }
+    glEnd();
+    glLineWidth(1.5f);
+    glColor3f(0.0f, 0.8f, 1.0f);
+    glBegin(GL_LINE_STRIP);
+    for (const auto& point : path) {
+        glVertex3f(point.x, point.y, point.z);
+    }
+    glEnd();
+    glLineWidth(2.5f);
+    glColor3f(0.0f, 1.0f, 0.5f);
+    glBegin(GL_LINE_STRIP);
+    for (size_t i = 0; i < completed; ++i) {
+        glVertex3f(path[i].x, path[i].y, path[i].z);
+    }
+    glEnd();
+    glLineWidth(1.0f);
+    std::vector<uint8_t> immediate;
+    context.readPixels(immediate);
+
+    PathBuffer buffer;
+    buffer.upload(path);
+    EXPECT_EQ(buffer.getPointCount(), path.size());
+    setUpLines();
+    buffer.draw(completed);
+    std::vector<uint8_t> buffered;
+    context.readPixels(buffered);
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+    EXPECT_EQ(buffered, immediate);
+}
+
+// Test 6: Verify the PNG writer emits the signature, header and chunks and rejects bad sizes
+TEST(RenderTest, PNGWriterWritesHeaderAndChunks) {
+    const int width = 70;
+    const int height = 40;
+    std::vector<uint8_t> rgb(width * height * 3);
+    for (size_t i = 0; i < rgb.size(); ++i) {
+        rgb[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    const char* filename = "test_render_output.png";
+    ASSERT_TRUE(writePNG(filename, width, height, rgb));
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(filename);
+
+    auto readBigEndian = [&](size_t offset) {
+        return (uint32_t(bytes[offset]) << 24) | (uint32_t(bytes[offset + 1]) << 16) |
+               (uint32_t(bytes[offset + 2]) << 8) | uint32_t(bytes[offset + 3]);
+    };
+
+    ASSERT_GT(bytes.size(), 8u + 25u + 12u + 12u);
+    const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    EXPECT_TRUE(std::equal(signature, signature + 8, bytes.begin()));
+    EXPECT_EQ(std::string(bytes.begin() + 12, bytes.begin() + 16), "IHDR");
+    EXPECT_EQ(readBigEndian(16), static_cast<uint32_t>(width));
+    EXPECT_EQ(readBigEndian(20), static_cast<uint32_t>(height));
+    EXPECT_EQ(bytes[24], 8);  // Bit depth
+    EXPECT_EQ(bytes[25], 2);  // RGB
+
+    // IDAT follows the header and the file ends with an empty IEND
+    uint32_t dataLength = readBigEndian(33);
+    EXPECT_EQ(std::string(bytes.begin() + 37, bytes.begin() + 41), "IDAT");
+    EXPECT_EQ(bytes.size(), 8u + 25u + (12u + dataLength) + 12u);
+    EXPECT_EQ(std::string(bytes.end() - 8, bytes.end() - 4), "IEND");
+
+    EXPECT_FALSE(writePNG(filename, width, height + 1, rgb));
+}
+
+// Test 7: Verify the preview renderer draws the part in every view and the overlays change the image
+TEST(RenderTest, PreviewRendererDrawsEveryView) {
+    const int size = 64;
+    OffscreenContext context;
+    if (!context.create(size, size)) {
+        GTEST_SKIP() << "No offscreen OpenGL context available";
+    }
+
+    std::vector<Facet> facets = generateMesh(MeshShape::Sphere, 2000);
+    std::vector<float> slices = {-0.5f, 0.0f, 0.5f};
+    std::vector<PathPoint> path;
+    for (int i = 0; i < 100; ++i) {
+        float angle = i * 0.0628f;
+        path.push_back(PathPoint{1.1f * std::cos(angle), 1.1f * std::sin(angle), 0.0f, 1.0f, 0.0f, 0.0f});
+    }
+
+    PreviewRenderer renderer;
+    renderer.setPart(facets, slices, path);
+    PreviewOptions plain = {false, false, false};
+    PreviewOptions full = {true, true, true};
+
+    // Pixels that differ from the clear color
+    auto countDrawn = [](const std::vector<uint8_t>& rgb) {
+        size_t drawn = 0;
+        for (size_t i = 0; i < rgb.size(); i += 3) {
+            drawn += (std::abs(rgb[i] - 26) > 2 || std::abs(rgb[i + 1] - 26) > 2 || std::abs(rgb[i + 2] - 51) > 2) ? 1 : 0;
+        }
+        return drawn;
+    };
+
+    ASSERT_EQ(getPreviewViews().size(), 4u);
+    for (const auto& view : getPreviewViews()) {
+        std::vector<uint8_t> model, overlay;
+        renderer.render(view, plain, size, size);
+        context.readPixels(model);
+        renderer.render(view, full, size, size);
+        context.readPixels(overlay);
+
+        EXPECT_GT(countDrawn(model), static_cast<size_t>(size * size / 10)) << view.name;
+        EXPECT_NE(model, overlay) << view.name;
+    }
+    EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+    renderer.release();
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "renderscheduler.h"
+
+using std::chrono::milliseconds;
+
+// Test 1: Verify frames are drawn only when something changed
+TEST(RenderSchedulerTest, DrawsOnlyWhenSomethingChanged) {
+    RenderScheduler scheduler(milliseconds(16), milliseconds(10));
+    SchedulerTime t0 = SchedulerClock::now();
+
+    // The first frame is always drawn
+    EXPECT_TRUE(scheduler.shouldDraw(t0));
+    scheduler.frameDrawn(t0);
+
+    // Idle: nothing to draw, poll again after the poll interval
+    EXPECT_FALSE(scheduler.shouldDraw(t0 + milliseconds(100)));
+    EXPECT_EQ(scheduler.timeUntilNextEvent(t0 + milliseconds(100)), milliseconds(10));
+
+    // Input marks the view dirty
+    scheduler.requestRedraw();
+    EXPECT_TRUE(scheduler.shouldDraw(t0 + milliseconds(100)));
+    scheduler.frameDrawn(t0 + milliseconds(100));
+    EXPECT_FALSE(scheduler.shouldDraw(t0 + milliseconds(101)));
+    EXPECT_EQ(scheduler.getFrameCount(), 2u);
+}
+
+// Test 2: Verify redraws are held back to the frame interval
+TEST(RenderSchedulerTest, LimitsTheFrameRate) {
+    RenderScheduler scheduler(milliseconds(16), milliseconds(10));
+    SchedulerTime t0 = SchedulerClock::now();
+    scheduler.frameDrawn(t0);
+
+    scheduler.requestRedraw();
+    EXPECT_FALSE(scheduler.shouldDraw(t0 + milliseconds(5)));
+    EXPECT_EQ(scheduler.timeUntilNextEvent(t0 + milliseconds(5)), milliseconds(10));
+    EXPECT_EQ(scheduler.timeUntilNextEvent(t0 + milliseconds(12)), milliseconds(4));
+    EXPECT_TRUE(scheduler.shouldDraw(t0 + milliseconds(16)));
+}
+
+// Test 3: Verify a scheduled frame is drawn at the earliest requested time
+TEST(RenderSchedulerTest, ScheduledFrames) {
+    RenderScheduler scheduler(milliseconds(16), milliseconds(10));
+    SchedulerTime t0 = SchedulerClock::now();
+    scheduler.frameDrawn(t0);
+
+    scheduler.scheduleAt(t0 + milliseconds(50));
+    scheduler.scheduleAt(t0 + milliseconds(80));  // Later time is ignored
+    EXPECT_FALSE(scheduler.shouldDraw(t0 + milliseconds(45)));
+    EXPECT_EQ(scheduler.timeUntilNextEvent(t0 + milliseconds(45)), milliseconds(5));
+    EXPECT_TRUE(scheduler.shouldDraw(t0 + milliseconds(50)));
+    scheduler.frameDrawn(t0 + milliseconds(50));
+    EXPECT_FALSE(scheduler.shouldDraw(t0 + milliseconds(90)));
+}
+
+// Test 4: Verify animation steps follow elapsed time, not the frame rate
+TEST(RenderSchedulerTest, AnimationFollowsWallClock) {
+    AnimationClock clock(10.0);  // One step per 100 ms
+    SchedulerTime t0 = SchedulerClock::now();
+    EXPECT_EQ(clock.advance(t0 + milliseconds(500)), 0u);  // Not running
+
+    clock.start(t0);
+    EXPECT_EQ(clock.advance(t0 + milliseconds(50)), 0u);
+    EXPECT_EQ(clock.advance(t0 + milliseconds(120)), 1u);
+    EXPECT_EQ(clock.nextStepTime(), t0 + milliseconds(200));
+
+    // A late frame skips ahead by every step that was due
+    EXPECT_EQ(clock.advance(t0 + milliseconds(460)), 3u);
+    EXPECT_EQ(clock.advance(t0 + milliseconds(499)), 0u);
+    EXPECT_EQ(clock.advance(t0 + milliseconds(500)), 1u);
+
+    // Total steps only depend on elapsed time, not on how often it is polled
+    AnimationClock polled(10.0);
+    polled.start(t0);
+    size_t steps = 0;
+    for (int ms = 0; ms <= 1000; ms += 7) {
+        steps += polled.advance(t0 + milliseconds(ms));
+    }
+    EXPECT_EQ(steps, 9u);  // Last poll at 994 ms
+}
+
+// Test 5: Verify changing the animation speed keeps the progress into the current step
+TEST(RenderSchedulerTest, AnimationSpeedChangeKeepsProgress) {
+    AnimationClock clock(10.0);
+    SchedulerTime t0 = SchedulerClock::now();
+    clock.start(t0);
+
+    // Half a step done at 10 steps/s, so half a step remains at 20 steps/s
+    clock.setStepsPerSecond(20.0, t0 + milliseconds(50));
+    EXPECT_EQ(clock.advance(t0 + milliseconds(74)), 0u);
+    EXPECT_EQ(clock.advance(t0 + milliseconds(76)), 1u);
+}
+
+// Test 6: Verify the rate limiter allows one event per interval and counts the rest
+TEST(RenderSchedulerTest, RateLimiterCountsSuppressed) {
+    RateLimiter limiter(milliseconds(250));
+    SchedulerTime t0 = SchedulerClock::now();
+
+    EXPECT_TRUE(limiter.allow(t0));
+    EXPECT_EQ(limiter.getSuppressedCount(), 0u);
+    for (int i = 1; i < 10; ++i) {
+        EXPECT_FALSE(limiter.allow(t0 + milliseconds(20 * i)));
+    }
+    EXPECT_TRUE(limiter.allow(t0 + milliseconds(250)));
+    EXPECT_EQ(limiter.getSuppressedCount(), 9u);
+}
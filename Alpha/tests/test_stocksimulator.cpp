@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include "stocksimulator.h"
+#include "uniformslicingalg.h"
+#include "pathplanner.h"
+#include <cmath>
+#include <vector>
+
+// Closed box with outward winding and facet normals
+static std::vector<Facet> createBox(float x0, float y0, float z0, float x1, float y1, float z1) {
+    float v[8][3];
+    for (int i = 0; i < 8; ++i) {
+        v[i][0] = (i & 1) ? x1 : x0;
+        v[i][1] = (i & 2) ? y1 : y0;
+        v[i][2] = (i & 4) ? z1 : z0;
+    }
+    int tris[12][3] = {
+        {0, 2, 3}, {0, 3, 1}, {4, 5, 7}, {4, 7, 6},
+        {0, 1, 5}, {0, 5, 4}, {2, 6, 7}, {2, 7, 3},
+        {0, 4, 6}, {0, 6, 2}, {1, 3, 7}, {1, 7, 5}
+    };
+    std::vector<Facet> facets;
+    for (auto& t : tris) {
+        Facet facet = {};
+        for (int j = 0; j < 3; ++j) {
+            for (int k = 0; k < 3; ++k) {
+                facet.vertices[j][k] = v[t[j]][k];
+            }
+        }
+        float e1[3], e2[3];
+        for (int k = 0; k < 3; ++k) {
+            e1[k] = facet.vertices[1][k] - facet.vertices[0][k];
+            e2[k] = facet.vertices[2][k] - facet.vertices[0][k];
+        }
+        float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int k = 0; k < 3; ++k) {
+            facet.normal[k] = n[k] / length;
+        }
+        facets.push_back(facet);
+    }
+    return facets;
+}
+
+// Contour passes around a box, planned the usual way
+static std::vector<std::vector<PathPoint>> planSlices(const std::vector<Facet>& facets, float toolLength) {
+    UniformSlicingAlgorithm slicer(facets);
+    slicer.setToolLength(toolLength);
+    PathPlanner planner(facets);
+    std::vector<std::vector<PathPoint>> slicePaths;
+    for (float z : slicer.generateSlices()) {
+        slicePaths.push_back(planner.calculateSlicePath(z));
+    }
+    return slicePaths;
+}
+
+// Test 1: Verify the stock block and the rasterized part have the expected volumes
+TEST(StockSimulatorTest, StockAndPartVolumes) {
+    std::vector<Facet> part = createBox(0.0f, 0.0f, 0.0f, 2.0f, 1.0f, 1.0f);
+    StockSimulator stock(part, {0.0625f, 0.5f, 0});
+
+    EXPECT_EQ(stock.getColumnsX(), 48);
+    EXPECT_EQ(stock.getColumnsY(), 32);
+    EXPECT_NEAR(stock.getStockVolume(), 3.0 * 2.0 * 2.0, 1.0e-4);
+    EXPECT_NEAR(stock.getPartVolume(), 2.0, 1.0e-4);
+    EXPECT_NEAR(stock.getRestVolume(), 12.0 - 2.0, 1.0e-4);
+}
+
+// Test 2: Verify a single vertical plunge removes half of the tip sphere
+TEST(StockSimulatorTest, PlungeRemovesHalfSphere) {
+    std::vector<Facet> part = createBox(0.0f, 0.0f, 0.0f, 4.0f, 4.0f, 1.0f);
+    StockSimulator stock(part, {0.01f, 0.0f, 0});
+    ToolModel tool = {0.5f, 2.0f, 0.0f};
+
+    // Tip sphere centered on the top face, shank pointing up into air
+    std::vector<std::vector<PathPoint>> plunge = {{PathPoint{2.0f, 2.0f, 0.5f, 0.0f, 0.0f, 1.0f}}};
+    std::vector<SliceRemoval> removals = stock.cut(plunge, tool);
+    ASSERT_EQ(removals.size(), 1u);
+
+    const double pi = 3.14159265358979;
+    EXPECT_NEAR(removals[0].removedVolume, 2.0 / 3.0 * pi * 0.125, 0.01 * 2.0 / 3.0 * pi * 0.125);
+    EXPECT_EQ(removals[0].toolPositions, 1u);
+    EXPECT_EQ(removals[0].cuttingPositions, 1u);
+}
+
+// Test 3: Verify passes around a part remove material once and then cut air
+TEST(StockSimulatorTest, SecondSweepCutsAir) {
+    std::vector<Facet> part = createBox(0.0f, 0.0f, 0.0f, 2.0f, 2.0f, 1.0f);
+    std::vector<std::vector<PathPoint>> slicePaths = planSlices(part, 0.4f);
+    ASSERT_GT(slicePaths.size(), 1u);
+    StockSimulator stock(part, {0.02f, 0.3f, 0});
+    ToolModel tool = {0.15f, 1.0f, 0.0f};
+
+    // A dry run predicts the cut and leaves the stock alone
+    double before = stock.getStockVolume();
+    std::vector<SliceRemoval> predicted = stock.measure(slicePaths, tool);
+    EXPECT_EQ(stock.getStockVolume(), before);
+
+    std::vector<SliceRemoval> removals = stock.cut(slicePaths, tool);
+    ASSERT_EQ(removals.size(), slicePaths.size());
+    double removed = 0.0;
+    for (size_t i = 0; i < removals.size(); ++i) {
+        EXPECT_EQ(removals[i].removedVolume, predicted[i].removedVolume);
+        EXPECT_EQ(removals[i].cuttingPositions, predicted[i].cuttingPositions);
+        if (!slicePaths[i].empty()) {
+            EXPECT_GT(removals[i].removedVolume, 0.0) << "slice " << i;
+        }
+        removed += removals[i].removedVolume;
+    }
+    EXPECT_NEAR(stock.getStockVolume(), before - removed, 1.0e-3 * before);
+
+    // Running the same passes again finds nothing left to cut
+    for (const auto& removal : stock.measure(slicePaths, tool)) {
+        EXPECT_EQ(removal.removedVolume, 0.0);
+        EXPECT_EQ(removal.cuttingPositions, 0u);
+    }
+}
+
+// Test 4: Verify results do not depend on the number of threads
+TEST(StockSimulatorTest, ThreadCountIndependent) {
+    std::vector<Facet> part = createBox(0.0f, 0.0f, 0.0f, 3.0f, 2.0f, 1.0f);
+    std::vector<std::vector<PathPoint>> slicePaths = planSlices(part, 0.3f);
+    ToolModel tool = {0.1f, 0.8f, 0.0f};
+
+    StockSimulator single(part, {0.02f, 0.25f, 1});
+    StockSimulator parallel(part, {0.02f, 0.25f, 4});
+    std::vector<SliceRemoval> a = single.cut(slicePaths, tool);
+    std::vector<SliceRemoval> b = parallel.cut(slicePaths, tool);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].removedVolume, b[i].removedVolume);
+        EXPECT_EQ(a[i].toolPositions, b[i].toolPositions);
+        EXPECT_EQ(a[i].cuttingPositions, b[i].cuttingPositions);
+    }
+    EXPECT_EQ(single.getStockVolume(), parallel.getStockVolume());
+}
+
+// Test 5: Verify rest material is found where the passes did not reach
+TEST(StockSimulatorTest, RestMaterialRegions) {
+    std::vector<Facet> part = createBox(0.0f, 0.0f, 0.0f, 2.0f, 2.0f, 1.0f);
+    StockSimulator stock(part, {0.0625f, 0.5f, 0});
+
+    // Before cutting, the margin around the part is one ring of rest material
+    std::vector<StockRegion> regions = stock.findRestMaterial(0.01f);
+    ASSERT_EQ(regions.size(), 1u);
+    EXPECT_NEAR(regions[0].volume, stock.getRestVolume(), 1.0e-3);
+    EXPECT_NEAR(regions[0].minX, -0.5f, 1.0e-4f);
+    EXPECT_NEAR(regions[0].maxX, 2.5f, 1.0e-4f);
+    EXPECT_NEAR(regions[0].minZ, -0.5f, 1.0e-4f);
+    EXPECT_NEAR(regions[0].maxZ, 1.5f, 1.0e-4f);
+
+    // A vertical tool running down the full height along the -X side clears
+    // that side of the margin out to the tool diameter
+    ToolModel tool = {0.25f, 3.0f, 0.0f};
+    std::vector<PathPoint> pass;
+    for (int i = 0; i <= 40; ++i) {
+        float y = -0.5f + i * 0.075f;
+        pass.push_back(PathPoint{-0.25f, y, -0.75f, 0.0f, 0.0f, 1.0f});
+    }
+    stock.cut({pass}, tool);
+
+    // About a 0.5 wide strip of the 3 x 3 x 2 block is gone
+    double restAfter = stock.getRestVolume();
+    EXPECT_NEAR(restAfter, 18.0 - 4.0 - 3.0, 0.2);
+    regions = stock.findRestMaterial(0.01f);
+    ASSERT_FALSE(regions.empty());
+    EXPECT_GT(regions[0].minX, -0.5f);
+}
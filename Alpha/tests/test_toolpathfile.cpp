@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "toolpathfile.h"
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+
+// Create a slice loop on a circle with outward normals
+std::vector<PathPoint> createCircleSlice(float radius, float z, int numPoints) {
+    std::vector<PathPoint> points;
+    for (int i = 0; i < numPoints; ++i) {
+        float angle = 2.0f * 3.14159265f * i / numPoints;
+        float c = std::cos(angle), s = std::sin(angle);
+        points.push_back({radius * c, radius * s, z, c * 0.8f, s * 0.8f, -0.6f});
+    }
+    return points;
+}
+
+// Test 1: Verify slices round-trip within the quantization step
+TEST(ToolpathFileTest, RoundTrip) {
+    std::string filePath = "test_roundtrip.tpath";
+    std::vector<std::vector<PathPoint>> slices;
+    for (int i = 0; i < 5; ++i) {
+        slices.push_back(createCircleSlice(10.0f + i, -2.0f + i * 0.75f, 50 + i));
+    }
+    
+    ToolpathWriter writer(1.0e-3f);
+    ASSERT_TRUE(writer.open(filePath));
+    for (const auto& slice : slices) {
+        writer.writeSlice(slice);
+    }
+    ASSERT_TRUE(writer.close());
+    
+    ToolpathReader reader;
+    ASSERT_TRUE(reader.open(filePath));
+    ASSERT_EQ(reader.getSliceCount(), slices.size());
+    EXPECT_EQ(reader.getPointCount(), 50 + 51 + 52 + 53 + 54);
+    
+    std::vector<PathPoint> points;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        EXPECT_FLOAT_EQ(reader.getSliceInfo(i).z, slices[i][0].z);
+        ASSERT_TRUE(reader.readSlice(i, points));
+        ASSERT_EQ(points.size(), slices[i].size());
+        for (size_t j = 0; j < points.size(); ++j) {
+            EXPECT_NEAR(points[j].x, slices[i][j].x, 0.5e-3f + 1.0e-5f);
+            EXPECT_NEAR(points[j].y, slices[i][j].y, 0.5e-3f + 1.0e-5f);
+            EXPECT_NEAR(points[j].z, slices[i][j].z, 0.5e-3f + 1.0e-5f);
+            EXPECT_NEAR(points[j].nx, slices[i][j].nx, 1.0e-3f);
+            EXPECT_NEAR(points[j].ny, slices[i][j].ny, 1.0e-3f);
+            EXPECT_NEAR(points[j].nz, slices[i][j].nz, 1.0e-3f);
+        }
+    }
+    
+    // Whole path in slice order
+    EXPECT_EQ(reader.readPath().size(), reader.getPointCount());
+    
+    reader.close();
+    std::remove(filePath.c_str());
+}
+
+// Test 2: Verify the format is smaller than raw points
+TEST(ToolpathFileTest, CompactEncoding) {
+    std::string filePath = "test_compact.tpath";
+    std::vector<PathPoint> slice = createCircleSlice(50.0f, 3.0f, 10000);
+    
+    ToolpathWriter writer;
+    ASSERT_TRUE(writer.open(filePath));
+    writer.writeSlice(slice);
+    ASSERT_TRUE(writer.close());
+    
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    file.close();
+    EXPECT_LT(fileSize, slice.size() * sizeof(PathPoint) / 2);
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 3: Reject files that are not toolpaths
+TEST(ToolpathFileTest, RejectInvalidFile) {
+    std::string filePath = "test_invalid.tpath";
+    std::ofstream file(filePath);
+    file << "This is not a toolpath file, just some text that is long enough";
+    file.close();
+    
+    ToolpathReader reader;
+    EXPECT_FALSE(reader.open(filePath));
+    EXPECT_FALSE(reader.open("this_file_does_not_exist.tpath"));
+    EXPECT_EQ(reader.getSliceCount(), 0);
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 4: Verify coordinates beyond the 32-bit quantized range round-trip
+TEST(ToolpathFileTest, LargeCoordinates) {
+    std::string filePath = "test_large.tpath";
+    std::vector<PathPoint> slice = {
+        {500000.0f, -500000.0f, 1.0f, 1.0f, 0.0f, 0.0f},
+        {-500000.0f, 500000.0f, 1.0f, -1.0f, 0.0f, 0.0f},
+        {0.5f, 0.25f, 1.0f, 0.0f, 1.0f, 0.0f},
+        {123456.789f, -98765.4321f, 1.0f, 0.0f, 1.0f, 0.0f},
+        {1695.65222f, 1718.06567f, 1.0f, 0.0f, 1.0f, 0.0f},  // Off by an ulp if decoded in float
+    };
+    
+    ToolpathWriter writer(1.0e-4f);
+    ASSERT_TRUE(writer.open(filePath));
+    EXPECT_TRUE(writer.writeSlice(slice));
+    ASSERT_TRUE(writer.close());
+    
+    ToolpathReader reader;
+    ASSERT_TRUE(reader.open(filePath));
+    std::vector<PathPoint> points;
+    ASSERT_TRUE(reader.readSlice(0, points));
+    ASSERT_EQ(points.size(), slice.size());
+    for (size_t i = 0; i < slice.size(); ++i) {
+        // Within half a float step of the quantized value, so the written floats come back
+        EXPECT_EQ(points[i].x, slice[i].x);
+        EXPECT_EQ(points[i].y, slice[i].y);
+        EXPECT_NEAR(points[i].z, slice[i].z, 1.0e-4f);
+    }
+    reader.close();
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 5: Verify out-of-range points are rejected and close() reports it
+TEST(ToolpathFileTest, RejectOutOfRange) {
+    std::string filePath = "test_range.tpath";
+    std::vector<PathPoint> huge = {{1.0e30f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}};
+    std::vector<PathPoint> nan = {{std::nanf(""), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}};
+    
+    ToolpathWriter writer(1.0e-4f);
+    ASSERT_TRUE(writer.open(filePath));
+    EXPECT_TRUE(writer.writeSlice(createCircleSlice(10.0f, 0.0f, 20)));
+    EXPECT_FALSE(writer.writeSlice(huge));
+    EXPECT_FALSE(writer.close());
+    
+    ASSERT_TRUE(writer.open(filePath));
+    EXPECT_FALSE(writer.writeSlice(nan));
+    EXPECT_FALSE(writer.close());
+    
+    std::remove(filePath.c_str());
+}
+
+// Test 6: Verify a header announcing more points than the file can hold is rejected
+TEST(ToolpathFileTest, RejectCorruptPointCount) {
+    std::string filePath = "test_corrupt.tpath";
+    ToolpathWriter writer(1.0e-3f);
+    ASSERT_TRUE(writer.open(filePath));
+    writer.writeSlice(createCircleSlice(10.0f, 0.0f, 20));
+    ASSERT_TRUE(writer.close());
+    
+    ToolpathReader reader;
+    ASSERT_TRUE(reader.open(filePath));
+    EXPECT_EQ(reader.getSliceInfo(0).count, 20u);
+    EXPECT_EQ(reader.getSliceInfo(1).count, 0u);  // Past the last slice
+    EXPECT_EQ(reader.getSliceInfo(1).offset, 0u);
+    reader.close();
+    
+    // Point count in the header (bytes 24-31)
+    std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    uint64_t pointCount = uint64_t(1) << 60;
+    file.seekp(24);
+    file.write(reinterpret_cast<const char*>(&pointCount), sizeof(pointCount));
+    file.close();
+    EXPECT_FALSE(reader.open(filePath));
+    
+    std::remove(filePath.c_str());
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "trace.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+static std::string readFile(const std::string& filename) {
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// Test 1: Verify nothing is recorded while tracing is off
+TEST(TraceTest, DisabledRecordsNothing) {
+    setTracingEnabled(false);
+    clearTrace();
+    {
+        TraceScope scope("disabled");
+        traceCounter("ignored", 1.0);  // Direct calls always record
+    }
+    TRACE_COUNTER("disabledCounter", 2);
+    EXPECT_EQ(getTraceEventCount(), 1);
+    clearTrace();
+    EXPECT_EQ(getTraceEventCount(), 0);
+}
+
+// Test 2: Verify scopes and counters from several threads end up in the trace
+TEST(TraceTest, ThreadsAndExport) {
+    clearTrace();
+    setTracingEnabled(true);
+    {
+        TraceScope outer("outer");
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([]() {
+                for (int i = 0; i < 10; ++i) {
+                    TraceScope inner("worker");
+                    traceCounter("items", i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    setTracingEnabled(false);
+
+    // 1 outer + 4 threads x 10 (scope + counter), recorded after the threads exited
+    EXPECT_EQ(getTraceEventCount(), 1 + 4 * 10 * 2);
+
+    std::ostringstream summary;
+    printTraceSummary(summary);
+    EXPECT_NE(summary.str().find("outer"), std::string::npos);
+    EXPECT_NE(summary.str().find("worker"), std::string::npos);
+    EXPECT_NE(summary.str().find("items"), std::string::npos);
+
+    std::string filename = "test_trace.json";
+    ASSERT_TRUE(writeChromeTrace(filename));
+    std::string json = readFile(filename);
+    EXPECT_EQ(json.find("{\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("\"name\":\"worker\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"items\",\"ph\":\"C\""), std::string::npos);
+
+    // Worker events carry their own thread ids, distinct from the main thread
+    size_t outerPos = json.find("\"name\":\"outer\"");
+    ASSERT_NE(outerPos, std::string::npos);
+    std::string outerTid = json.substr(json.find("\"tid\":", outerPos), 8);
+    size_t workerEvents = 0;
+    for (size_t pos = json.find("\"name\":\"worker\""); pos != std::string::npos;
+         pos = json.find("\"name\":\"worker\"", pos + 1)) {
+        EXPECT_NE(json.substr(json.find("\"tid\":", pos), 8), outerTid);
+        workerEvents++;
+    }
+    EXPECT_EQ(workerEvents, 40);
+
+    std::remove(filename.c_str());
+    clearTrace();
+}